@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Common.h"
+#include "JitRegister.h"
 #include "MemoryUtil.h"
 #if defined(__SYMBIAN32__) || defined(PANDORA)
 #include <signal.h>
@@ -723,6 +724,7 @@ public:
 	// uninitialized, it just breaks into the debugger.
 	void ClearCodeSpace()
 	{
+		JitRegister::Unregister(region, region_size);
 		// x86/64: 0xCC = breakpoint
 		memset(region, 0xCC, region_size);
 		ResetCodePtr();
@@ -731,6 +733,7 @@ public:
 	// Call this when shutting down. Don't rely on the destructor, even though it'll do the job.
 	void FreeCodeSpace()
 	{
+		JitRegister::Unregister(region, region_size);
 #ifndef __SYMBIAN32__
 		FreeMemoryPages(region, region_size);
 #endif
@@ -40,6 +40,7 @@ struct CPUInfo
 	bool bLZCNT;
 	bool bSSE4A;
 	bool bAVX;
+	bool bAVX2;
 	bool bFMA;
 	bool bAES;
 	// FXSAVE/FXRSTOR
@@ -155,6 +155,14 @@ private:
 #  define _M_SSE 0x402
 #endif
 
+// Lets a function use instructions the rest of the build can't assume, like AVX2.
+// Callers have to check cpu_info first. MSVC doesn't need it to use the intrinsics.
+#ifdef _MSC_VER
+#define ATTRIBUTE_TARGET(x)
+#else
+#define ATTRIBUTE_TARGET(x) __attribute__((target(x)))
+#endif
+
 // Host communication.
 enum HOST_COMM
 {
@@ -0,0 +1,280 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdarg>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "Common.h"
+#include "FileUtil.h"
+#include "JitRegister.h"
+#include "StringUtil.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace JitRegister
+{
+
+#ifdef __linux__
+
+namespace
+{
+
+// See tools/perf/Documentation/jitdump-specification.txt in the kernel tree.
+enum
+{
+	JITDUMP_MAGIC = 0x4A695444,
+	JITDUMP_VERSION = 1,
+	JIT_CODE_LOAD = 0,
+	JIT_CODE_CLOSE = 3,
+#ifdef _M_X64
+	ELF_MACHINE = 62, // EM_X86_64
+#elif defined(_M_ARM)
+	ELF_MACHINE = 40, // EM_ARM
+#else
+	ELF_MACHINE = 3,  // EM_386
+#endif
+};
+
+struct JitDumpHeader
+{
+	u32 magic;
+	u32 version;
+	u32 total_size;
+	u32 elf_mach;
+	u32 pad1;
+	u32 pid;
+	u64 timestamp;
+	u64 flags;
+};
+
+struct JitDumpRecordHeader
+{
+	u32 id;
+	u32 total_size;
+	u64 timestamp;
+};
+
+struct JitDumpCodeLoad
+{
+	JitDumpRecordHeader header;
+	u32 pid;
+	u32 tid;
+	u64 vma;
+	u64 code_addr;
+	u64 code_size;
+	u64 code_index;
+	// followed by the NUL terminated name and the code
+};
+
+struct Symbol
+{
+	u32 size;
+	std::string name;
+};
+
+std::mutex s_lock;
+bool s_enabled = false;
+
+File::IOFile s_perf_map;
+std::string s_perf_map_filename;
+// What the perf map currently describes, by start address.
+std::map<const u8*, Symbol> s_symbols;
+bool s_perf_map_stale = false;
+
+File::IOFile s_jit_dump;
+void *s_jit_dump_marker = NULL;
+u64 s_code_index = 0;
+
+u64 GetTimestamp()
+{
+	// perf record -k mono
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void WritePerfMapEntry(const u8 *code, const Symbol &symbol)
+{
+	fprintf(s_perf_map.GetHandle(), "%lx %x %s\n", (unsigned long)(uintptr_t)code, symbol.size, symbol.name.c_str());
+}
+
+void RewritePerfMap()
+{
+	s_perf_map.Open(s_perf_map_filename, "w");
+	for (const auto &entry : s_symbols)
+		WritePerfMapEntry(entry.first, entry.second);
+	s_perf_map_stale = false;
+}
+
+void WriteJitDumpLoad(const u8 *code, u32 size, const std::string &name)
+{
+	JitDumpCodeLoad record;
+	record.header.id = JIT_CODE_LOAD;
+	record.header.total_size = (u32)(sizeof(record) + name.size() + 1 + size);
+	record.header.timestamp = GetTimestamp();
+	record.pid = getpid();
+	record.tid = (u32)syscall(SYS_gettid);
+	record.vma = (u64)(uintptr_t)code;
+	record.code_addr = (u64)(uintptr_t)code;
+	record.code_size = size;
+	record.code_index = s_code_index++;
+
+	s_jit_dump.WriteBytes(&record, sizeof(record));
+	s_jit_dump.WriteBytes(name.c_str(), name.size() + 1);
+	s_jit_dump.WriteBytes(code, size);
+}
+
+}
+
+void Init(bool perf_map, bool jit_dump)
+{
+	Shutdown();
+
+	std::lock_guard<std::mutex> lk(s_lock);
+	const int pid = getpid();
+
+	if (perf_map)
+	{
+		s_perf_map_filename = StringFromFormat("/tmp/perf-%d.map", pid);
+		s_perf_map.Open(s_perf_map_filename, "w");
+		if (!s_perf_map)
+			ERROR_LOG(COMMON, "Failed to open %s", s_perf_map_filename.c_str());
+	}
+
+	if (jit_dump)
+	{
+		std::string filename = StringFromFormat("/tmp/jit-%d.dump", pid);
+		s_jit_dump.Open(filename, "w+b");
+		if (s_jit_dump)
+		{
+			JitDumpHeader header = {};
+			header.magic = JITDUMP_MAGIC;
+			header.version = JITDUMP_VERSION;
+			header.total_size = sizeof(header);
+			header.elf_mach = ELF_MACHINE;
+			header.pid = pid;
+			header.timestamp = GetTimestamp();
+			s_jit_dump.WriteBytes(&header, sizeof(header));
+			s_jit_dump.Flush();
+
+			// perf record finds the dump through this executable mapping of it.
+			long page_size = sysconf(_SC_PAGESIZE);
+			s_jit_dump_marker = mmap(NULL, page_size, PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(s_jit_dump.GetHandle()), 0);
+			if (s_jit_dump_marker == MAP_FAILED)
+				s_jit_dump_marker = NULL;
+		}
+		else
+		{
+			ERROR_LOG(COMMON, "Failed to open %s", filename.c_str());
+		}
+	}
+
+	s_enabled = s_perf_map.IsOpen() || s_jit_dump.IsOpen();
+}
+
+void Shutdown()
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+
+	if (s_jit_dump)
+	{
+		JitDumpRecordHeader record;
+		record.id = JIT_CODE_CLOSE;
+		record.total_size = sizeof(record);
+		record.timestamp = GetTimestamp();
+		s_jit_dump.WriteBytes(&record, sizeof(record));
+		if (s_jit_dump_marker)
+			munmap(s_jit_dump_marker, sysconf(_SC_PAGESIZE));
+		s_jit_dump_marker = NULL;
+		s_jit_dump.Close();
+	}
+
+	s_perf_map.Close();
+	s_symbols.clear();
+	s_perf_map_stale = false;
+	s_code_index = 0;
+	s_enabled = false;
+}
+
+bool IsEnabled()
+{
+	return s_enabled;
+}
+
+void Register(const void *code, u32 size, const char *format, ...)
+{
+	if (!s_enabled || !size)
+		return;
+
+	char name[256];
+	va_list args;
+	va_start(args, format);
+	CharArrayFromFormatV(name, sizeof(name), format, args);
+	va_end(args);
+
+	std::lock_guard<std::mutex> lk(s_lock);
+	const u8 *start = (const u8 *)code;
+
+	if (s_perf_map)
+	{
+		Symbol &symbol = s_symbols[start];
+		symbol.size = size;
+		symbol.name = name;
+		if (s_perf_map_stale)
+			RewritePerfMap();
+		else
+			WritePerfMapEntry(start, symbol);
+		s_perf_map.Flush();
+	}
+
+	if (s_jit_dump)
+	{
+		WriteJitDumpLoad(start, size, name);
+		s_jit_dump.Flush();
+	}
+}
+
+void Unregister(const void *code, size_t size)
+{
+	if (!s_enabled || !size)
+		return;
+
+	std::lock_guard<std::mutex> lk(s_lock);
+	const u8 *start = (const u8 *)code;
+	const u8 *end = start + size;
+
+	// Nothing to do for jitdump, later loads simply supersede earlier ones.
+	auto it = s_symbols.lower_bound(start);
+	if (it != s_symbols.begin())
+	{
+		auto prev = it;
+		--prev;
+		if (prev->first + prev->second.size > start)
+			it = prev;
+	}
+	while (it != s_symbols.end() && it->first < end)
+	{
+		s_symbols.erase(it++);
+		s_perf_map_stale = true;
+	}
+}
+
+#else
+
+void Init(bool perf_map, bool jit_dump) {}
+void Shutdown() {}
+bool IsEnabled() { return false; }
+void Register(const void *code, u32 size, const char *format, ...) {}
+void Unregister(const void *code, size_t size) {}
+
+#endif
+
+}
@@ -0,0 +1,33 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "CommonTypes.h"
+
+// Tells external profilers about generated code, so that samples in JIT code
+// resolve to something better than [unknown].
+//
+// Two formats are supported, both understood by Linux perf:
+//  - /tmp/perf-<pid>.map, a plain symbol table that perf reads at report time.
+//    It can only describe one mapping per address, so when a code region gets
+//    recycled the file is rewritten with what is live at that point.
+//  - /tmp/jit-<pid>.dump, the jitdump format. Every load is timestamped and
+//    carries a copy of the code, so samples taken before a region was recycled
+//    still resolve correctly (perf record -k mono, then perf inject --jit).
+//
+// Everything is a no-op unless enabled in Init, and on other platforms.
+namespace JitRegister
+{
+
+void Init(bool perf_map, bool jit_dump);
+void Shutdown();
+bool IsEnabled();
+
+// Code in [code, code + size) now implements the printf-style name.
+void Register(const void *code, u32 size, const char *format, ...);
+// Code in this range is about to be overwritten or freed.
+void Unregister(const void *code, size_t size);
+
+}
@@ -0,0 +1,126 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a lockless multiple writer, single reader queue
+//
+// Writers claim a slot in a fixed size ring with a single compare and swap;
+// each slot carries a sequence number that tells the reader when its value
+// has been written, and the writers when the reader is done with it.
+// If the ring is full, writers fall back to a locked overflow list instead of
+// waiting for the reader. Once anything is in there, every write goes there
+// until the reader has drained it, so items from any one writer always come
+// out in the order they were pushed.
+
+#include <atomic>
+#include <deque>
+
+#include "CommonTypes.h"
+#include "StdMutex.h"
+
+namespace Common
+{
+
+template <typename T, u32 Capacity = 1024>
+class MPSCQueue
+{
+	static_assert(Capacity && !(Capacity & (Capacity - 1)), "MPSCQueue capacity must be a power of two");
+
+public:
+	MPSCQueue() : m_write(0), m_read(0), m_has_overflow(false)
+	{
+		for (u32 i = 0; i < Capacity; i++)
+			m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	// Any thread.
+	void Push(const T& t)
+	{
+		if (!m_has_overflow.load(std::memory_order_acquire))
+		{
+			u32 pos = m_write.load(std::memory_order_relaxed);
+			while (true)
+			{
+				Slot &slot = m_slots[pos & (Capacity - 1)];
+				s32 diff = (s32)(slot.sequence.load(std::memory_order_acquire) - pos);
+				if (diff == 0)
+				{
+					if (m_write.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						slot.value = t;
+						slot.sequence.store(pos + 1, std::memory_order_release);
+						return;
+					}
+				}
+				else if (diff < 0)
+				{
+					// full
+					break;
+				}
+				else
+				{
+					pos = m_write.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		std::lock_guard<std::mutex> lk(m_overflow_lock);
+		m_overflow.push_back(t);
+		m_has_overflow.store(true, std::memory_order_release);
+	}
+
+	// Reader only. May miss a value that is still being written.
+	bool Empty() const
+	{
+		return m_slots[m_read & (Capacity - 1)].sequence.load(std::memory_order_acquire) != m_read + 1 &&
+			!m_has_overflow.load(std::memory_order_acquire);
+	}
+
+	// Reader only.
+	bool Pop(T& t)
+	{
+		Slot &slot = m_slots[m_read & (Capacity - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) == m_read + 1)
+		{
+			t = std::move(slot.value);
+			slot.sequence.store(m_read + Capacity, std::memory_order_release);
+			m_read++;
+			return true;
+		}
+
+		if (!m_has_overflow.load(std::memory_order_acquire))
+			return false;
+
+		std::lock_guard<std::mutex> lk(m_overflow_lock);
+		// Writers that got a slot before the ring filled up go first.
+		if (m_slots[m_read & (Capacity - 1)].sequence.load(std::memory_order_acquire) == m_read + 1)
+			return Pop(t);
+		if (m_write.load(std::memory_order_relaxed) != m_read)
+			return false;
+
+		t = std::move(m_overflow.front());
+		m_overflow.pop_front();
+		if (m_overflow.empty())
+			m_has_overflow.store(false, std::memory_order_release);
+		return true;
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<u32> sequence;
+		T value;
+	};
+
+	Slot m_slots[Capacity];
+	std::atomic<u32> m_write;
+	u32 m_read;
+
+	std::atomic<bool> m_has_overflow;
+	std::mutex m_overflow_lock;
+	std::deque<T> m_overflow;
+};
+
+}
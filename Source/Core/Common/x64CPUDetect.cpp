@@ -41,7 +41,8 @@ static inline void do_cpuid(unsigned int *eax, unsigned int *ebx,
 		  "=S" (*ebx),
 		  "=c" (*ecx),
 		  "=d" (*edx)
-		: "a"  (*eax)
+		: "a"  (*eax),
+		  "c"  (*ecx)
 		: "rbx"
 		);
 #else
@@ -52,7 +53,8 @@ static inline void do_cpuid(unsigned int *eax, unsigned int *ebx,
 		  "=S" (*ebx),
 		  "=c" (*ecx),
 		  "=d" (*edx)
-		: "a"  (*eax)
+		: "a"  (*eax),
+		  "c"  (*ecx)
 		: "ebx"
 		);
 #endif
@@ -204,6 +206,17 @@ void CPUInfo::Detect()
 			}
 		}
 	}
+	if (max_std_fn >= 7) {
+		// Structured extended feature flags, subleaf 0.
+#ifdef _WIN32
+		__cpuidex(cpu_id, 0x00000007, 0);
+#else
+		__cpuid(cpu_id, 0x00000007);
+#endif
+		// AVX2 needs the same OS support (YMM state saving) as AVX.
+		if (bAVX && ((cpu_id[1] >> 5) & 1))
+			bAVX2 = true;
+	}
 	if (max_ex_fn >= 0x80000004) {
 		// Extract brand string
 		__cpuid(cpu_id, 0x80000002);
@@ -262,6 +275,7 @@ std::string CPUInfo::Summarize()
 	if (bSSE4_2) sum += ", SSE4.2";
 	if (HTT) sum += ", HTT";
 	if (bAVX) sum += ", AVX";
+	if (bAVX2) sum += ", AVX2";
 	if (bFMA) sum += ", FMA";
 	if (bAES) sum += ", AES";
 	if (bLongMode) sum += ", 64-bit support";
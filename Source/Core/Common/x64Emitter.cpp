@@ -171,7 +171,12 @@ void OpArg::WriteVex(XEmitter* emit, int size, int packed, Gen::X64Reg regOp1, G
 
 	int vvvv = (regOp2 == X64Reg::INVALID_REG) ? 0xf : (regOp2 ^ 0xf);
 	int L = size == 256;
-	int pp = (packed << 1) | (size == 64);
+	// The implied prefix, as in WriteSSEOp: none, 66, F3, F2
+	int pp;
+	if (packed)
+		pp = size == 64 ? 1 : 0;
+	else
+		pp = size == 64 ? 3 : 2;
 
 	// do we need any VEX fields that only appear in the three-byte form?
 	if (X == 1 && B == 1 && W == 0 && mmmmm == 1)
@@ -557,6 +562,8 @@ void XEmitter::LFENCE() {Write8(0x0F); Write8(0xAE); Write8(0xE8);}
 void XEmitter::MFENCE() {Write8(0x0F); Write8(0xAE); Write8(0xF0);}
 void XEmitter::SFENCE() {Write8(0x0F); Write8(0xAE); Write8(0xF8);}
 
+void XEmitter::RDTSC() {Write8(0x0F); Write8(0x31);}
+
 void XEmitter::WriteSimple1Byte(int bits, u8 byte, X64Reg reg)
 {
 	if (bits == 16) {Write8(0x66);}
@@ -1212,9 +1219,12 @@ void XEmitter::MOVQ_xmm(X64Reg dest, OpArg arg) {
 }
 
 void XEmitter::MOVQ_xmm(OpArg arg, X64Reg src) {
+#ifndef _M_X64
 	if (arg.IsSimpleReg())
 		PanicAlert("Emitter: MOVQ_xmm doesn't support single registers as destination");
-	if (src > 7)
+#endif
+	// The short encoding has no form with a general purpose register as destination.
+	if (src > 7 || arg.IsSimpleReg())
 	{
 		// Alternate encoding
 		// This does not display correctly in MSVC's debugger, it thinks it's a MOVD
@@ -1441,6 +1451,33 @@ void XEmitter::PSHUFB(X64Reg dest, OpArg arg) {
 	arg.WriteRest(this, 0);
 }
 
+void XEmitter::BLENDPD(X64Reg dest, OpArg arg, u8 blend) {
+	if (!cpu_info.bSSE4_1) {
+		PanicAlert("Trying to use BLENDPD on a system that doesn't support it. Bad programmer.");
+	}
+	Write8(0x66);
+	arg.operandReg = dest;
+	arg.WriteRex(this, 0, 0);
+	Write8(0x0f);
+	Write8(0x3a);
+	Write8(0x0d);
+	arg.WriteRest(this, 1);
+	Write8(blend);
+}
+
+void XEmitter::BLENDVPD(X64Reg dest, OpArg arg) {
+	if (!cpu_info.bSSE4_1) {
+		PanicAlert("Trying to use BLENDVPD on a system that doesn't support it. Bad programmer.");
+	}
+	Write8(0x66);
+	arg.operandReg = dest;
+	arg.WriteRex(this, 0, 0);
+	Write8(0x0f);
+	Write8(0x38);
+	Write8(0x15);
+	arg.WriteRest(this, 0);
+}
+
 void XEmitter::PAND(X64Reg dest, OpArg arg)     {WriteSSEOp(64, 0xDB, true, dest, arg);}
 void XEmitter::PANDN(X64Reg dest, OpArg arg)    {WriteSSEOp(64, 0xDF, true, dest, arg);}
 void XEmitter::PXOR(X64Reg dest, OpArg arg)     {WriteSSEOp(64, 0xEF, true, dest, arg);}
@@ -1499,6 +1536,18 @@ void XEmitter::VMULSD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(64,
 void XEmitter::VDIVSD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(64, sseDIV, false, regOp1, regOp2, arg);}
 void XEmitter::VSQRTSD(X64Reg regOp1, X64Reg regOp2, OpArg arg)  {WriteAVXOp(64, sseSQRT, false, regOp1, regOp2, arg);}
 
+void XEmitter::VADDPD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(64, sseADD, true, regOp1, regOp2, arg);}
+void XEmitter::VSUBPD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(64, sseSUB, true, regOp1, regOp2, arg);}
+void XEmitter::VMULPD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(64, sseMUL, true, regOp1, regOp2, arg);}
+void XEmitter::VDIVPD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(64, sseDIV, true, regOp1, regOp2, arg);}
+void XEmitter::VANDPD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(64, sseAND, true, regOp1, regOp2, arg);}
+void XEmitter::VANDNPD(X64Reg regOp1, X64Reg regOp2, OpArg arg)  {WriteAVXOp(64, sseANDN, true, regOp1, regOp2, arg);}
+void XEmitter::VORPD(X64Reg regOp1, X64Reg regOp2, OpArg arg)    {WriteAVXOp(64, sseOR, true, regOp1, regOp2, arg);}
+void XEmitter::VXORPD(X64Reg regOp1, X64Reg regOp2, OpArg arg)   {WriteAVXOp(64, sseXOR, true, regOp1, regOp2, arg);}
+void XEmitter::VSHUFPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 shuffle) {WriteAVXOp(64, sseSHUF, true, regOp1, regOp2, arg, 1); Write8(shuffle);}
+void XEmitter::VUNPCKLPD(X64Reg regOp1, X64Reg regOp2, OpArg arg) {WriteAVXOp(64, 0x14, true, regOp1, regOp2, arg);}
+void XEmitter::VUNPCKHPD(X64Reg regOp1, X64Reg regOp2, OpArg arg) {WriteAVXOp(64, 0x15, true, regOp1, regOp2, arg);}
+
 // Prefixes
 
 void XEmitter::LOCK()  { Write8(0xF0); }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Common.h"
+#include "JitRegister.h"
 #include "MemoryUtil.h"
 
 namespace Gen
@@ -332,6 +333,9 @@ public:
 	void MFENCE();
 	void SFENCE();
 
+	// Time stamp counter, into EDX:EAX
+	void RDTSC();
+
 	// Bit scan
 	void BSF(int bits, X64Reg dest, OpArg src); //bottom bit to top bit
 	void BSR(int bits, X64Reg dest, OpArg src); //top bit to bottom bit
@@ -600,6 +604,11 @@ public:
 	void PMOVMSKB(X64Reg dest, OpArg arg);
 	void PSHUFB(X64Reg dest, OpArg arg);
 
+	// SSE4.1
+	void BLENDPD(X64Reg dest, OpArg arg, u8 blend);
+	// Takes the components whose sign bit is set in XMM0 from arg.
+	void BLENDVPD(X64Reg dest, OpArg arg);
+
 	void PSHUFLW(X64Reg dest, OpArg arg, u8 shuffle);
 
 	void PSRLW(X64Reg reg, int shift);
@@ -620,6 +629,19 @@ public:
 	void VDIVSD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VSQRTSD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 
+	// AVX: Three operand forms of the SSE2 packed double ops, regOp1 = regOp2 op arg.
+	void VADDPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VSUBPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VMULPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VDIVPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VANDPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VANDNPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VORPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VXORPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VSHUFPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 shuffle);
+	void VUNPCKLPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VUNPCKHPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+
 	void RTDSC();
 
 	// Utility functions
@@ -637,6 +659,7 @@ public:
 	void ABI_CallFunctionCCC(void *func, u32 param1, u32 param2, u32 param3);
 	void ABI_CallFunctionCCP(void *func, u32 param1, u32 param2, void *param3);
 	void ABI_CallFunctionCCCP(void *func, u32 param1, u32 param2,u32 param3, void *param4);
+	void ABI_CallFunctionPC(void *func, void *param1, u32 param2);
 	void ABI_CallFunctionPPC(void *func, void *param1, void *param2,u32 param3);
 	void ABI_CallFunctionAC(void *func, const Gen::OpArg &arg1, u32 param2);
 	void ABI_CallFunctionA(void *func, const Gen::OpArg &arg1);
@@ -728,6 +751,7 @@ public:
 	// uninitialized, it just breaks into the debugger.
 	void ClearCodeSpace()
 	{
+		JitRegister::Unregister(region, region_size);
 		// x86/64: 0xCC = breakpoint
 		memset(region, 0xCC, region_size);
 		ResetCodePtr();
@@ -736,6 +760,7 @@ public:
 	// Call this when shutting down. Don't rely on the destructor, even though it'll do the job.
 	void FreeCodeSpace()
 	{
+		JitRegister::Unregister(region, region_size);
 		FreeMemoryPages(region, region_size);
 		region = NULL;
 		region_size = 0;
@@ -227,8 +227,20 @@ void SConfig::SaveSettings()
 
 	// Core
 	ini.Set("Core", "HLE_BS2",			m_LocalCoreStartupParameter.bHLE_BS2);
+	ini.Set("Core", "HLE_SDK",			m_LocalCoreStartupParameter.bHLE_SDK);
+	ini.Set("Core", "HLE_SDKValidate",	m_LocalCoreStartupParameter.bHLE_SDKValidate);
 	ini.Set("Core", "CPUCore",			m_LocalCoreStartupParameter.iCPUCore);
 	ini.Set("Core", "Fastmem",			m_LocalCoreStartupParameter.bFastmem);
+	ini.Set("Core", "JITDiskCache",		m_LocalCoreStartupParameter.bJITDiskCache);
+	ini.Set("Core", "JITTiered",		m_LocalCoreStartupParameter.bJITTiered);
+	ini.Set("Core", "JITBackgroundCompile",	m_LocalCoreStartupParameter.bJITBackgroundCompile);
+	ini.Set("Core", "JITRegisterLiveness",	m_LocalCoreStartupParameter.bJITRegisterLiveness);
+	ini.Set("Core", "JITBlockEviction",	m_LocalCoreStartupParameter.bJITBlockEviction);
+	ini.Set("Core", "JITTraceFormation",	m_LocalCoreStartupParameter.bJITTraceFormation);
+	ini.Set("Core", "JITConstantAddresses",	m_LocalCoreStartupParameter.bJITConstantAddresses);
+	ini.Set("Core", "JITPerfMap",		m_LocalCoreStartupParameter.bJITPerfMap);
+	ini.Set("Core", "JITDump",			m_LocalCoreStartupParameter.bJITDump);
+	ini.Set("Core", "JITIdleLoopReport",	m_LocalCoreStartupParameter.bJITIdleLoopReport);
 	ini.Set("Core", "CPUThread",		m_LocalCoreStartupParameter.bCPUThread);
 	ini.Set("Core", "DSPThread",		m_LocalCoreStartupParameter.bDSPThread);
 	ini.Set("Core", "DSPHLE",			m_LocalCoreStartupParameter.bDSPHLE);
@@ -376,12 +388,24 @@ void SConfig::LoadSettings()
 
 		// Core
 		ini.Get("Core", "HLE_BS2",		&m_LocalCoreStartupParameter.bHLE_BS2,		false);
+		ini.Get("Core", "HLE_SDK",		&m_LocalCoreStartupParameter.bHLE_SDK,		true);
+		ini.Get("Core", "HLE_SDKValidate",	&m_LocalCoreStartupParameter.bHLE_SDKValidate,	false);
 #ifdef _M_ARM
 		ini.Get("Core", "CPUCore",		&m_LocalCoreStartupParameter.iCPUCore,		3);
 #else
 		ini.Get("Core", "CPUCore",		&m_LocalCoreStartupParameter.iCPUCore,		1);
 #endif
 		ini.Get("Core", "Fastmem",		&m_LocalCoreStartupParameter.bFastmem,		true);
+		ini.Get("Core", "JITDiskCache",	&m_LocalCoreStartupParameter.bJITDiskCache,	false);
+		ini.Get("Core", "JITTiered",	&m_LocalCoreStartupParameter.bJITTiered,	false);
+		ini.Get("Core", "JITBackgroundCompile",	&m_LocalCoreStartupParameter.bJITBackgroundCompile,	false);
+		ini.Get("Core", "JITRegisterLiveness",	&m_LocalCoreStartupParameter.bJITRegisterLiveness,	false);
+		ini.Get("Core", "JITBlockEviction",	&m_LocalCoreStartupParameter.bJITBlockEviction,	false);
+		ini.Get("Core", "JITTraceFormation",	&m_LocalCoreStartupParameter.bJITTraceFormation,	false);
+		ini.Get("Core", "JITConstantAddresses",	&m_LocalCoreStartupParameter.bJITConstantAddresses,	false);
+		ini.Get("Core", "JITPerfMap",	&m_LocalCoreStartupParameter.bJITPerfMap,	false);
+		ini.Get("Core", "JITDump",		&m_LocalCoreStartupParameter.bJITDump,		false);
+		ini.Get("Core", "JITIdleLoopReport",	&m_LocalCoreStartupParameter.bJITIdleLoopReport,	false);
 		ini.Get("Core", "DSPThread",	&m_LocalCoreStartupParameter.bDSPThread,	false);
 		ini.Get("Core", "DSPHLE",		&m_LocalCoreStartupParameter.bDSPHLE,		true);
 		ini.Get("Core", "CPUThread",	&m_LocalCoreStartupParameter.bCPUThread,	true);
@@ -15,6 +15,7 @@
 #include "StringUtil.h"
 #include "MathUtil.h"
 #include "MemoryUtil.h"
+#include "JitRegister.h"
 
 #include "Core.h"
 #include "CPUDetect.h"
@@ -35,6 +36,7 @@
 #include "HW/VideoInterface.h"
 #include "HW/EXI.h"
 #include "HW/SystemTimers.h"
+#include "HW/WriteWatch.h"
 
 #include "IPC_HLE/WII_IPC_HLE_Device_usb.h"
 
@@ -304,6 +306,12 @@ void CpuThread()
 	if (_CoreParameter.bFastmem)
 		EMM::InstallExceptionHandler(); // Let's run under memory watch
 	#endif
+	// Needs a handler for faults on every thread. The Mach exception port
+	// above is only set for this one.
+	#if defined(_M_X64) && !defined(__APPLE__)
+	if (_CoreParameter.bFastmem)
+		WriteWatch::Init();
+	#endif
 
 	if (!g_stateFileName.empty())
 		State::LoadAs(g_stateFileName);
@@ -382,6 +390,9 @@ void EmuThread()
 
 	Movie::Init();
 
+	// Before anything generates code
+	JitRegister::Init(_CoreParameter.bJITPerfMap, _CoreParameter.bJITDump);
+
 	HW::Init();
 
 	if (!g_video_backend->Initialize(g_pWindowHandle))
@@ -513,6 +524,7 @@ void EmuThread()
 	Pad::Shutdown();
 	Wiimote::Shutdown();
 	g_video_backend->Shutdown();
+	JitRegister::Shutdown();
 }
 
 // Set or get the running state
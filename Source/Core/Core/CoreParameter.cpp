@@ -24,6 +24,10 @@ SCoreStartupParameter::SCoreStartupParameter()
 : hInstance(0),
   bEnableDebugging(false), bAutomaticStart(false), bBootToPause(false),
   bJITNoBlockCache(false), bJITBlockLinking(true),
+  bJITDiskCache(false), bJITTiered(false), bJITBackgroundCompile(false),
+  bJITRegisterLiveness(false), bJITBlockEviction(false), bJITTraceFormation(false), bJITConstantAddresses(false),
+  bJITPerfMap(false), bJITDump(false),
+  bJITIdleLoopReport(false),
   bJITOff(false),
   bJITLoadStoreOff(false), bJITLoadStorelXzOff(false),
   bJITLoadStorelwzOff(false), bJITLoadStorelbzxOff(false),
@@ -35,7 +39,7 @@ SCoreStartupParameter::SCoreStartupParameter()
   bEnableFPRF(false),
   bCPUThread(true), bDSPThread(false), bDSPHLE(true),
   bSkipIdle(true), bNTSC(false), bForceNTSCJ(false),
-  bHLE_BS2(true), bEnableCheats(false),
+  bHLE_BS2(true), bHLE_SDK(true), bHLE_SDKValidate(false), bEnableCheats(false),
   bMergeBlocks(false), bEnableMemcardSaving(true),
   bDPL2Decoder(false), iLatency(14),
   bRunCompareServer(false), bRunCompareClient(false),
@@ -97,10 +97,27 @@ struct SCoreStartupParameter
 	// 1 = Jit
 	// 2 = JitIL
 	// 3 = JIT ARM
+	// 4 = JITIL ARM
+	// 5 = Cached Interpreter
 	int iCPUCore;
 
 	// JIT (shared between JIT and JITIL)
 	bool bJITNoBlockCache, bJITBlockLinking;
+	bool bJITDiskCache;
+	bool bJITTiered;
+	bool bJITBackgroundCompile;
+	bool bJITRegisterLiveness;
+	// Throw out the oldest code when the code space is full, not all of it
+	bool bJITBlockEviction;
+	// Hot blocks follow conditional branches the way they mostly go
+	bool bJITTraceFormation;
+	// Work out load and store addresses built from constants at compile time
+	bool bJITConstantAddresses;
+	// Tell perf about generated code, see JitRegister.h
+	bool bJITPerfMap;
+	bool bJITDump;
+	// List the busy-wait loops the analyzer found, in Logs/<GameID>_IdleLoops.txt
+	bool bJITIdleLoopReport;
 	bool bJITOff;
 	bool bJITLoadStoreOff, bJITLoadStorelXzOff, bJITLoadStorelwzOff, bJITLoadStorelbzxOff;
 	bool bJITLoadStoreFloatingOff;
@@ -123,6 +140,8 @@ struct SCoreStartupParameter
 	bool bNTSC;
 	bool bForceNTSCJ;
 	bool bHLE_BS2;
+	bool bHLE_SDK;
+	bool bHLE_SDKValidate;
 	bool bEnableCheats;
 	bool bMergeBlocks;
 	bool bEnableMemcardSaving;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <vector>
 #include <cinttypes>
 
@@ -11,7 +12,7 @@
 #include "Core.h"
 #include "StringUtil.h"
 #include "VideoBackendBase.h"
-#include "FifoQueue.h"
+#include "MPSCQueue.h"
 
 #define MAX_SLICE_LENGTH 20000
 
@@ -22,6 +23,9 @@ struct EventType
 {
 	TimedCallback callback;
 	const char *name;
+	// Events of this type in event_queue, so that IsScheduled and RemoveEvent
+	// don't have to look at the queue for the (common) types that aren't.
+	int num_scheduled;
 };
 
 std::vector<EventType> event_types;
@@ -33,15 +37,26 @@ struct BaseEvent
 	int type;
 };
 
-typedef LinkedListItem<BaseEvent> Event;
+struct Event : BaseEvent
+{
+	// Events due on the same tick run in the order they were scheduled.
+	u64 fifo_order;
+};
 
-// STATE_TO_SAVE
-static Event *first;
-static std::mutex tsWriteLock;
-Common::FifoQueue<BaseEvent, false> tsQueue;
+// For std::push_heap and friends, which keep the largest element in front.
+static bool IsLater(const Event &a, const Event &b)
+{
+	if (a.time != b.time)
+		return a.time > b.time;
+	return a.fifo_order > b.fifo_order;
+}
 
-// event pools
-Event *eventPool = 0;
+// STATE_TO_SAVE
+// Binary min-heap on (time, fifo_order); event_queue.front() is the next event.
+static std::vector<Event> event_queue;
+static u64 event_fifo_id;
+// Events from other threads, moved into event_queue by the CPU thread.
+static Common::MPSCQueue<BaseEvent> tsQueue;
 
 int downcount, slicelength;
 int maxSliceLength = MAX_SLICE_LENGTH;
@@ -59,20 +74,34 @@ int ev_lost;
 
 void (*advanceCallback)(int cyclesExecuted) = NULL;
 
-Event* GetNewEvent()
+static void AddEventToQueue(const BaseEvent &ne)
 {
-	if(!eventPool)
-		return new Event;
+	Event ev;
+	ev.time = ne.time;
+	ev.userdata = ne.userdata;
+	ev.type = ne.type;
+	ev.fifo_order = event_fifo_id++;
+	event_queue.push_back(ev);
+	std::push_heap(event_queue.begin(), event_queue.end(), IsLater);
+	event_types[ev.type].num_scheduled++;
+}
 
-	Event* ev = eventPool;
-	eventPool = ev->next;
+// Takes the next event off the queue; the queue must not be empty.
+static Event PopEvent()
+{
+	std::pop_heap(event_queue.begin(), event_queue.end(), IsLater);
+	Event ev = event_queue.back();
+	event_queue.pop_back();
+	event_types[ev.type].num_scheduled--;
 	return ev;
 }
 
-void FreeEvent(Event* ev)
+// Pending events in the order they will run, for savestates, the logs and the debugger.
+static std::vector<Event> GetSortedEvents()
 {
-	ev->next = eventPool;
-	eventPool = ev;
+	std::vector<Event> events(event_queue);
+	std::sort(events.begin(), events.end(), [](const Event &a, const Event &b) { return IsLater(b, a); });
+	return events;
 }
 
 static void EmptyTimedCallback(u64 userdata, int cyclesLate) {}
@@ -82,6 +111,7 @@ int RegisterEvent(const char *name, TimedCallback callback)
 	EventType type;
 	type.name = name;
 	type.callback = callback;
+	type.num_scheduled = 0;
 
 	// check for existing type with same name.
 	// we want event type names to remain unique so that we can use them for serialization.
@@ -103,7 +133,7 @@ int RegisterEvent(const char *name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-	if (first)
+	if (!event_queue.empty())
 		PanicAlertT("Cannot unregister events with events pending");
 	event_types.clear();
 }
@@ -120,17 +150,10 @@ void Init()
 
 void Shutdown()
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	MoveEvents();
 	ClearPendingEvents();
 	UnregisterAllEvents();
-
-	while(eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
+	std::vector<Event>().swap(event_queue);
 }
 
 void EventDoState(PointerWrap &p, BaseEvent* ev)
@@ -169,7 +192,6 @@ void EventDoState(PointerWrap &p, BaseEvent* ev)
 
 void DoState(PointerWrap &p)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	p.Do(downcount);
 	p.Do(slicelength);
 	p.Do(globalTimer);
@@ -182,7 +204,35 @@ void DoState(PointerWrap &p)
 
 	MoveEvents();
 
-	p.DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, EventDoState>(first);
+	// Stored the way PointerWrap::DoLinkedList lays out a list: the events in the
+	// order they will run, each prefixed with a 1, and a 0 at the end.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		ClearPendingEvents();
+		while (true)
+		{
+			u8 shouldExist = 0;
+			p.Do(shouldExist);
+			if (shouldExist != 1)
+				break;
+
+			Event ev;
+			EventDoState(p, &ev);
+			AddEventToQueue(ev);
+		}
+	}
+	else
+	{
+		std::vector<Event> events = GetSortedEvents();
+		for (Event &ev : events)
+		{
+			u8 shouldExist = 1;
+			p.Do(shouldExist);
+			EventDoState(p, &ev);
+		}
+		u8 shouldExist = 0;
+		p.Do(shouldExist);
+	}
 	p.DoMarker("CoreTimingEvents");
 }
 
@@ -198,10 +248,10 @@ u64 GetIdleTicks()
 
 // This is to be called when outside threads, such as the graphics thread, wants to
 // schedule things to be executed on the main thread.
+// Doesn't lock, so it is fine to call this often.
 void ScheduleEvent_Threadsafe(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
-	Event ne;
+	BaseEvent ne;
 	ne.time = globalTimer + cyclesIntoFuture;
 	ne.type = event_type;
 	ne.userdata = userdata;
@@ -224,41 +274,21 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata)
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
+	event_queue.clear();
+	for (auto& event_type : event_types)
+		event_type.num_scheduled = 0;
 }
 
-void AddEventToQueue(Event* ne)
-{
-	Event* prev = NULL;
-	Event** pNext = &first;
-	for(;;)
-	{
-		Event*& next = *pNext;
-		if(!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
-}
 
 // This must be run ONLY from within the cpu thread
 // cyclesIntoFuture may be VERY inaccurate if called from anything else
 // than Advance
 void ScheduleEvent(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = globalTimer + cyclesIntoFuture;
+	BaseEvent ne;
+	ne.userdata = userdata;
+	ne.type = event_type;
+	ne.time = globalTimer + cyclesIntoFuture;
 	AddEventToQueue(ne);
 }
 
@@ -269,55 +299,19 @@ void RegisterAdvanceCallback(void (*callback)(int cyclesExecuted))
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e) {
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return event_types[event_type].num_scheduled != 0;
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
+	if (!event_types[event_type].num_scheduled)
 		return;
 
-	while(first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	if (!first)
-		return;
-
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
-	}
+	// fifo_order stays with each event, so rebuilding keeps same tick events in order.
+	event_queue.erase(std::remove_if(event_queue.begin(), event_queue.end(),
+		[event_type](const Event &ev) { return ev.type == event_type; }), event_queue.end());
+	std::make_heap(event_queue.begin(), event_queue.end(), IsLater);
+	event_types[event_type].num_scheduled = 0;
 }
 
 void RemoveAllEvents(int event_type)
@@ -351,36 +345,21 @@ void ProcessFifoWaitEvents()
 {
 	MoveEvents();
 
-	if (!first)
-		return;
-
-	while (first)
+	while (!event_queue.empty() && event_queue.front().time <= globalTimer)
 	{
-		if (first->time <= globalTimer)
-		{
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		Event evt = PopEvent();
+		event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
 	}
 }
 
 void MoveEvents()
 {
+	if (tsQueue.Empty())
+		return;
+
 	BaseEvent sevt;
 	while (tsQueue.Pop(sevt))
-	{
-		Event *evt = GetNewEvent();
-		evt->time = sevt.time;
-		evt->userdata = sevt.userdata;
-		evt->type = sevt.type;
-		AddEventToQueue(evt);
-	}
+		AddEventToQueue(sevt);
 }
 
 void Advance()
@@ -391,31 +370,22 @@ void Advance()
 	globalTimer += cyclesExecuted;
 	downcount = slicelength;
 
-	while (first)
+	while (!event_queue.empty() && event_queue.front().time <= globalTimer)
 	{
-		if (first->time <= globalTimer)
-		{
-//			LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
-//				event_types[first->type].name ? event_types[first->type].name : "?", (u64)globalTimer, (u64)first->time);
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		Event evt = PopEvent();
+//		LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
+//			event_types[evt.type].name ? event_types[evt.type].name : "?", (u64)globalTimer, (u64)evt.time);
+		event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
 	}
 
-	if (!first)
+	if (event_queue.empty())
 	{
 		WARN_LOG(POWERPC, "WARNING - no events in queue. Setting downcount to 10000");
 		downcount += 10000;
 	}
 	else
 	{
-		slicelength = (int)(first->time - globalTimer);
+		slicelength = (int)(event_queue.front().time - globalTimer);
 		if (slicelength > maxSliceLength)
 			slicelength = maxSliceLength;
 		downcount = slicelength;
@@ -427,12 +397,8 @@ void Advance()
 
 void LogPendingEvents()
 {
-	Event *ptr = first;
-	while (ptr)
-	{
-		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
-	}
+	for (const Event &ev : GetSortedEvents())
+		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ev.time, ev.type);
 }
 
 void Idle()
@@ -456,21 +422,19 @@ void Idle()
 
 std::string GetScheduledEventsSummary()
 {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr)
+	for (const Event &ev : GetSortedEvents())
 	{
-		unsigned int t = ptr->type;
+		unsigned int t = ev.type;
 		if (t >= event_types.size())
 			PanicAlertT("Invalid event type %i", t);
 
-		const char *name = event_types[ptr->type].name;
+		const char *name = event_types[ev.type].name;
 		if (!name)
 			name = "[unknown]";
 
-		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name, ptr->time, ptr->userdata);
-		ptr = ptr->next;
+		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name, ev.time, ev.userdata);
 	}
 	return text;
 }
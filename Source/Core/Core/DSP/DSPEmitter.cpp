@@ -10,6 +10,7 @@
 #include "DSPHost.h"
 #include "DSPInterpreter.h"
 #include "DSPAnalyzer.h"
+#include "JitRegister.h"
 
 #define MAX_BLOCK_SIZE 250
 #define DSP_IDLE_SKIP_CYCLES 0x1000
@@ -370,6 +371,8 @@ void DSPEmitter::Compile(u16 start_addr)
 		MOV(16, R(EAX), Imm16(blockSize[start_addr]));
 	}
 	JMP(returnDispatcher, true);
+
+	JitRegister::Register(entryPoint, (u32)(GetCodePtr() - entryPoint), "JIT_DSP_%04x", start_addr);
 }
 
 const u8 *DSPEmitter::CompileStub()
@@ -378,6 +381,7 @@ const u8 *DSPEmitter::CompileStub()
 	ABI_CallFunction((void *)&CompileCurrent);
 	XOR(32, R(EAX), R(EAX)); // Return 0 cycles executed
 	JMP(returnDispatcher);
+	JitRegister::Register(entryPoint, (u32)(GetCodePtr() - entryPoint), "JIT_DSP_Stub");
 	return entryPoint;
 }
 
@@ -427,4 +431,6 @@ void DSPEmitter::CompileDispatcher()
 	//MOV(32, M(&cyclesLeft), Imm32(0));
 	ABI_PopAllCalleeSavedRegsAndAdjustStack();
 	RET();
+
+	JitRegister::Register(enterDispatcher, (u32)(GetCodePtr() - enterDispatcher), "JIT_DSP_Dispatcher");
 }
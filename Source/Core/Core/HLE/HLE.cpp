@@ -13,6 +13,7 @@
 
 #include "HLE_OS.h"
 #include "HLE_Misc.h"
+#include "HLE_SDK.h"
 #include "IPC_HLE/WII_IPC_HLE_Device_es.h"
 #include "ConfigManager.h"
 #include "Core.h"
@@ -64,6 +65,16 @@ static const SPatch OSPatches[] =
 	{ "___blank",             HLE_OS::HLE_GeneralDebugPrint,   HLE_HOOK_REPLACE, HLE_TYPE_DEBUG },
 	{ "__write_console",      HLE_OS::HLE_write_console,       HLE_HOOK_REPLACE, HLE_TYPE_DEBUG }, // used by sysmenu (+more?)
 	{ "GeckoCodehandler",     HLE_Misc::HLEGeckoCodehandler,   HLE_HOOK_START,   HLE_TYPE_GENERIC },
+
+	// SDK routines. memset is a wrapper around __fill_mem.
+	{ "memcpy",               HLE_SDK::Memcpy,                 HLE_HOOK_REPLACE, HLE_TYPE_SDK },
+	{ "memmove",              HLE_SDK::Memcpy,                 HLE_HOOK_REPLACE, HLE_TYPE_SDK },
+	{ "__fill_mem",           HLE_SDK::FillMem,                HLE_HOOK_REPLACE, HLE_TYPE_SDK },
+	{ "DCFlushRange",         HLE_SDK::DCFlushRange,           HLE_HOOK_REPLACE, HLE_TYPE_SDK },
+	{ "DCStoreRange",         HLE_SDK::DCStoreRange,           HLE_HOOK_REPLACE, HLE_TYPE_SDK },
+	{ "OSDisableInterrupts",  HLE_SDK::OSDisableInterrupts,    HLE_HOOK_REPLACE, HLE_TYPE_SDK },
+	{ "PSMTXIdentity",        HLE_SDK::PSMTXIdentity,          HLE_HOOK_REPLACE, HLE_TYPE_SDK },
+	{ "PSMTXConcat",          HLE_SDK::PSMTXConcat,            HLE_HOOK_REPLACE, HLE_TYPE_SDK },
 };
 
 static const SPatch OSBreakPoints[] =
@@ -120,7 +131,13 @@ void Execute(u32 _CurrentPC, u32 _Instruction)
 	unsigned int FunctionIndex = _Instruction & 0xFFFFF;
 	if ((FunctionIndex > 0) && (FunctionIndex < (sizeof(OSPatches) / sizeof(SPatch))))
 	{
-		OSPatches[FunctionIndex].PatchFunction();
+		// The JITs don't keep PC up to date, and the SDK routines can fall
+		// back to running the game's code from it.
+		PC = _CurrentPC;
+		if (OSPatches[FunctionIndex].flags == HLE_TYPE_SDK && Core::g_CoreStartupParameter.bHLE_SDKValidate)
+			HLE_SDK::Validate(OSPatches[FunctionIndex].PatchFunction, OSPatches[FunctionIndex].m_szPatchName);
+		else
+			OSPatches[FunctionIndex].PatchFunction();
 	}
 	else
 	{
@@ -151,6 +168,9 @@ bool IsEnabled(int flags)
 	if (flags == HLE::HLE_TYPE_MEMORY && Core::g_CoreStartupParameter.bMMU)
 		return false;
 
+	if (flags == HLE::HLE_TYPE_SDK && (!Core::g_CoreStartupParameter.bHLE_SDK || Core::g_CoreStartupParameter.bMMU))
+		return false;
+
 	if (flags == HLE::HLE_TYPE_DEBUG && !Core::g_CoreStartupParameter.bEnableDebugging && PowerPC::GetMode() != MODE_INTERPRETER)
 		return false;
 
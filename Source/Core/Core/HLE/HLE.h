@@ -23,6 +23,7 @@ namespace HLE
 		HLE_TYPE_MEMORY  = 1,    // Memory operation
 		HLE_TYPE_FP      = 2,    // Floating Point operation
 		HLE_TYPE_DEBUG   = 3,    // Debug output function
+		HLE_TYPE_SDK     = 4,    // Native version of an SDK routine
 	};
 
 	void PatchFunctions();
@@ -0,0 +1,349 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "StringUtil.h"
+#include "HLE_SDK.h"
+
+#include "../PowerPC/PowerPC.h"
+#include "../PowerPC/PPCTables.h"
+#include "../PowerPC/JitInterface.h"
+#include "../PowerPC/Interpreter/Interpreter_FPUtils.h"
+#include "../HW/Memmap.h"
+
+namespace HLE_SDK
+{
+
+namespace
+{
+
+const u32 MTX_SIZE = 3 * 4 * 4;
+
+// True if the range is RAM the host can get at through a single pointer.
+bool IsRAMRange(u32 address, u32 size)
+{
+	if (size == 0)
+		return true;
+
+	const u32 last = address + size - 1;
+	return last >= address && (address >> 28) == (last >> 28) &&
+		Memory::IsRAMAddress(address) && Memory::IsRAMAddress(last);
+}
+
+// The paired single operations the SDK's matrix code is made of, rounded and
+// converted exactly the way the interpreter does it.
+struct Pair
+{
+	double ps0, ps1;
+};
+
+Pair LoadPair(u32 address)
+{
+	u32 ps0 = Memory::Read_U32(address);
+	u32 ps1 = Memory::Read_U32(address + 4);
+	Pair result = { *(float*)&ps0, *(float*)&ps1 };
+	return result;
+}
+
+void StorePair(const Pair &value, u32 address)
+{
+	Memory::Write_U32(ConvertToSingleFTZ(*(u64*)&value.ps0), address);
+	Memory::Write_U32(ConvertToSingleFTZ(*(u64*)&value.ps1), address + 4);
+}
+
+Pair MulS0(const Pair &a, const Pair &c)
+{
+	Pair result = { ForceSingle(NI_mul(a.ps0, c.ps0)), ForceSingle(NI_mul(a.ps1, c.ps0)) };
+	return result;
+}
+
+Pair MaddS0(const Pair &a, const Pair &c, const Pair &b)
+{
+	Pair result = { ForceSingle(NI_madd(a.ps0, c.ps0, b.ps0)), ForceSingle(NI_madd(a.ps1, c.ps0, b.ps1)) };
+	return result;
+}
+
+Pair MaddS1(const Pair &a, const Pair &c, const Pair &b)
+{
+	Pair result = { ForceSingle(NI_madd(a.ps0, c.ps1, b.ps0)), ForceSingle(NI_madd(a.ps1, c.ps1, b.ps1)) };
+	return result;
+}
+
+// DCFlushRange and DCStoreRange only differ in the cache instruction, which
+// only invalidates JIT blocks for us. The trailing sc is a sync and is skipped.
+void InvalidateRange()
+{
+	u32 address = GPR(3);
+	u32 size = GPR(4);
+	if (size != 0)
+	{
+		if (address & 0x1f)
+			size += 0x20;
+		u32 lines = (size + 0x1f) >> 5;
+		JitInterface::InvalidateICache(address & ~0x1f, lines << 5);
+	}
+	NPC = LR;
+}
+
+struct Registers
+{
+	u32 gpr[32];
+	u64 ps[32][2];
+	u8 cr_fast[8];
+	u32 msr;
+	u32 fpscr;
+	u32 spr[1024];
+};
+
+void SaveRegisters(Registers &regs)
+{
+	memcpy(regs.gpr, PowerPC::ppcState.gpr, sizeof(regs.gpr));
+	memcpy(regs.ps, PowerPC::ppcState.ps, sizeof(regs.ps));
+	memcpy(regs.cr_fast, PowerPC::ppcState.cr_fast, sizeof(regs.cr_fast));
+	regs.msr = PowerPC::ppcState.msr;
+	regs.fpscr = PowerPC::ppcState.fpscr;
+	memcpy(regs.spr, PowerPC::ppcState.spr, sizeof(regs.spr));
+}
+
+void LoadRegisters(const Registers &regs)
+{
+	memcpy(PowerPC::ppcState.gpr, regs.gpr, sizeof(regs.gpr));
+	memcpy(PowerPC::ppcState.ps, regs.ps, sizeof(regs.ps));
+	memcpy(PowerPC::ppcState.cr_fast, regs.cr_fast, sizeof(regs.cr_fast));
+	PowerPC::ppcState.msr = regs.msr;
+	PowerPC::ppcState.fpscr = regs.fpscr;
+	memcpy(PowerPC::ppcState.spr, regs.spr, sizeof(regs.spr));
+}
+
+// What a routine leaves behind besides the non-volatile registers: whether r3
+// is a return value, and the memory it writes, given by the register holding
+// the address and either a register holding the size or a fixed size.
+struct Routine
+{
+	void (*function)();
+	bool returns_value;
+	int address_reg;
+	int size_reg;
+	u32 size;
+};
+
+const Routine routines[] =
+{
+	{ Memcpy,              true,  3,  5,  0 },
+	{ FillMem,             false, 3,  5,  0 },
+	{ DCFlushRange,        false, -1, -1, 0 },
+	{ DCStoreRange,        false, -1, -1, 0 },
+	{ OSDisableInterrupts, true,  -1, -1, 0 },
+	{ PSMTXIdentity,       false, 3,  -1, MTX_SIZE },
+	{ PSMTXConcat,         false, 5,  -1, MTX_SIZE },
+};
+
+}
+
+void Memcpy()
+{
+	// The SDK's memcpy copies backwards when the destination is above the
+	// source, so it behaves like memmove, and memmove is the same code.
+	const u32 dst = GPR(3);
+	const u32 src = GPR(4);
+	const u32 size = GPR(5);
+	if (!IsRAMRange(dst, size) || !IsRAMRange(src, size))
+	{
+		RunOriginal();
+		return;
+	}
+
+	if (size != 0)
+		memmove(Memory::GetPointer(dst), Memory::GetPointer(src), size);
+	NPC = LR;
+}
+
+void FillMem()
+{
+	const u32 dst = GPR(3);
+	const u32 size = GPR(5);
+	if (!IsRAMRange(dst, size))
+	{
+		RunOriginal();
+		return;
+	}
+
+	if (size != 0)
+		memset(Memory::GetPointer(dst), (u8)GPR(4), size);
+	NPC = LR;
+}
+
+void DCFlushRange()
+{
+	InvalidateRange();
+}
+
+void DCStoreRange()
+{
+	InvalidateRange();
+}
+
+void OSDisableInterrupts()
+{
+	GPR(3) = (MSR >> 15) & 1;
+	MSR &= ~0x8000;
+	NPC = LR;
+}
+
+void PSMTXIdentity()
+{
+	const u32 m = GPR(3);
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 4; column++)
+			Memory::Write_U32(row == column ? 0x3f800000 : 0, m + (row * 4 + column) * 4);
+	}
+	NPC = LR;
+}
+
+void PSMTXConcat()
+{
+	const u32 a = GPR(3);
+	const u32 b = GPR(4);
+	const u32 ab = GPR(5);
+
+	// Everything is loaded before anything is stored, so ab may be a or b.
+	Pair A[6], B[6];
+	for (int i = 0; i < 6; i++)
+	{
+		A[i] = LoadPair(a + i * 8);
+		B[i] = LoadPair(b + i * 8);
+	}
+
+	// Same operations in the same order as the SDK, down to the 0 * a[r][3]
+	// it adds to the third column, which matters for NaNs and negative zeros.
+	const Pair unit01 = { 0.0, 1.0 };
+	Pair AB[6];
+	for (int row = 0; row < 3; row++)
+	{
+		const Pair &a01 = A[row * 2];
+		const Pair &a23 = A[row * 2 + 1];
+		Pair left = MulS0(B[0], a01);
+		Pair right = MulS0(B[1], a01);
+		left = MaddS1(B[2], a01, left);
+		right = MaddS1(B[3], a01, right);
+		left = MaddS0(B[4], a23, left);
+		right = MaddS0(B[5], a23, right);
+		AB[row * 2] = left;
+		AB[row * 2 + 1] = MaddS1(unit01, a23, right);
+	}
+
+	for (int i = 0; i < 6; i++)
+		StorePair(AB[i], ab + i * 8);
+	UpdateFPRF(AB[5].ps0);
+	NPC = LR;
+}
+
+void RunOriginal()
+{
+	// The function has returned when it's back at LR with its stack frame
+	// popped. Recursion can't come back to LR with the same stack pointer.
+	const u32 return_address = LR;
+	const u32 stack = GPR(1);
+	do
+	{
+		UGeckoInstruction inst = Memory::Read_Opcode(PC);
+		NPC = PC + 4;
+		GetInterpreterOp(inst)(inst);
+		PC = NPC;
+	} while (PC != return_address || GPR(1) != stack);
+}
+
+bool Validate(void (*function)(), const char *name)
+{
+	const Routine *routine = NULL;
+	for (size_t i = 0; i < ArraySize(routines); i++)
+	{
+		if (routines[i].function == function)
+			routine = &routines[i];
+	}
+	_assert_msg_(OSHLE, routine, "%s isn't an SDK routine", name);
+
+	u32 out_address = 0;
+	u32 out_size = 0;
+	if (routine->address_reg >= 0)
+	{
+		out_address = GPR(routine->address_reg);
+		out_size = routine->size_reg >= 0 ? GPR(routine->size_reg) : routine->size;
+	}
+
+	// Writes to hardware can't be done twice, these are left to the game's code.
+	if (!IsRAMRange(out_address, out_size))
+	{
+		RunOriginal();
+		NPC = PC;
+		return true;
+	}
+
+	u8 *out = out_size ? Memory::GetPointer(out_address) : NULL;
+	const u32 entry_pc = PC;
+	Registers entry, original;
+	SaveRegisters(entry);
+	std::vector<u8> entry_memory(out, out + out_size);
+
+	RunOriginal();
+	const u32 original_npc = PC;
+	SaveRegisters(original);
+	std::vector<u8> original_memory(out, out + out_size);
+
+	LoadRegisters(entry);
+	std::copy(entry_memory.begin(), entry_memory.end(), out);
+	PC = entry_pc;
+	function();
+
+	std::string differences;
+	if (NPC != original_npc)
+		differences += StringFromFormat(" NPC %08x/%08x", NPC, original_npc);
+	for (int i = 1; i < 32; i++)
+	{
+		if ((i == 3 && routine->returns_value) || i == 1 || i == 2 || i >= 13)
+		{
+			if (GPR(i) != original.gpr[i])
+				differences += StringFromFormat(" r%d %08x/%08x", i, GPR(i), original.gpr[i]);
+		}
+	}
+	// The SDK saves the second halves of the paired singles with psq_st, which
+	// rounds them to singles, so only the first halves are compared.
+	for (int i = 14; i < 32; i++)
+	{
+		if (PowerPC::ppcState.ps[i][0] != original.ps[i][0])
+			differences += StringFromFormat(" f%d", i);
+	}
+	if (MSR != original.msr)
+		differences += StringFromFormat(" MSR %08x/%08x", MSR, original.msr);
+	if (PowerPC::ppcState.fpscr != original.fpscr)
+		differences += StringFromFormat(" FPSCR %08x/%08x", PowerPC::ppcState.fpscr, original.fpscr);
+	for (u32 i = 0; i < out_size; i++)
+	{
+		if (out[i] != original_memory[i])
+		{
+			differences += StringFromFormat(" memory at %08x %02x/%02x", out_address + i, out[i], original_memory[i]);
+			break;
+		}
+	}
+
+	LoadRegisters(original);
+	std::copy(original_memory.begin(), original_memory.end(), out);
+	PC = entry_pc;
+	NPC = original_npc;
+
+	if (!differences.empty())
+	{
+		ERROR_LOG(OSHLE, "%s at %08x doesn't match the game's code (native/game):%s", name, entry_pc, differences.c_str());
+		return false;
+	}
+	return true;
+}
+
+}  // end of namespace HLE_SDK
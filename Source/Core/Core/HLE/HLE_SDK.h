@@ -0,0 +1,27 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Native versions of small, hot SDK routines. The signature database finds
+// them at boot, and they must leave the emulated machine exactly as the
+// game's own code would have.
+
+namespace HLE_SDK
+{
+	void Memcpy();
+	void FillMem();
+	void DCFlushRange();
+	void DCStoreRange();
+	void OSDisableInterrupts();
+	void PSMTXIdentity();
+	void PSMTXConcat();
+
+	// Runs the game's code for the function at PC up to where it returns.
+	void RunOriginal();
+
+	// Runs both the game's code and the native version from the same state
+	// and logs any difference. The game's results are kept either way.
+	bool Validate(void (*function)(), const char *name);
+}
@@ -12,6 +12,7 @@
 #include "EXI.h"
 #include "GPFifo.h"
 #include "Memmap.h"
+#include "WriteWatch.h"
 #include "ProcessorInterface.h"
 #include "SI.h"
 #include "AudioInterface.h"
@@ -60,6 +61,7 @@ namespace HW
 		ExpansionInterface::Shutdown();
 		DVDInterface::Shutdown();
 		DSP::Shutdown();
+		WriteWatch::Shutdown();
 		Memory::Shutdown();
 		SerialInterface::Shutdown();
 		AudioInterface::Shutdown();
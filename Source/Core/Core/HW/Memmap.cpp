@@ -352,6 +352,7 @@ void Init()
 		InitHWMemFuncsWii();
 	else
 		InitHWMemFuncs();
+	ClearFastTLB();
 
 	INFO_LOG(MEMMAP, "Memory system initialized. RAM at %p (mirrors at 0 @ %p, 0x80000000 @ %p , 0xC0000000 @ %p)",
 		m_pRAM, m_pPhysicalRAM, m_pVirtualCachedRAM, m_pVirtualUncachedRAM);
@@ -371,6 +372,10 @@ void DoState(PointerWrap &p)
 	if (wii)
 		p.DoArray(m_pEXRAM, EXRAM_SIZE);
 	p.DoMarker("Memory EXRAM");
+
+	// The page table and the BATs come back with the rest of the state.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		ClearFastTLB();
 }
 
 void Shutdown()
@@ -146,6 +146,12 @@ u32 Read_U16_ZX(const u32 _Address);
 // used by JIT (Jit64::lXz)
 u32 EFB_Read(const u32 addr);
 
+// used by JIT (Jit64, for constant addresses). The hardware register handler
+// Read_U8/16/32 or Write_U8/16/32 end up calling for the address, NULL if the
+// address isn't a register with one (RAM, the EFB, the GP FIFO).
+const void *GetHWReadHandler(const u32 _Address, int accessSize);
+const void *GetHWWriteHandler(const u32 _Address, int accessSize);
+
 void Write_U8(const u8 _Data, const u32 _Address);
 void Write_U16(const u16 _Data, const u32 _Address);
 void Write_U32(const u32 _Data, const u32 _Address);
@@ -179,6 +185,21 @@ enum XCheckTLBFlag
 };
 u32 TranslateAddress(u32 _Address, XCheckTLBFlag _Flag);
 void InvalidateTLBEntry(u32 _Address);
+
+// Page translations made for reads and writes, for the JIT's inline lookup on
+// MMU games. Indexed by effective page number; each entry is the page's
+// address in the cached RAM view (so never 0), or 0 if the access has to go
+// through TranslateAddress.
+enum
+{
+	FAST_TLB_PAGE_SHIFT = 12,
+	FAST_TLB_ENTRIES = 1 << (32 - FAST_TLB_PAGE_SHIFT),
+};
+extern u32 fast_tlb_read[FAST_TLB_ENTRIES];
+extern u32 fast_tlb_write[FAST_TLB_ENTRIES];
+void ClearFastTLB();
+// Drops the translations of one 256MB segment, for when its segment register changes.
+void ClearFastTLBSegment(u32 segment);
 void GenerateDSIException(u32 _EffectiveAdress, bool _bWrite);
 void GenerateISIException(u32 _EffectiveAdress);
 extern u32 pagetable_base;
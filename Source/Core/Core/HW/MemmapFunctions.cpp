@@ -147,6 +147,34 @@ u32 EFB_Read(const u32 addr)
 	return var;
 }
 
+u32 fast_tlb_read[FAST_TLB_ENTRIES];
+u32 fast_tlb_write[FAST_TLB_ENTRIES];
+
+void ClearFastTLB()
+{
+	memset(fast_tlb_read, 0, sizeof(fast_tlb_read));
+	memset(fast_tlb_write, 0, sizeof(fast_tlb_write));
+}
+
+void ClearFastTLBSegment(u32 segment)
+{
+	const u32 first = (segment & 0xF) << (28 - FAST_TLB_PAGE_SHIFT);
+	const u32 count = 1 << (28 - FAST_TLB_PAGE_SHIFT);
+	memset(&fast_tlb_read[first], 0, count * sizeof(u32));
+	memset(&fast_tlb_write[first], 0, count * sizeof(u32));
+}
+
+// Called for accesses that went through TranslateAddress and hit RAM, so a
+// hit in the JIT behaves exactly like this did.
+static inline void UpdateFastTLB(const u32 em_address, const u32 tlb_addr, Memory::XCheckTLBFlag flag)
+{
+	const u32 page = ((tlb_addr & RAM_MASK) | 0x80000000) & ~0xfff;
+	if (flag == FLAG_READ)
+		fast_tlb_read[em_address >> FAST_TLB_PAGE_SHIFT] = page;
+	else if (flag == FLAG_WRITE)
+		fast_tlb_write[em_address >> FAST_TLB_PAGE_SHIFT] = page;
+}
+
 template <typename T>
 inline void ReadFromHardware(T &_var, const u32 em_address, const u32 effective_address, Memory::XCheckTLBFlag flag)
 {
@@ -205,6 +233,7 @@ inline void ReadFromHardware(T &_var, const u32 em_address, const u32 effective_
 		}
 		else
 		{
+			UpdateFastTLB(em_address, tlb_addr, flag);
 			_var = bswap((*(const T*)&m_pRAM[tlb_addr & RAM_MASK]));
 		}
 	}
@@ -307,6 +336,7 @@ inline void WriteToHardware(u32 em_address, const T data, u32 effective_address,
 		}
 		else
 		{
+			UpdateFastTLB(em_address, tlb_addr, flag);
 			*(T*)&m_pRAM[tlb_addr & RAM_MASK] = bswap(data);
 		}
 	}
@@ -314,6 +344,58 @@ inline void WriteToHardware(u32 em_address, const T data, u32 effective_address,
 // =====================
 
 
+// Same ranges as ReadFromHardware and WriteToHardware.
+const void *GetHWReadHandler(const u32 _Address, int accessSize)
+{
+	const u32 index = (_Address >> HWSHIFT) & (NUMHWMEMFUN - 1);
+	if (_Address >= 0xCC000000 && _Address <= 0xCC009000)
+	{
+		switch (accessSize)
+		{
+		case 8:  return (const void *)hwRead8[index];
+		case 16: return (const void *)hwRead16[index];
+		case 32: return (const void *)hwRead32[index];
+		}
+	}
+	else if (_Address >= 0xCD000000 && _Address <= 0xCD009000)
+	{
+		switch (accessSize)
+		{
+		case 8:  return (const void *)hwReadWii8[index];
+		case 16: return (const void *)hwReadWii16[index];
+		case 32: return (const void *)hwReadWii32[index];
+		}
+	}
+	return NULL;
+}
+
+const void *GetHWWriteHandler(const u32 _Address, int accessSize)
+{
+	const u32 index = (_Address >> HWSHIFT) & (NUMHWMEMFUN - 1);
+	// WriteToHardware sends this one to GPFifo first.
+	if (_Address == 0xCC008000)
+		return NULL;
+	if (_Address >= 0xCC000000 && _Address <= 0xCC009000)
+	{
+		switch (accessSize)
+		{
+		case 8:  return (const void *)hwWrite8[index];
+		case 16: return (const void *)hwWrite16[index];
+		case 32: return (const void *)hwWrite32[index];
+		}
+	}
+	else if (_Address >= 0xCD000000 && _Address <= 0xCD009000)
+	{
+		switch (accessSize)
+		{
+		case 8:  return (const void *)hwWriteWii8[index];
+		case 16: return (const void *)hwWriteWii16[index];
+		case 32: return (const void *)hwWriteWii32[index];
+		}
+	}
+	return NULL;
+}
+
 // =================================
 /* These functions are primarily called by the Interpreter functions and are routed to the correct
    location through ReadFromHardware and WriteToHardware */
@@ -681,6 +763,7 @@ void SDRUpdated()
 	}
 	PowerPC::ppcState.pagetable_base = htaborg<<16;
 	PowerPC::ppcState.pagetable_hashmask = ((xx<<10)|0x3ff);
+	ClearFastTLB();
 }
 
 
@@ -800,6 +883,9 @@ void UpdateTLBEntry(const XCheckTLBFlag _Flag, UPTE2 PTE2, const u32 vpa)
 
 void InvalidateTLBEntry(u32 vpa)
 {
+	fast_tlb_read[vpa >> FAST_TLB_PAGE_SHIFT] = 0;
+	fast_tlb_write[vpa >> FAST_TLB_PAGE_SHIFT] = 0;
+
 #ifdef FAST_TLB_CACHE
 	tlb_entry *tlbe = tlb[0][(vpa>>HW_PAGE_INDEX_SHIFT)&HW_PAGE_INDEX_MASK];
 	if(tlbe[0].tag == (vpa & ~0xfff))
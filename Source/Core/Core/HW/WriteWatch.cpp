@@ -0,0 +1,290 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+
+#include "Common.h"
+#include "MemoryUtil.h"
+#include "Thread.h"
+
+#include "Memmap.h"
+#include "WriteWatch.h"
+
+namespace Memory
+{
+// The high views, which are what the JIT and GetPointer use
+extern u8 *m_pPhysicalRAM;
+extern u8 *m_pVirtualCachedRAM;
+extern u8 *m_pVirtualUncachedRAM;
+extern u8 *m_pPhysicalEXRAM;
+extern u8 *m_pVirtualCachedEXRAM;
+extern u8 *m_pVirtualUncachedEXRAM;
+}
+
+namespace WriteWatch
+{
+
+enum
+{
+	PAGE_SHIFT = 12,
+	PAGE_SIZE = 1 << PAGE_SHIFT,
+
+	MAX_VIEWS = 4,
+	MAX_REGIONS = 2,
+	EXRAM_ADDRESS = 0x10000000,
+	MAX_REGION_PAGES = Memory::EXRAM_SIZE >> PAGE_SHIFT,
+
+	// Each fault heats a page up, each frame cools it down by one. Pages that
+	// get too hot (written in most frames) aren't watched until they cool down
+	// again, a fault per frame would cost more than hashing them.
+	FAULT_HEAT = 4,
+	HOT_PAGE_HEAT = 8,
+	MAX_HEAT = 64,
+};
+
+// The exception handler can run on any thread, in the middle of any of the
+// functions below, and must not take locks. It only uses the atomics here;
+// everything else is set up before s_enabled is set and stays until after it
+// is cleared.
+struct Region
+{
+	u32 address;
+	u32 size;
+	u8 *views[MAX_VIEWS];
+	int num_views;
+
+	// One bit per page. Bits are set before their pages get protected and
+	// cleared after they are unprotected, so a protected page is always
+	// marked as watched.
+	std::atomic<u32> watched[MAX_REGION_PAGES / 32];
+	// Only a heuristic, updates racing with each other may get lost.
+	std::atomic<u8> heat[MAX_REGION_PAGES];
+};
+
+static Region s_regions[MAX_REGIONS];
+static int s_num_regions;
+static std::atomic<bool> s_enabled;
+
+// Serializes everything but the exception handler.
+static std::mutex s_lock;
+
+static void AddRegion(u32 address, u32 size, u8 *view0, u8 *view1, u8 *view2, u8 *view3)
+{
+	Region &region = s_regions[s_num_regions++];
+	region.address = address;
+	region.size = size;
+	region.num_views = 0;
+
+	// On 32-bit, the mirrors are the same view.
+	u8 *const views[MAX_VIEWS] = { view0, view1, view2, view3 };
+	for (u8 *view : views)
+	{
+		if (view && std::find(region.views, region.views + region.num_views, view) == region.views + region.num_views)
+			region.views[region.num_views++] = view;
+	}
+
+	for (auto &word : region.watched)
+		word.store(0, std::memory_order_relaxed);
+	for (auto &heat : region.heat)
+		heat.store(0, std::memory_order_relaxed);
+}
+
+static Region *FindRegion(u32 address, u32 size)
+{
+	for (int i = 0; i < s_num_regions; i++)
+	{
+		Region &region = s_regions[i];
+		if (address >= region.address && size <= region.size && address - region.address <= region.size - size)
+			return &region;
+	}
+	return NULL;
+}
+
+static void SetWritable(Region &region, u32 first_page, u32 num_pages, bool writable)
+{
+	for (int i = 0; i < region.num_views; i++)
+	{
+		u8 *ptr = region.views[i] + (first_page << PAGE_SHIFT);
+		if (writable)
+			UnWriteProtectMemory(ptr, num_pages << PAGE_SHIFT);
+		else
+			WriteProtectMemory(ptr, num_pages << PAGE_SHIFT);
+	}
+}
+
+static bool IsWatched(const Region &region, u32 page)
+{
+	return (region.watched[page / 32].load() >> (page % 32)) & 1;
+}
+
+// Returns whether the page was watched.
+static bool Unwatch(Region &region, u32 page)
+{
+	const u32 bit = 1u << (page % 32);
+	if (!(region.watched[page / 32].load() & bit))
+		return false;
+	SetWritable(region, page, 1, true);
+	return (region.watched[page / 32].fetch_and(~bit) & bit) != 0;
+}
+
+void Init()
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	if (s_enabled)
+		return;
+
+	s_num_regions = 0;
+	AddRegion(0, Memory::RAM_SIZE, Memory::m_pRAM, Memory::m_pPhysicalRAM,
+		Memory::m_pVirtualCachedRAM, Memory::m_pVirtualUncachedRAM);
+	if (Memory::m_pEXRAM)
+	{
+		AddRegion(EXRAM_ADDRESS, Memory::EXRAM_SIZE, Memory::m_pEXRAM, Memory::m_pPhysicalEXRAM,
+			Memory::m_pVirtualCachedEXRAM, Memory::m_pVirtualUncachedEXRAM);
+	}
+	s_enabled = true;
+}
+
+void Shutdown()
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	if (!s_enabled)
+		return;
+
+	// Pages are still watched until here, so faults have to be handled.
+	for (int i = 0; i < s_num_regions; i++)
+	{
+		for (u32 page = 0; page < s_regions[i].size >> PAGE_SHIFT; page++)
+			Unwatch(s_regions[i], page);
+	}
+	s_enabled = false;
+	s_num_regions = 0;
+}
+
+bool IsEnabled()
+{
+	return s_enabled;
+}
+
+bool Watch(u32 address, u32 size)
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	Region *region = s_enabled ? FindRegion(address, std::max(size, 1u)) : NULL;
+	if (!region)
+		return false;
+
+	const u32 first_page = (address - region->address) >> PAGE_SHIFT;
+	const u32 last_page = (address - region->address + std::max(size, 1u) - 1) >> PAGE_SHIFT;
+
+	for (u32 page = first_page; page <= last_page; page++)
+	{
+		if (region->heat[page].load(std::memory_order_relaxed) >= HOT_PAGE_HEAT)
+			return false;
+	}
+
+	// Protect each run of pages which aren't watched yet with one call per
+	// view. The bits go first, a write can fault as soon as a page is protected.
+	u32 page = first_page;
+	while (page <= last_page)
+	{
+		if (IsWatched(*region, page))
+		{
+			page++;
+			continue;
+		}
+
+		const u32 run_start = page;
+		for (; page <= last_page && !IsWatched(*region, page); page++)
+			region->watched[page / 32].fetch_or(1u << (page % 32));
+		SetWritable(*region, run_start, page - run_start, false);
+	}
+	return true;
+}
+
+bool IsWritten(u32 address, u32 size)
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	Region *region = s_enabled ? FindRegion(address, std::max(size, 1u)) : NULL;
+	if (!region)
+		return true;
+
+	const u32 first_page = (address - region->address) >> PAGE_SHIFT;
+	const u32 last_page = (address - region->address + std::max(size, 1u) - 1) >> PAGE_SHIFT;
+	for (u32 page = first_page; page <= last_page; page++)
+	{
+		if (!IsWatched(*region, page))
+			return true;
+	}
+	return false;
+}
+
+void PrepareHostWrite(const void *ptr, size_t size)
+{
+	if (!s_enabled || size == 0)
+		return;
+
+	std::lock_guard<std::mutex> lk(s_lock);
+	const uintptr_t start = (uintptr_t)ptr;
+	for (int i = 0; i < s_num_regions; i++)
+	{
+		Region &region = s_regions[i];
+		for (int v = 0; v < region.num_views; v++)
+		{
+			const uintptr_t view = (uintptr_t)region.views[v];
+			if (start < view || start - view >= region.size)
+				continue;
+
+			const uintptr_t end = std::min<uintptr_t>(start - view + size, region.size);
+			for (u32 page = (u32)((start - view) >> PAGE_SHIFT); page <= (u32)((end - 1) >> PAGE_SHIFT); page++)
+				Unwatch(region, page);
+			return;
+		}
+	}
+}
+
+void CoolDown()
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	for (int i = 0; i < s_num_regions; i++)
+	{
+		for (u32 page = 0; page < s_regions[i].size >> PAGE_SHIFT; page++)
+		{
+			std::atomic<u8> &heat = s_regions[i].heat[page];
+			const u8 value = heat.load(std::memory_order_relaxed);
+			if (value)
+				heat.store((u8)(value - 1), std::memory_order_relaxed);
+		}
+	}
+}
+
+bool HandleFault(uintptr_t host_address)
+{
+	if (!s_enabled)
+		return false;
+
+	// No locks in here, see Region.
+	for (int i = 0; i < s_num_regions; i++)
+	{
+		Region &region = s_regions[i];
+		for (int v = 0; v < region.num_views; v++)
+		{
+			const uintptr_t view = (uintptr_t)region.views[v];
+			if (host_address < view || host_address - view >= region.size)
+				continue;
+
+			// Not watched anymore means another thread got here first, the
+			// write can just be retried.
+			const u32 page = (u32)((host_address - view) >> PAGE_SHIFT);
+			if (Unwatch(region, page))
+			{
+				const u8 heat = region.heat[page].load(std::memory_order_relaxed);
+				region.heat[page].store((u8)std::min(heat + FAULT_HEAT, (int)MAX_HEAT), std::memory_order_relaxed);
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+}
@@ -0,0 +1,53 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "CommonTypes.h"
+
+// Page granular write tracking for MEM1 and MEM2.
+//
+// Watched pages are write protected in every view of the memory arena. The first
+// write to such a page, from the JIT, the interpreter or any other code, faults;
+// the exception handler (EMM) then unprotects the page and marks it as written.
+// This lets the texture cache skip hashing textures whose memory wasn't written
+// since they were last hashed.
+//
+// The OS doesn't raise a fault when it writes into a protected page itself, e.g.
+// in read() or recv(), the call just fails. Code passing guest memory to such
+// functions has to call PrepareHostWrite first.
+namespace WriteWatch
+{
+
+// Only called once the exception handler is installed, and only where it
+// handles faults from every thread (not on OS X). Until then (or without
+// fastmem), nothing is watched and every range counts as written.
+void Init();
+void Shutdown();
+bool IsEnabled();
+
+// Write protects the pages of the given physical range and marks them as not
+// written. Returns false if (part of) the range can't be watched, e.g. because
+// it's outside of RAM or written too often to be worth it.
+// Call it before reading the data, not after.
+bool Watch(u32 address, u32 size);
+
+// Whether any page of the range was written since it was watched. Always true
+// for ranges Watch returned false for.
+bool IsWritten(u32 address, u32 size);
+
+// Unprotects the pages of a host pointer into guest memory. Call before the OS
+// writes to it.
+void PrepareHostWrite(const void *ptr, size_t size);
+
+// Pages which keep getting written are no longer watched for a while.
+// Called once per frame.
+void CoolDown();
+
+// Called by the exception handler, on whichever thread faulted. Takes no
+// locks. Returns true if the fault was a write to a watched page, which can
+// now be retried.
+bool HandleFault(uintptr_t host_address);
+
+}
@@ -41,6 +41,7 @@
 
 #include "../PowerPC/PowerPC.h"
 #include "../VolumeHandler.h"
+#include "../HW/WriteWatch.h"
 #include "FileUtil.h"
 #include <polarssl/aes.h>
 #include "ConfigManager.h"
@@ -420,6 +421,7 @@ bool CWII_IPC_HLE_Device_es::IOCtlV(u32 _CommandAddress)
 							ERROR_LOG(WII_IPC_ES, "ES: couldn't seek!");
 						}
 						WARN_LOG(WII_IPC_ES, "2 %p", pFile->GetHandle());
+						WriteWatch::PrepareHostWrite(pDest, Size);
 						if (!pFile->ReadBytes(pDest, Size))
 						{
 							ERROR_LOG(WII_IPC_ES, "ES: short read; returning uninitialized data!");
@@ -5,6 +5,7 @@
 #include "../Core.h"
 #include "../Debugger/Debugger_SymbolMap.h"
 #include "../HW/WII_IPC.h"
+#include "../HW/WriteWatch.h"
 #include "WII_IPC_HLE.h"
 #include "WII_IPC_HLE_Device_hid.h"
 #include "errno.h"
@@ -230,6 +231,10 @@ bool CWII_IPC_HLE_Device_hid::IOCtl(u32 _CommandAddress)
 			break;
 		}
 
+		// The kernel fills the buffer of an IN transfer itself.
+		if (Parameter == IOCTL_HID_INTERRUPT_IN)
+			WriteWatch::PrepareHostWrite(Memory::GetPointer(data), length);
+
 		struct libusb_transfer *transfer = libusb_alloc_transfer(0);
 		transfer->flags |= LIBUSB_TRANSFER_FREE_TRANSFER;
 		libusb_fill_interrupt_transfer(transfer, dev_handle, endpoint, Memory::GetPointer(data), length,
@@ -8,6 +8,7 @@
 // No Wii socket support while using NetPlay or TAS
 #include "NetPlayProto.h"
 #include "Movie.h"
+#include "HW/WriteWatch.h"
 
 using WII_IPC_HLE_Interface::ECommandType;
 using WII_IPC_HLE_Interface::COMMAND_IOCTL;
@@ -374,6 +375,7 @@ void WiiSocket::update(bool read, bool write, bool except)
 					}
 					case IOCTLV_NET_SSL_READ:
 					{
+						WriteWatch::PrepareHostWrite(Memory::GetPointer(BufferIn2), BufferInSize2);
 						int ret = ssl_read(&CWII_IPC_HLE_Device_net_ssl::_SSL[sslID].ctx, Memory::GetPointer(BufferIn2), BufferInSize2);
 #ifdef DEBUG_SSL
 						if (ret > 0)
@@ -485,6 +487,7 @@ void WiiSocket::update(bool read, bool write, bool except)
 					}
 #endif
 					socklen_t addrlen = sizeof(sockaddr_in);
+					WriteWatch::PrepareHostWrite(data, data_len);
 					int ret = recvfrom(fd, data, data_len, flags,
 									BufferOutSize2 ? (struct sockaddr*) &local_name : NULL,
 									BufferOutSize2 ? &addrlen : 0);
@@ -0,0 +1,297 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "CachedInterpreter.h"
+#include "PPCTables.h"
+#include "../ConfigManager.h"
+#include "../CoreTiming.h"
+#include "../HLE/HLE.h"
+#include "../HW/Memmap.h"
+
+// The handler RunTable* would end up calling, so that it's looked up once.
+static Interpreter::_interpreterInstruction GetHandler(UGeckoInstruction inst)
+{
+	switch (inst.OPCD)
+	{
+	case 4:  return Interpreter::m_opTable4[inst.SUBOP10];
+	case 19: return Interpreter::m_opTable19[inst.SUBOP10];
+	case 31: return Interpreter::m_opTable31[inst.SUBOP10];
+	case 59: return Interpreter::m_opTable59[inst.SUBOP5];
+	case 63: return Interpreter::m_opTable63[inst.SUBOP10];
+	default: return Interpreter::m_opTable[inst.OPCD];
+	}
+}
+
+void CachedInterpreter::Init()
+{
+	ClearCache();
+}
+
+void CachedInterpreter::Shutdown()
+{
+	ClearCache();
+}
+
+void CachedInterpreter::ClearCache()
+{
+	// The code itself is only dropped by CompileBlock, this can be called from
+	// inside a block (HID0 writes reset the icache).
+	m_start_map.clear();
+	m_block_map.clear();
+	m_blocks.clear();
+}
+
+void CachedInterpreter::InvalidateICache(u32 address, u32 length)
+{
+	if (!length)
+		return;
+
+	u32 pAddr = address & 0x1FFFFFFF;
+	u32 pEnd = pAddr + length - 1;
+
+	// Collect first, destroying a block removes it from every page it covers.
+	std::vector<int> victims;
+	for (u32 page = pAddr >> BLOCK_MAP_PAGE_SHIFT; page <= pEnd >> BLOCK_MAP_PAGE_SHIFT; page++)
+	{
+		auto it = m_block_map.find(page);
+		if (it == m_block_map.end())
+			continue;
+		for (int block_num : it->second)
+		{
+			const Block &b = m_blocks[block_num];
+			u32 start = b.address & 0x1FFFFFFF;
+			u32 end = start + 4 * b.num_instructions - 1;
+			if (start <= pEnd && end >= pAddr)
+				victims.push_back(block_num);
+		}
+	}
+
+	for (int block_num : victims)
+		DestroyBlock(block_num);
+}
+
+void CachedInterpreter::DestroyBlock(int block_num)
+{
+	Block &b = m_blocks[block_num];
+	if (!b.num_instructions)
+		return;
+
+	auto it = m_start_map.find(b.address);
+	if (it != m_start_map.end() && it->second == block_num)
+		m_start_map.erase(it);
+
+	u32 start = b.address & 0x1FFFFFFF;
+	u32 end = start + 4 * b.num_instructions - 1;
+	for (u32 page = start >> BLOCK_MAP_PAGE_SHIFT; page <= end >> BLOCK_MAP_PAGE_SHIFT; page++)
+	{
+		auto bucket = m_block_map.find(page);
+		if (bucket == m_block_map.end())
+			continue;
+		std::vector<int> &blocks = bucket->second;
+		for (size_t i = 0; i < blocks.size(); i++)
+		{
+			if (blocks[i] == block_num)
+			{
+				blocks[i] = blocks.back();
+				blocks.pop_back();
+				break;
+			}
+		}
+		if (blocks.empty())
+			m_block_map.erase(bucket);
+	}
+
+	// Its code stays where it is until the next clear.
+	b.num_instructions = 0;
+}
+
+// Returns -1 if not even the first instruction could be fetched.
+int CachedInterpreter::CompileBlock(u32 address)
+{
+	if (m_code.size() >= MAX_CODE_SIZE)
+		ClearCache();
+	// Nothing can be running from the code anymore.
+	if (m_blocks.empty())
+		m_code.clear();
+
+	const bool translate = Core::g_CoreStartupParameter.bMMU && !Core::g_CoreStartupParameter.bTLBHack;
+
+	Block b;
+	b.address = address;
+	b.first = (u32)m_code.size();
+	b.num_entries = 0;
+	b.num_instructions = 0;
+
+	u32 cycles = 0;
+	for (u32 i = 0; i < MAX_BLOCK_INSTRUCTIONS; i++, address += 4)
+	{
+		// Past the first page the translation could fail, and Read_Opcode
+		// would raise the ISI right away rather than when we get there.
+		if (i && translate && !(address & 0xFFF))
+			break;
+
+		Instruction op;
+		op.address = address;
+		op.flags = 0;
+
+		u32 function = HLE::GetFunctionIndex(address);
+		if (function != 0)
+		{
+			int type = HLE::GetFunctionTypeByIndex(function);
+			if ((type == HLE::HLE_HOOK_START || type == HLE::HLE_HOOK_REPLACE) &&
+			    HLE::IsEnabled(HLE::GetFunctionFlagsByIndex(function)))
+			{
+				Instruction hle = op;
+				hle.func = NULL;
+				hle.inst.hex = function;
+				hle.flags = INSTRUCTION_HLE;
+				hle.cycles = ++cycles;
+				m_code.push_back(hle);
+
+				if (type == HLE::HLE_HOOK_REPLACE)
+				{
+					m_code.back().flags |= INSTRUCTION_HLE_REPLACE;
+					b.num_entries = (u32)m_code.size() - b.first;
+					b.num_instructions = i + 1;
+					break;
+				}
+			}
+		}
+
+		// The interpreter takes a 0 for a failed fetch; leave that to it.
+		u32 hex = Memory::Read_Opcode(address);
+		if (hex == 0)
+		{
+			// Along with the HLE entry for it, if any.
+			m_code.resize(b.first + b.num_entries);
+			break;
+		}
+
+		op.inst.hex = hex;
+		op.func = GetHandler(op.inst);
+		if (PPCTables::UsesFPU(op.inst))
+			op.flags |= INSTRUCTION_USES_FPU;
+
+		GekkoOPInfo *opinfo = GetOpInfo(op.inst);
+		cycles += opinfo->numCyclesMinusOne + 1;
+		op.cycles = cycles;
+		m_code.push_back(op);
+		b.num_entries = (u32)m_code.size() - b.first;
+		b.num_instructions = i + 1;
+
+		if (opinfo->flags & FL_ENDBLOCK)
+			break;
+	}
+
+	if (!b.num_entries)
+		return -1;
+
+	int block_num = (int)m_blocks.size();
+	m_blocks.push_back(b);
+
+	m_start_map[b.address] = block_num;
+	u32 start = b.address & 0x1FFFFFFF;
+	u32 end = start + 4 * b.num_instructions - 1;
+	for (u32 page = start >> BLOCK_MAP_PAGE_SHIFT; page <= end >> BLOCK_MAP_PAGE_SHIFT; page++)
+		m_block_map[page].push_back(block_num);
+
+	return block_num;
+}
+
+// Returns the cycles to charge to the downcount.
+int CachedInterpreter::ExecuteBlock(const Block &block)
+{
+	const Instruction *op = &m_code[block.first];
+	const Instruction *end = op + block.num_entries;
+
+	for (; op != end; ++op)
+	{
+		PC = op->address;
+		NPC = PC + 4;
+
+		if (op->flags)
+		{
+			if (op->flags & INSTRUCTION_HLE)
+			{
+				HLE::Execute(PC, op->inst.hex);
+				if (op->flags & INSTRUCTION_HLE_REPLACE)
+					break;
+				continue;
+			}
+
+			// check if we have to generate a FPU unavailable exception
+			if (!((UReg_MSR&)MSR).FP)
+			{
+				Common::AtomicOr(PowerPC::ppcState.Exceptions, EXCEPTION_FPU_UNAVAILABLE);
+				PowerPC::CheckExceptions();
+				break;
+			}
+		}
+
+		op->func(op->inst);
+
+		if (PowerPC::ppcState.Exceptions & EXCEPTION_DSI)
+		{
+			PowerPC::CheckExceptions();
+			break;
+		}
+		if (Interpreter::m_EndBlock)
+			break;
+	}
+
+	PC = NPC;
+	return op == end ? end[-1].cycles : op->cycles;
+}
+
+void CachedInterpreter::Run()
+{
+	while (!PowerPC::GetState())
+	{
+		// Breakpoints and the like are only checked by the plain interpreter.
+		if (SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+		{
+			Interpreter::getInstance()->Run();
+			return;
+		}
+
+		while (CoreTiming::downcount > 0)
+		{
+			Interpreter::m_EndBlock = false;
+
+			auto it = m_start_map.find(PC);
+			int block_num = it != m_start_map.end() ? it->second : CompileBlock(PC);
+			if (block_num < 0)
+			{
+				// Memory exception on instruction fetch
+				NPC = PC + 4;
+				PowerPC::CheckExceptions();
+				PC = NPC;
+				CoreTiming::downcount -= 1;
+				continue;
+			}
+
+			// Copied, the block can be destroyed by what it runs.
+			Block block = m_blocks[block_num];
+			CoreTiming::downcount -= ExecuteBlock(block);
+		}
+
+		CoreTiming::Advance();
+
+		if (PowerPC::ppcState.Exceptions)
+		{
+			PowerPC::CheckExceptions();
+			PC = NPC;
+		}
+	}
+}
+
+void CachedInterpreter::SingleStep()
+{
+	Interpreter::getInstance()->SingleStep();
+}
+
+const char *CachedInterpreter::GetName()
+{
+	return "Cached Interpreter";
+}
@@ -0,0 +1,75 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "CPUCoreBase.h"
+#include "Gekko.h"
+#include "Interpreter/Interpreter.h"
+
+// Runs the interpreter's instruction handlers off blocks that are fetched and
+// decoded once, instead of going through the icache, the opcode tables and the
+// HLE lookup for every instruction. Blocks are keyed by start address and
+// dropped by icbi the same way the JIT's are, and the downcount is charged
+// once per block.
+class CachedInterpreter : public CPUCoreBase
+{
+public:
+	void Init() override;
+	void Shutdown() override;
+	void ClearCache() override;
+	void Run() override;
+	void SingleStep() override;
+	const char *GetName() override;
+
+	void InvalidateICache(u32 address, u32 length);
+
+private:
+	enum
+	{
+		MAX_BLOCK_INSTRUCTIONS = 128,
+		// The whole cache is thrown away when the decoded code grows past this.
+		MAX_CODE_SIZE = 1 << 20,
+		BLOCK_MAP_PAGE_SHIFT = 12,
+	};
+
+	enum
+	{
+		INSTRUCTION_USES_FPU = 1 << 0,
+		INSTRUCTION_HLE = 1 << 1, // inst holds the HLE function index, func is unused
+		INSTRUCTION_HLE_REPLACE = 1 << 2,
+	};
+
+	struct Instruction
+	{
+		Interpreter::_interpreterInstruction func;
+		UGeckoInstruction inst;
+		u32 address;
+		u32 flags;
+		// Cycles up to and including this instruction, for blocks left early.
+		u32 cycles;
+	};
+
+	struct Block
+	{
+		u32 address;
+		u32 first; // into m_code
+		u32 num_entries;
+		u32 num_instructions; // covered in memory, for invalidation
+	};
+
+	// start address -> block
+	std::unordered_map<u32, int> m_start_map;
+	// physical page -> blocks that overlap the page
+	std::unordered_map<u32, std::vector<int>> m_block_map;
+	std::vector<Block> m_blocks;
+	std::vector<Instruction> m_code;
+
+	int CompileBlock(u32 address);
+	int ExecuteBlock(const Block &block);
+	void DestroyBlock(int block_num);
+};
@@ -97,7 +97,15 @@ void Interpreter::andis_rc(UGeckoInstruction _inst)
 
 void Interpreter::cmpi(UGeckoInstruction _inst)
 {
-	Helper_UpdateCRx(_inst.CRFD, m_GPR[_inst.RA] - _inst.SIMM_16);
+	// Not Helper_UpdateCRx on the difference, that overflows.
+	s32 a = (s32)m_GPR[_inst.RA];
+	s32 b = _inst.SIMM_16;
+	int f;
+	if (a < b)      f = 0x8;
+	else if (a > b) f = 0x4;
+	else            f = 0x2; //equals
+	if (GetXER_SO()) f |= 0x1;
+	SetCRField(_inst.CRFD, f);
 }
 
 void Interpreter::cmpli(UGeckoInstruction _inst)
@@ -332,8 +340,10 @@ void Interpreter::srawx(UGeckoInstruction _inst)
 		}
 		else
 		{
-			m_GPR[_inst.RA] = (u32)((s32)m_GPR[_inst.RS] >> amount);
-			if (m_GPR[_inst.RS] & 0x80000000)
+			s32 rrs = m_GPR[_inst.RS];
+			m_GPR[_inst.RA] = (u32)(rrs >> amount);
+			// Only if ones were shifted out, like srawi
+			if ((rrs < 0) && ((u32)rrs & ((1u << amount) - 1)))
 				SetCarry(1);
 			else
 				SetCarry(0);
@@ -437,7 +447,8 @@ void Interpreter::addmex(UGeckoInstruction _inst)
 	int carry = GetCarry();
 	int a = m_GPR[_inst.RA];
 	m_GPR[_inst.RD] = a + carry - 1;
-	SetCarry(Helper_Carry(a, carry - 1));
+	// a + carry + 0xffffffff carries unless both are 0
+	SetCarry(a != 0 || carry != 0);
 
 	if (_inst.OE) PanicAlert("OE: addmex");
 	if (_inst.Rc) Helper_UpdateCR0(m_GPR[_inst.RD]);
@@ -569,7 +580,8 @@ void Interpreter::subfmex(UGeckoInstruction _inst)
 	u32 a = m_GPR[_inst.RA];
 	int carry = GetCarry();
 	m_GPR[_inst.RD] = (~a) + carry - 1;
-	SetCarry(Helper_Carry(~a, carry - 1));
+	// ~a + carry + 0xffffffff carries unless both are 0
+	SetCarry(~a != 0 || carry != 0);
 
 	if (_inst.OE) PanicAlert("OE: subfmex");
 	if (_inst.Rc) Helper_UpdateCR0(m_GPR[_inst.RD]);
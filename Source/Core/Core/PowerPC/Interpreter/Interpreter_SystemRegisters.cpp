@@ -175,6 +175,9 @@ void Interpreter::mtmsr(UGeckoInstruction _inst)
 
 static void SetSR(int index, u32 value) {
 	DEBUG_LOG(POWERPC, "%08x: MMU: Segment register %i set to %08x", PowerPC::ppcState.pc, index, value);
+	// The fast TLB has translations made with the old VSID.
+	if (PowerPC::ppcState.sr[index] != value)
+		Memory::ClearFastTLBSegment(index);
 	PowerPC::ppcState.sr[index] = value;
 }
 
@@ -370,6 +373,11 @@ void Interpreter::mtspr(UGeckoInstruction _inst)
 		Memory::SDRUpdated();
 		break;
 	}
+
+	// BATs, including the Wii's secondary ones up to 575. The fast TLB caches
+	// block translations too.
+	if (iIndex >= SPR_IBAT0U && iIndex <= 575)
+		Memory::ClearFastTLB();
 }
 
 void Interpreter::crand(UGeckoInstruction _inst)
@@ -2,7 +2,9 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <map>
+#include <set>
 
 // for the PROFILER stuff
 #ifdef _WIN32
@@ -37,6 +39,16 @@ using namespace PowerPC;
 
 // Various notes below
 
+// Tiered compilation
+// When enabled, blocks are first compiled as cheap baseline blocks: no branch
+// following, and a countdown at the normal entry. When the countdown runs out
+// the block destroys itself and goes back to the dispatcher, which recompiles
+// it with block merging forced on. Links into the old block are undone by
+// DestroyBlock, which keeps the callers registered, and redone by FinalizeBlock
+// for the new one, so the switch is seen all at once by everything that jumps
+// to the block. Clearing the cache or invalidating the code makes a block start
+// over as a baseline block.
+
 // Register allocation
 //   RAX - Generic quicktemp register
 //   RBX - point to base of memory map
@@ -140,6 +152,25 @@ ps_adds1
 
 static int CODE_SIZE = 1024*1024*32;
 
+// Number of runs before a baseline block is recompiled with the full analysis.
+static const int TIER_UP_THRESHOLD = 1000;
+
+// Start addresses of blocks that crossed TIER_UP_THRESHOLD.
+static std::set<u32> hot_blocks;
+
+// Block eviction: how many regions the code space is split into, and how
+// often a block has to have run since the last eviction to be compiled again
+// when its region is thrown out.
+static const int NUM_CODE_REGIONS = 4;
+static const u32 EVICTION_HOT_RUN_COUNT = 100;
+
+// Trace formation follows a branch that went the same way at least 7 times in
+// 8, over at least this many runs.
+static const u32 TRACE_MIN_BRANCH_RUNS = 100;
+// Keyed by the address of the branch. Baseline blocks count straight into the
+// nodes, which stay put, so this is only cleared along with the whole cache.
+static std::map<u32, BranchProfile> branch_profiles;
+
 namespace CPUCompare
 {
 	extern u32 m_BlockStart;
@@ -171,32 +202,148 @@ void Jit64::Init()
 	jo.optimizeGatherPipe = true;
 	jo.fastInterrupts = false;
 	jo.accurateSinglePrecision = true;
+	jo.tieredCompilation = Core::g_CoreStartupParameter.bJITTiered &&
+		!Core::g_CoreStartupParameter.bEnableDebugging && !Profiler::g_ProfileBlocks;
+	jo.backgroundCompile = Core::g_CoreStartupParameter.bJITBackgroundCompile &&
+		!Core::g_CoreStartupParameter.bEnableDebugging && !Core::g_CoreStartupParameter.bMMU &&
+		!Core::g_CoreStartupParameter.bJITNoBlockCache;
+	// Dead registers are left stale in ppcState, which the debugger would show.
+	jo.registerLiveness = Core::g_CoreStartupParameter.bJITRegisterLiveness &&
+		!Core::g_CoreStartupParameter.bEnableDebugging && !Core::g_CoreStartupParameter.bMMU;
+	// Compiling the hot blocks again must not raise exceptions.
+	jo.blockEviction = Core::g_CoreStartupParameter.bJITBlockEviction &&
+		!Core::g_CoreStartupParameter.bMMU && !Core::g_CoreStartupParameter.bJITNoBlockCache;
+	// The baseline blocks gather the branch profiles.
+	jo.traceFormation = Core::g_CoreStartupParameter.bJITTraceFormation && jo.tieredCompilation;
+	// Known addresses skip the address translation.
+	jo.constantAddresses = Core::g_CoreStartupParameter.bJITConstantAddresses && !Core::g_CoreStartupParameter.bMMU;
 	js.memcheck = Core::g_CoreStartupParameter.bMMU;
+	hot_blocks.clear();
+	branch_profiles.clear();
 
 	gpr.SetEmitter(this);
 	fpr.SetEmitter(this);
 
 	trampolines.Init();
 	AllocCodeSpace(CODE_SIZE);
+	ResetCodeRegions();
 
 	blocks.Init();
 	asm_routines.Init();
+
+	if (Core::g_CoreStartupParameter.bJITDiskCache && !Core::g_CoreStartupParameter.bMMU &&
+		!Core::g_CoreStartupParameter.bEnableDebugging)
+	{
+		blocks.GetDiskCache().Init(Core::g_CoreStartupParameter.GetUniqueID());
+	}
+
+	if (jo.backgroundCompile)
+		StartCompileThread();
 }
 
 void Jit64::ClearCache()
 {
+	std::lock_guard<std::recursive_mutex> lk(compile_lock);
+	CancelBackgroundCompiles();
 	blocks.Clear();
+	PPCAnalyst::ClearLiveness();
 	trampolines.ClearCodeSpace();
 	ClearCodeSpace();
+	ResetCodeRegions();
+	// The code may be different next time around, it has to prove itself again.
+	hot_blocks.clear();
+	branch_profiles.clear();
+}
+
+void Jit64::InvalidateICache(u32 address, u32 length)
+{
+	blocks.InvalidateICache(address, length);
+
+	// New code at these addresses starts out in the baseline tier again.
+	auto it = hot_blocks.lower_bound(address);
+	while (it != hot_blocks.end() && *it - address < length)
+		hot_blocks.erase(it++);
+}
+
+void Jit64::ResetCodeRegions()
+{
+	code_region = 0;
+	code_region_end = region + (jo.blockEviction ? region_size / NUM_CODE_REGIONS : region_size);
+}
+
+bool Jit64::IsCodeSpaceLow() const
+{
+	return code_region_end - GetCodePtr() < 0x10000;
+}
+
+// Makes room by throwing out the oldest region of the code space instead of
+// all of it. The blocks in there that ran since the last eviction are compiled
+// again straight away, packed together at the start of the region.
+void Jit64::EvictCode()
+{
+	std::lock_guard<std::recursive_mutex> lk(compile_lock);
+	CancelBackgroundCompiles();
+
+	// Trampolines aren't tracked per block, they only go away with everything.
+	if (trampolines.GetSpaceLeft() < 0x10000)
+	{
+		ClearCache();
+		return;
+	}
+
+	const size_t size = region_size / NUM_CODE_REGIONS;
+	code_region = (code_region + 1) % NUM_CODE_REGIONS;
+	u8 *start = region + code_region * size;
+	code_region_end = start + size;
+
+	std::vector<u32> hot;
+	blocks.EvictCode(start, code_region_end, EVICTION_HOT_RUN_COUNT, hot);
+	JitRegister::Unregister(start, size);
+	memset(start, 0xCC, size);
+	SetCodePtr(start);
+
+	// Out of block slots with nothing to free in this region.
+	if (blocks.IsFull())
+	{
+		ClearCache();
+		return;
+	}
+
+	int num_kept = 0;
+	for (u32 address : hot)
+	{
+		if (IsCodeSpaceLow() || blocks.IsFull())
+			break;
+
+		if (blocks.GetBlockNumberFromStartAddress(address) >= 0 || !Memory::IsRAMAddress(address))
+			continue;
+
+		BlockAnalysis analysis;
+		AnalyzeBlock(address, &code_buffer, analysis);
+		if (analysis.memoryException || analysis.size == 0)
+			continue;
+
+		int block_num = blocks.AllocateBlock(address);
+		JitBlock *b = blocks.GetBlock(block_num);
+		blocks.FinalizeBlock(block_num, jo.enableBlocklink, EmitBlock(analysis, code_buffer.codebuffer, b));
+		num_kept++;
+	}
+
+	INFO_LOG(DYNA_REC, "Evicted JIT code region %i, kept %i hot blocks (%i evictions, %i blocks evicted in all)",
+		code_region, num_kept, blocks.GetNumEvictions(), blocks.GetNumEvictedBlocks());
 }
 
 void Jit64::Shutdown()
 {
+	StopCompileThread();
+	blocks.GetDiskCache().Shutdown();
 	FreeCodeSpace();
 
 	blocks.Shutdown();
 	trampolines.Shutdown();
 	asm_routines.Shutdown();
+	hot_blocks.clear();
+	PPCAnalyst::ClearLiveness();
 }
 
 // This is only called by Default() in this file. It will execute an instruction with the interpreter functions.
@@ -264,6 +411,42 @@ static void ImHere()
 	been_here[PC] = 1;
 }
 
+// Called from a baseline block whose countdown ran out. The block is torn down
+// and the caller jumps back to the dispatcher, which compiles the hot version.
+static void TierUpBlock(u32 address)
+{
+	hot_blocks.insert(address);
+
+	JitBaseBlockCache *block_cache = jit->GetBlockCache();
+	int block_num = block_cache->GetBlockNumberFromStartAddress(address);
+	if (block_num >= 0)
+		block_cache->DestroyBlock(block_num, true);
+}
+
+static PPCAnalyst::BranchHint GetBranchHint(u32 address)
+{
+	auto it = branch_profiles.find(address);
+	if (it == branch_profiles.end())
+		return PPCAnalyst::BRANCH_UNKNOWN;
+
+	const BranchProfile &profile = it->second;
+	const u64 runs = (u64)profile.taken + profile.notTaken;
+	if (runs < TRACE_MIN_BRANCH_RUNS)
+		return PPCAnalyst::BRANCH_UNKNOWN;
+	if (profile.taken * 8ULL >= runs * 7)
+		return PPCAnalyst::BRANCH_MOSTLY_TAKEN;
+	if (profile.notTaken * 8ULL >= runs * 7)
+		return PPCAnalyst::BRANCH_MOSTLY_NOT_TAKEN;
+	return PPCAnalyst::BRANCH_UNKNOWN;
+}
+
+PPCAnalyst::MergeMode Jit64::GetMergeMode(u32 em_address) const
+{
+	if (!jo.tieredCompilation)
+		return PPCAnalyst::MERGE_IF_ENABLED;
+	return hot_blocks.count(em_address) ? PPCAnalyst::MERGE_ALWAYS : PPCAnalyst::MERGE_NEVER;
+}
+
 void Jit64::Cleanup()
 {
 	if (jo.optimizeGatherPipe && js.fifoBytesThisBlock > 0)
@@ -271,13 +454,32 @@ void Jit64::Cleanup()
 		ABI_CallFunction((void *)&GPFifo::CheckGatherPipe);
 	}
 
-	// SPEED HACK: MMCR0/MMCR1 should be checked at run-time, not at compile time.
-	if (MMCR0.Hex || MMCR1.Hex)
+	if (block_analysis->performanceMonitor)
 		ABI_CallFunctionCCC((void *)&PowerPC::UpdatePerformanceMonitor, js.downcountAmount, jit->js.numLoadStoreInst, jit->js.numFloatingPointInst);
+
+	// Every exit comes through here, so each run of the block is counted once.
+	if (Profiler::g_ProfileBlocks)
+	{
+		// CAUTION!!! push on stack regs you use, do your stuff, then pop
+		PROFILER_VPUSH;
+		// get end tic
+		PROFILER_QUERY_PERFORMANCE_COUNTER(&js.curBlock->ticStop);
+		// tic counter += (end tic - start tic)
+		PROFILER_ADD_DIFF_LARGE_INTEGER(&js.curBlock->ticCounter, &js.curBlock->ticStop, &js.curBlock->ticStart);
+		PROFILER_VPOP;
+	}
 }
 
 void Jit64::WriteExit(u32 destination)
 {
+	// Going round a busy-wait loop again, nothing can change before the next event.
+	if (destination == js.blockStart && js.st.isIdleLoop &&
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bSkipIdle)
+	{
+		WriteIdleExit(destination);
+		return;
+	}
+
 	Cleanup();
 
 	SUB(32, M(&CoreTiming::downcount), js.downcountAmount > 127 ? Imm32(js.downcountAmount) : Imm8(js.downcountAmount));
@@ -289,23 +491,43 @@ void Jit64::WriteExit(u32 destination)
 	linkData.exitPtrs = GetWritableCodePtr();
 	linkData.linkStatus = false;
 
-	// Link opportunity!
+	MOV(32, M(&PC), Imm32(destination));
+	JMP(asm_routines.dispatcher, true);
+
+	// Link opportunity! The compile thread leaves this to FinalizeBlock, as
+	// the block cache belongs to the CPU thread.
 	int block; 
-	if (jo.enableBlocklink && (block = blocks.GetBlockNumberFromStartAddress(destination)) >= 0)
+	if (jo.enableBlocklink && !in_compile_thread && (block = blocks.GetBlockNumberFromStartAddress(destination)) >= 0)
 	{
-		// It exists! Joy of joy!
+		// It exists! Joy of joy! Padded to the size of the unlinked exit,
+		// which EvictCode writes back over it.
+		u8 *end = GetWritableCodePtr();
+		SetCodePtr(linkData.exitPtrs);
 		JMP(blocks.GetBlock(block)->checkedEntry, true);
+		NOP((int)(end - GetWritableCodePtr()));
 		linkData.linkStatus = true;
 	}
-	else
-	{
-		MOV(32, M(&PC), Imm32(destination));
-		JMP(asm_routines.dispatcher, true);
-	}
 
 	b->linkData.push_back(linkData);
 }
 
+void Jit64::WriteCounterIncrement(u32 *counter)
+{
+#ifdef _M_IX86
+	ADD(32, M(counter), Imm8(1));
+#else
+	MOV(64, R(RAX), ImmPtr(counter));
+	ADD(32, MatR(RAX), Imm8(1));
+#endif
+}
+
+void Jit64::WriteIdleExit(u32 destination)
+{
+	ABI_CallFunction((void *)&CoreTiming::Idle);
+	MOV(32, M(&PC), Imm32(destination));
+	WriteExceptionExit();
+}
+
 void Jit64::WriteExitDestInEAX()
 {
 	MOV(32, M(&PC), R(EAX));
@@ -387,25 +609,97 @@ void Jit64::Trace()
 
 void STACKALIGN Jit64::Jit(u32 em_address)
 {
-	if (GetSpaceLeft() < 0x10000 || blocks.IsFull() || Core::g_CoreStartupParameter.bJITNoBlockCache)
+	if (jo.backgroundCompile && CompileInBackground(em_address))
+		return;
+
+	std::lock_guard<std::recursive_mutex> lk(compile_lock);
+
+	if (IsCodeSpaceLow() || blocks.IsFull() || Core::g_CoreStartupParameter.bJITNoBlockCache)
 	{
-		ClearCache();
+		if (jo.blockEviction)
+		{
+			EvictCode();
+			// It may have been one of the hot blocks compiled again.
+			if (blocks.GetBlockNumberFromStartAddress(em_address) >= 0)
+				return;
+		}
+		else
+		{
+			ClearCache();
+		}
+	}
+
+	if (blocks.GetDiskCache().HasBlocksToWarm())
+	{
+		WarmUpBlocks();
+		if (blocks.GetBlockNumberFromStartAddress(em_address) >= 0)
+			return;
 	}
 
 	int block_num = blocks.AllocateBlock(em_address);
 	JitBlock *b = blocks.GetBlock(block_num);
 	blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(em_address, &code_buffer, b));
+	blocks.GetDiskCache().RecordBlock(JitDiskCache::ComputeKey(em_address, code_buffer.codebuffer, b->originalSize));
+}
+
+// Compiles the blocks a previous session recorded for this game, as long as
+// the code they were built from is still what's in memory.
+void Jit64::WarmUpBlocks()
+{
+	std::vector<JitDiskCacheKey> keys;
+	blocks.GetDiskCache().TakeBlocksToWarm(keys);
+
+	int num_warmed = 0;
+	for (const JitDiskCacheKey& key : keys)
+	{
+		if (IsCodeSpaceLow() || blocks.IsFull())
+			break;
+
+		if (blocks.GetBlockNumberFromStartAddress(key.address) >= 0)
+		{
+			blocks.GetDiskCache().MarkWarmed(key.address);
+			continue;
+		}
+
+		if (!Memory::IsRAMAddress(key.address))
+			continue;
+
+		// The game hasn't run this code yet, so don't let it touch the instruction cache.
+		BlockAnalysis analysis;
+		AnalyzeBlock(key.address, &code_buffer, analysis, true);
+		if (JitDiskCache::ComputeKey(key.address, code_buffer.codebuffer, analysis.size).hash != key.hash)
+			continue;
+
+		int block_num = blocks.AllocateBlock(key.address);
+		JitBlock *b = blocks.GetBlock(block_num);
+		blocks.FinalizeBlock(block_num, jo.enableBlocklink, EmitBlock(analysis, code_buffer.codebuffer, b));
+		blocks.GetDiskCache().MarkWarmed(key.address);
+		num_warmed++;
+	}
+
+	if (num_warmed)
+		INFO_LOG(DYNA_REC, "Warmed up %i JIT blocks from the disk cache", num_warmed);
 }
 
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b)
+{
+	BlockAnalysis analysis;
+	AnalyzeBlock(em_address, code_buf, analysis);
+	return EmitBlock(analysis, code_buf->codebuffer, b);
+}
+
+// Analyze the block, collect all instructions it is made of (including inlining,
+// if that is enabled), reorder instructions for optimal performance, and join joinable instructions.
+// Runs on the CPU thread; EmitBlock only works from what is gathered here.
+void Jit64::AnalyzeBlock(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, BlockAnalysis &analysis, bool speculative)
 {
 	int blockSize = code_buf->GetSize();
 
 	// Memory exception on instruction fetch
-	bool memory_exception = false;
+	analysis.memoryException = false;
 
 	// A broken block is a block that does not end in a branch
-	bool broken_block = false;
+	analysis.brokenBlock = false;
 
 	if (Core::g_CoreStartupParameter.bEnableDebugging)
 	{
@@ -421,7 +715,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	if (em_address == 0)
 	{
 		// Memory exception occurred during instruction fetch
-		memory_exception = true;
+		analysis.memoryException = true;
 	}
 
 	if (Core::g_CoreStartupParameter.bMMU && (em_address & JIT_ICACHE_VMEM_BIT))
@@ -429,11 +723,230 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		if (!Memory::TranslateAddress(em_address, Memory::FLAG_OPCODE))
 		{
 			// Memory exception occurred during instruction fetch
-			memory_exception = true;
+			analysis.memoryException = true;
+		}
+	}
+
+	analysis.address = em_address;
+	analysis.nextPC = em_address;
+	analysis.size = 0;
+	analysis.mergeMode = GetMergeMode(em_address);
+
+	u32 merged_addresses[32];
+	const int capacity_of_merged_addresses = sizeof(merged_addresses) / sizeof(merged_addresses[0]);
+	int size_of_merged_addresses = 0;
+	if (!analysis.memoryException)
+	{
+		// If there is a memory exception inside a block (broken_block==true), compile up to that instruction.
+		analysis.nextPC = PPCAnalyst::Flatten(em_address, &analysis.size, &analysis.st, &analysis.gpa, &analysis.fpa, analysis.brokenBlock, code_buf, blockSize,
+		                                      merged_addresses, capacity_of_merged_addresses, size_of_merged_addresses, analysis.mergeMode,
+		                                      jo.traceFormation ? &GetBranchHint : NULL, speculative);
+	}
+
+	// Baseline blocks count which way their final conditional branch goes.
+	analysis.branchProfile = NULL;
+	if (jo.traceFormation && analysis.mergeMode == PPCAnalyst::MERGE_NEVER && analysis.size > 0 && !analysis.brokenBlock)
+	{
+		const PPCAnalyst::CodeOp &last = code_buf->codebuffer[analysis.size - 1];
+		if (last.inst.OPCD == 16 && !last.inst.LK &&
+			(last.inst.BO & (BO_DONT_CHECK_CONDITION | BO_DONT_DECREMENT_FLAG)) != (BO_DONT_CHECK_CONDITION | BO_DONT_DECREMENT_FLAG))
+		{
+			analysis.branchProfile = &branch_profiles[last.address];
+		}
+	}
+
+	analysis.speedhackCycles = 0;
+	if (!Core::g_CoreStartupParameter.bEnableDebugging)
+	{
+		for (int i = 0; i < size_of_merged_addresses; ++i)
+		{
+			const u32 address = merged_addresses[i];
+			analysis.speedhackCycles += PatchEngine::GetSpeedhackCycles(address);
+		}
+	}
+
+	analysis.fifoWriteAddresses.clear();
+	for (int i = 0; i < analysis.size; i++)
+	{
+		if (js.fifoWriteAddresses.find(code_buf->codebuffer[i].address) != js.fifoWriteAddresses.end())
+			analysis.fifoWriteAddresses.push_back(code_buf->codebuffer[i].address);
+	}
+
+	ComputeExitLiveness(code_buf->codebuffer, analysis);
+
+	analysis.constantGPRs.clear();
+	if (jo.constantAddresses)
+		FindConstantAddresses(code_buf->codebuffer, analysis);
+
+	// SPEED HACK: MMCR0/MMCR1 should be checked at run-time, not at compile time.
+	analysis.performanceMonitor = MMCR0.Hex || MMCR1.Hex;
+
+	analysis.idleLoadAddresses.clear();
+	analysis.dcbstAfterDcbt.clear();
+	for (int i = 0; i < analysis.size; i++)
+	{
+		const PPCAnalyst::CodeOp &op = code_buf->codebuffer[i];
+		// lwz rX, n(r13); cmpwi rX, 0; beq -8
+		if (op.inst.OPCD == 32 &&
+			(op.inst.hex & 0xFFFF0000) == 0x800D0000 &&
+			(Memory::ReadUnchecked_U32(op.address + 4) == 0x28000000 ||
+			(SConfig::GetInstance().m_LocalCoreStartupParameter.bWii && Memory::ReadUnchecked_U32(op.address + 4) == 0x2C000000)) &&
+			Memory::ReadUnchecked_U32(op.address + 8) == 0x4182fff8)
+		{
+			analysis.idleLoadAddresses[op.address] = PowerPC::ppcState.gpr[op.inst.RA] + (s32)(s16)op.inst.SIMM_16;
+		}
+		// dcbt = 0x7c00022c
+		if (op.inst.OPCD == 31 && op.inst.SUBOP10 == 54 &&
+			(Memory::ReadUnchecked_U32(op.address - 4) & 0x7c00022c) == 0x7c00022c)
+		{
+			analysis.dcbstAfterDcbt.insert(op.address);
 		}
 	}
+}
+
+// Registers that are dead at the target of the block's final exit don't need
+// to be written back to ppcState; whatever runs next overwrites them before
+// looking. Only direct exits that stay within the function the symbol database
+// puts the block in are considered: calls, returns and indirect branches keep
+// everything live. The function becomes part of the block for invalidation.
+void Jit64::ComputeExitLiveness(const PPCAnalyst::CodeOp *ops, BlockAnalysis &analysis)
+{
+	analysis.exitLiveGPRs = 0xFFFFFFFF;
+	analysis.dependencyAddress = 0;
+	analysis.dependencySize = 0;
+
+	if (!jo.registerLiveness || analysis.memoryException || analysis.size == 0)
+		return;
+
+	const PPCAnalyst::CodeOp &last = ops[analysis.size - 1];
+	const UGeckoInstruction inst = last.inst;
+	u32 targets[2];
+	int num_targets = 0;
+	if (analysis.brokenBlock)
+	{
+		targets[num_targets++] = analysis.nextPC;
+	}
+	else if (inst.OPCD == 18 && !inst.LK)
+	{
+		targets[num_targets++] = (inst.AA ? 0 : last.address) + SignExt26(inst.LI << 2);
+	}
+	else if (inst.OPCD == 16 && !inst.LK)
+	{
+		targets[num_targets++] = (inst.AA ? 0 : last.address) + SignExt16(inst.BD << 2);
+		targets[num_targets++] = last.address + 4;
+	}
+	else
+	{
+		return;
+	}
+
+	u32 live = 0;
+	u32 func_start = 0, func_size = 0;
+	for (int i = 0; i < num_targets; i++)
+	{
+		u32 start, size;
+		u32 target_live = PPCAnalyst::GetLiveGPRs(targets[i], &start, &size);
+		if (target_live == 0xFFFFFFFF || (i > 0 && start != func_start))
+			return;
+		live |= target_live;
+		func_start = start;
+		func_size = size;
+	}
+
+	// The exit has to stay within the function the block branches from.
+	if (last.address < func_start || last.address >= func_start + func_size)
+		return;
+
+	analysis.exitLiveGPRs = live;
+	analysis.dependencyAddress = func_start;
+	analysis.dependencySize = func_size;
+}
+
+// The register cache only knows a GPR's value until it's flushed, and the
+// first floating point instruction or a side exit flushes everything. This
+// follows li, lis, addi, addis, ori, oris and mr through the whole block, and
+// notes the address registers of loads and stores that are constant. EmitBlock
+// hands those back to the register cache as immediates, so that the accesses
+// go straight to RAM or to the hardware handler.
+void Jit64::FindConstantAddresses(const PPCAnalyst::CodeOp *ops, BlockAnalysis &analysis)
+{
+	u32 known = 0;
+	u32 values[32];
+
+	for (int i = 0; i < analysis.size; i++)
+	{
+		const PPCAnalyst::CodeOp &op = ops[i];
+		const UGeckoInstruction inst = op.inst;
+		const int flags = op.opinfo->flags;
+
+		// HLE functions and instructions that write any number of registers.
+		if (HLE::GetFunctionIndex(op.address) || (flags & FL_EVIL) ||
+			(inst.OPCD == 31 && inst.SUBOP10 == 310)) // eciwx
+		{
+			known = 0;
+		}
+
+		if (flags & FL_LOADSTORE)
+		{
+			if (((flags & FL_IN_A) || ((flags & FL_IN_A0) && inst.RA != 0)) && (known & (1 << inst.RA)))
+			{
+				ConstantGPR constant = {i, (int)inst.RA, values[inst.RA]};
+				analysis.constantGPRs.push_back(constant);
+			}
+			if ((flags & FL_IN_B) && inst.RB != inst.RA && (known & (1 << inst.RB)))
+			{
+				ConstantGPR constant = {i, (int)inst.RB, values[inst.RB]};
+				analysis.constantGPRs.push_back(constant);
+			}
+		}
+
+		int out = -1;
+		u32 value = 0;
+		switch (inst.OPCD)
+		{
+		case 14: // addi
+		case 15: // addis
+			if (inst.RA == 0 || (known & (1 << inst.RA)))
+			{
+				out = inst.RD;
+				value = (inst.RA ? values[inst.RA] : 0) + (inst.OPCD == 15 ? (u32)inst.SIMM_16 << 16 : (u32)(s32)inst.SIMM_16);
+			}
+			break;
+		case 24: // ori
+		case 25: // oris
+			if (known & (1 << inst.RS))
+			{
+				out = inst.RA;
+				value = values[inst.RS] | (inst.OPCD == 25 ? (u32)inst.UIMM << 16 : (u32)inst.UIMM);
+			}
+			break;
+		case 31:
+			if (inst.SUBOP10 == 444 && (known & (1 << inst.RS)) && (known & (1 << inst.RB))) // or
+			{
+				out = inst.RA;
+				value = values[inst.RS] | values[inst.RB];
+			}
+			break;
+		}
+		for (int j = 0; j < 2; j++)
+		{
+			if (op.regsOut[j] >= 0)
+				known &= ~(1 << op.regsOut[j]);
+		}
+		if (out >= 0)
+		{
+			known |= 1 << out;
+			values[out] = value;
+		}
+	}
+}
+
+const u8* Jit64::EmitBlock(const BlockAnalysis &analysis, PPCAnalyst::CodeOp *ops, JitBlock *b)
+{
+	const u32 em_address = analysis.address;
+	const u32 nextPC = analysis.nextPC;
+	const int size = analysis.size;
 
-	int size = 0;
 	js.firstFPInstructionFound = false;
 	js.isLastInstruction = false;
 	js.blockStart = em_address;
@@ -441,23 +954,15 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	js.curBlock = b;
 	js.block_flags = 0;
 	js.cancel = false;
+	js.st = analysis.st;
+	js.gpa = analysis.gpa;
+	js.fpa = analysis.fpa;
+	js.exitLiveGPRs = analysis.exitLiveGPRs;
+	branch_profile = analysis.branchProfile;
+	block_analysis = &analysis;
 	jit->js.numLoadStoreInst = 0;
 	jit->js.numFloatingPointInst = 0;
 
-	// Analyze the block, collect all instructions it is made of (including inlining,
-	// if that is enabled), reorder instructions for optimal performance, and join joinable instructions.
-	u32 nextPC = em_address;
-	u32 merged_addresses[32];
-	const int capacity_of_merged_addresses = sizeof(merged_addresses) / sizeof(merged_addresses[0]);
-	int size_of_merged_addresses = 0;
-	if (!memory_exception)
-	{
-		// If there is a memory exception inside a block (broken_block==true), compile up to that instruction.
-		nextPC = PPCAnalyst::Flatten(em_address, &size, &js.st, &js.gpa, &js.fpa, broken_block, code_buf, blockSize, merged_addresses, capacity_of_merged_addresses, size_of_merged_addresses);
-	}
-
-	PPCAnalyst::CodeOp *ops = code_buf->codebuffer;
-
 	const u8 *start = AlignCode4(); // TODO: Test if this or AlignCode16 make a difference from GetCodePtr
 	b->checkedEntry = start;
 	b->runCount = 0;
@@ -474,19 +979,37 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	if (ImHereDebug)
 		ABI_CallFunction((void *)&ImHere); //Used to get a trace of the last few blocks before a crash, sometimes VERY useful
 
+	// Baseline block: count runs, and go get recompiled once it's hot.
+	if (jo.tieredCompilation && analysis.mergeMode == PPCAnalyst::MERGE_NEVER)
+	{
+		b->tierUpCount = TIER_UP_THRESHOLD;
+#ifdef _M_IX86
+		SUB(32, M(&b->tierUpCount), Imm8(1));
+#else
+		MOV(64, R(RAX), ImmPtr(&b->tierUpCount));
+		SUB(32, MatR(RAX), Imm8(1));
+#endif
+		FixupBranch notHot = J_CC(CC_NZ);
+		ABI_CallFunctionC((void *)&TierUpBlock, js.blockStart);
+		MOV(32, M(&PC), Imm32(js.blockStart));
+		JMP(asm_routines.dispatcherNoCheck, true);
+		SetJumpTarget(notHot);
+	}
+
 	// Conditionally add profiling code.
 	if (Profiler::g_ProfileBlocks) {
-		ADD(32, M(&b->runCount), Imm8(1));
-#ifdef _WIN32
+		WriteCounterIncrement((u32 *)&b->runCount);
 		b->ticCounter = 0;
 		b->ticStart = 0;
 		b->ticStop = 0;
-#else
-//TODO
-#endif
 		// get start tic
 		PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStart);
 	}
+	else if (jo.blockEviction)
+	{
+		// Eviction keeps the blocks that ran lately.
+		WriteCounterIncrement((u32 *)&b->runCount);
+	}
 #if defined(_DEBUG) || defined(DEBUGFAST) || defined(NAN_CHECK)
 	// should help logged stack-traces become more accurate
 	MOV(32, M(&PC), Imm32(js.blockStart));
@@ -497,18 +1020,11 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	gpr.Start(js.gpa);
 	fpr.Start(js.fpa);
 
-	js.downcountAmount = 0;
-	if (!Core::g_CoreStartupParameter.bEnableDebugging)
-	{
-		for (int i = 0; i < size_of_merged_addresses; ++i)
-		{
-			const u32 address = merged_addresses[i];
-			js.downcountAmount += PatchEngine::GetSpeedhackCycles(address);
-		}
-	}
+	js.downcountAmount = analysis.speedhackCycles;
 
 	js.skipnext = false;
 	js.blockSize = size;
+	size_t next_constant = 0;
 	js.compilerPC = nextPC;
 	// Translate instructions
 	for (int i = 0; i < (int)size; i++)
@@ -524,15 +1040,6 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 			// WARNING - cmp->branch merging will screw this up.
 			js.isLastInstruction = true;
 			js.next_inst = 0;
-			if (Profiler::g_ProfileBlocks) {
-				// CAUTION!!! push on stack regs you use, do your stuff, then pop
-				PROFILER_VPUSH;
-				// get end tic
-				PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStop);
-				// tic counter += (end tic - start tic)
-				PROFILER_ADD_DIFF_LARGE_INTEGER(&b->ticCounter, &b->ticStop, &b->ticStart);
-				PROFILER_VPOP;
-			}
 		}
 		else
 		{
@@ -595,7 +1102,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 			}
 
 			// Add an external exception check if the instruction writes to the FIFO.
-			if (jit->js.fifoWriteAddresses.find(ops[i].address) != jit->js.fifoWriteAddresses.end())
+			if (std::find(analysis.fifoWriteAddresses.begin(), analysis.fifoWriteAddresses.end(), ops[i].address) != analysis.fifoWriteAddresses.end())
 			{
 				gpr.Flush(FLUSH_ALL);
 				fpr.Flush(FLUSH_ALL);
@@ -632,6 +1139,13 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 				SetJumpTarget(noBreakpoint);
 			}
 
+			while (next_constant < analysis.constantGPRs.size() && analysis.constantGPRs[next_constant].op <= i)
+			{
+				const ConstantGPR &constant = analysis.constantGPRs[next_constant++];
+				if (constant.op == i && !gpr.R(constant.reg).IsImm())
+					gpr.SetImmediate32(constant.reg, constant.value);
+			}
+
 			Jit64Tables::CompileInstruction(ops[i]);
 
 			if (js.memcheck && (opinfo->flags & FL_LOADSTORE))
@@ -688,7 +1202,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		}
 	}
 
-	if (memory_exception)
+	if (analysis.memoryException)
 	{
 		// Address of instruction could not be translated
 		MOV(32, M(&NPC), Imm32(js.compilerPC));
@@ -706,8 +1220,9 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		WriteExceptionExit();
 	}
 
-	if (broken_block)
+	if (analysis.brokenBlock)
 	{
+		gpr.DiscardDead(js.exitLiveGPRs);
 		gpr.Flush(FLUSH_ALL);
 		fpr.Flush(FLUSH_ALL);
 		WriteExit(nextPC);
@@ -716,9 +1231,14 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	b->flags = js.block_flags;
 	b->codeSize = (u32)(GetCodePtr() - normalEntry);
 	b->originalSize = size;
+	b->dependencyAddress = analysis.dependencyAddress;
+	b->dependencySize = analysis.dependencySize;
+	b->registersInUse.swap(registersInUseAtLoc);
+	registersInUseAtLoc.clear();
+	block_analysis = NULL;
 
 #ifdef JIT_LOG_X86
-	LogGeneratedX86(size, code_buf, normalEntry, b);
+	LogGeneratedX86(size, ops, normalEntry, b);
 #endif
 
 	return normalEntry;
@@ -18,6 +18,12 @@
 // ----------
 #pragma once
 
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "Thread.h"
 #include "../JitCommon/JitBackpatch.h"
 #include "../JitCommon/JitBase.h"
 #include "../JitCommon/JitCache.h"
@@ -36,6 +42,13 @@
 #include "x64Analyzer.h"
 #include "x64Emitter.h"
 
+// How often the conditional branch ending a baseline block went either way.
+struct BranchProfile
+{
+	u32 taken;
+	u32 notTaken;
+};
+
 class Jit64 : public Jitx86Base
 {
 private:
@@ -47,8 +60,100 @@ private:
 	PPCAnalyst::CodeBuffer code_buffer;
 	Jit64AsmRoutineManager asm_routines;
 
+	// A GPR with a value known at compile time, which the load or store at
+	// index op uses for its address.
+	struct ConstantGPR
+	{
+		int op;
+		int reg;
+		u32 value;
+	};
+
+	// Everything code generation needs to know about a block that depends on
+	// emulated memory or other CPU thread state.
+	struct BlockAnalysis
+	{
+		u32 address;
+		u32 nextPC;
+		int size;
+		bool brokenBlock;
+		bool memoryException;
+		PPCAnalyst::MergeMode mergeMode;
+		int speedhackCycles;
+		PPCAnalyst::BlockStats st;
+		PPCAnalyst::BlockRegStats gpa;
+		PPCAnalyst::BlockRegStats fpa;
+		// Instructions in the block that need an external exception check.
+		std::vector<u32> fifoWriteAddresses;
+		// GPRs the code after the final exit may read, and the function that
+		// was taken from (see ComputeExitLiveness).
+		u32 exitLiveGPRs;
+		u32 dependencyAddress;
+		u32 dependencySize;
+		// Counts for the final branch of a baseline block, for trace formation.
+		BranchProfile *branchProfile;
+		// In the order of the ops (see FindConstantAddresses).
+		std::vector<ConstantGPR> constantGPRs;
+		// What code generation would otherwise read from ppcState and memory,
+		// which the compile thread can't: whether the performance monitor is on,
+		// the address each lwz of the idle loop pattern polls, keyed by the
+		// address of the lwz, and the dcbst instructions that follow a dcbt.
+		bool performanceMonitor;
+		std::map<u32, u32> idleLoadAddresses;
+		std::set<u32> dcbstAfterDcbt;
+	};
+
+	// A block analyzed on the CPU thread and compiled on the compile thread.
+	struct BackgroundCompile
+	{
+		BlockAnalysis analysis;
+		std::vector<PPCAnalyst::CodeOp> ops;
+		int block_num;
+		u32 generation;
+		const u8 *code;
+	};
+
+	// Held while generating code or clearing the code cache.
+	std::recursive_mutex compile_lock;
+	// Bumped under compile_lock whenever queued compiles become meaningless.
+	u32 compile_generation;
+	bool in_compile_thread;
+
+	std::thread compile_thread;
+	Common::Event compile_event;
+	// Protects the two queues and compile_thread_running.
+	std::mutex queue_lock;
+	std::deque<BackgroundCompile> compile_queue;
+	std::deque<BackgroundCompile> compiled_queue;
+	bool compile_thread_running;
+	// Addresses that are queued or compiled but not published yet.
+	std::set<u32> compile_pending;
+
+	// With block eviction, the code space is a ring of regions, and blocks
+	// are compiled into the current one until it's full.
+	int code_region;
+	u8 *code_region_end;
+
+	// Where the block being compiled counts its final branch, if anywhere.
+	BranchProfile *branch_profile;
+	// The analysis of the block being compiled.
+	const BlockAnalysis *block_analysis;
+
+	void ResetCodeRegions();
+	bool IsCodeSpaceLow() const;
+	void EvictCode();
+
+	void StartCompileThread();
+	void StopCompileThread();
+	void CompileThread();
+	bool CompileInBackground(u32 em_address);
+	bool PublishBackgroundCompiles();
+	void CancelBackgroundCompiles();
+	void InterpretBlock();
+
 public:
-	Jit64() : code_buffer(32000) {}
+	Jit64() : code_buffer(32000), compile_generation(0), in_compile_thread(false), compile_thread_running(false),
+		code_region(0), code_region_end(NULL), branch_profile(NULL), block_analysis(NULL) {}
 	~Jit64() {}
 
 	void Init() override;
@@ -58,6 +163,12 @@ public:
 
 	void Jit(u32 em_address) override;
 	const u8* DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buffer, JitBlock *b);
+	void AnalyzeBlock(u32 em_address, PPCAnalyst::CodeBuffer *code_buffer, BlockAnalysis &analysis, bool speculative = false);
+	void ComputeExitLiveness(const PPCAnalyst::CodeOp *ops, BlockAnalysis &analysis);
+	void FindConstantAddresses(const PPCAnalyst::CodeOp *ops, BlockAnalysis &analysis);
+	const u8* EmitBlock(const BlockAnalysis &analysis, PPCAnalyst::CodeOp *ops, JitBlock *b);
+	void WarmUpBlocks();
+	PPCAnalyst::MergeMode GetMergeMode(u32 em_address) const;
 
 	u32 RegistersInUse();
 
@@ -66,6 +177,7 @@ public:
 	void Trace();
 
 	void ClearCache() override;
+	void InvalidateICache(u32 address, u32 length) override;
 
 	const u8 *GetDispatcher() {
 		return asm_routines.dispatcher;
@@ -89,6 +201,13 @@ public:
 	// Utilities for use by opcodes
 
 	void WriteExit(u32 destination);
+	// Clobbers RAX on x64.
+	void WriteCounterIncrement(u32 *counter);
+	// Stores GPR s to an address known at compile time.
+	void WriteToConstAddress(int accessSize, int s, u32 address);
+	// Loads a hardware register known at compile time through its handler.
+	void ReadFromConstHWAddress(Gen::X64Reg reg_value, const void *handler, u32 address, int accessSize, bool signExtend);
+	void WriteIdleExit(u32 destination);
 	void WriteExitDestInEAX();
 	void WriteExceptionExit();
 	void WriteExternalExceptionExit();
@@ -105,7 +224,8 @@ public:
 	void GenerateRC();
 	void ComputeRC(const Gen::OpArg & arg);
 
-	void tri_op(int d, int a, int b, bool reversible, void (XEmitter::*op)(Gen::X64Reg, Gen::OpArg));
+	void tri_op(int d, int a, int b, bool reversible, void (XEmitter::*op)(Gen::X64Reg, Gen::OpArg),
+	            void (XEmitter::*avxOp)(Gen::X64Reg, Gen::X64Reg, Gen::OpArg));
 	typedef u32 (*Operation)(u32 a, u32 b);
 	void regimmop(int d, int a, bool binary, u32 value, Operation doop, void (XEmitter::*op)(int, const Gen::OpArg&, const Gen::OpArg&), bool Rc = false, bool carry = false);
 	void fp_tri_op(int d, int a, int b, bool reversible, bool single, void (XEmitter::*op)(Gen::X64Reg, Gen::OpArg));
@@ -156,9 +156,18 @@ void Jit64AsmRoutineManager::Generate()
 			MOV(32, R(ABI_PARAM1), M(&PowerPC::ppcState.pc));
 			CALL((void *)&Jit);
 #endif
+			// With background compilation, Jit may have run the block in the interpreter.
+			FixupBranch outOfCycles;
+			if (jit->jo.backgroundCompile)
+			{
+				CMP(32, M(&CoreTiming::downcount), Imm8(0));
+				outOfCycles = J_CC(CC_LE, true);
+			}
 			JMP(dispatcherNoCheck); // no point in special casing this
 
 		SetJumpTarget(bail);
+		if (jit->jo.backgroundCompile)
+			SetJumpTarget(outOfCycles);
 		doTiming = GetCodePtr();
 
 		testExternalExceptions = GetCodePtr();
@@ -182,6 +191,8 @@ void Jit64AsmRoutineManager::Generate()
 	RET();
 
 	GenerateCommon();
+
+	JitRegister::Register(enterCode, (u32)(GetCodePtr() - enterCode), "JIT_Dispatcher");
 }
 
 void Jit64AsmRoutineManager::GenerateCommon()
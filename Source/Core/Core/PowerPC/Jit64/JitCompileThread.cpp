@@ -0,0 +1,223 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Background compilation
+// With JITBackgroundCompile, a dispatcher miss doesn't stall the CPU thread on
+// code generation. The block is analyzed right away (that has to happen on the
+// CPU thread, as fetching goes through the emulated instruction cache), queued
+// for the compile thread, and run in the interpreter until it is ready.
+// Finished blocks are handed to the block cache on the CPU thread, from the
+// dispatcher, since linking patches code that may be running otherwise.
+//
+// The compile thread owns the emitter and the register caches while it holds
+// compile_lock; the CPU thread only takes that lock for synchronous compiles
+// and for clearing the cache. The block cache is never touched by the compile
+// thread, except for the slot AllocateBlock reserved for the request.
+//
+// icbi can hit a block that is being compiled. Rather than tracking that, the
+// code is read again when the block gets published, and the block is dropped
+// if any instruction changed in the meantime. Dropped blocks give their slot
+// back to the block cache.
+//
+// Everything code generation needs from ppcState or memory is read by
+// AnalyzeBlock, see BlockAnalysis. The registers in use at each fastmem access
+// go into the block's slot too, and only reach the backpatcher, which runs on
+// the CPU thread, when the block is finalized.
+
+#include "../Interpreter/Interpreter.h"
+#include "../JitInterface.h"
+#include "Jit.h"
+
+void Jit64::StartCompileThread()
+{
+	compile_thread_running = true;
+	compile_thread = std::thread(&Jit64::CompileThread, this);
+}
+
+void Jit64::StopCompileThread()
+{
+	if (!compile_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(queue_lock);
+		compile_thread_running = false;
+	}
+	compile_event.Set();
+	compile_thread.join();
+
+	compile_queue.clear();
+	compiled_queue.clear();
+	compile_pending.clear();
+}
+
+void Jit64::CompileThread()
+{
+	Common::SetCurrentThreadName("JIT compile thread");
+
+	while (true)
+	{
+		compile_event.Wait();
+
+		while (true)
+		{
+			BackgroundCompile request;
+			{
+				std::lock_guard<std::mutex> lk(queue_lock);
+				if (!compile_thread_running)
+					return;
+				if (compile_queue.empty())
+					break;
+				request = compile_queue.front();
+				compile_queue.pop_front();
+			}
+
+			std::lock_guard<std::recursive_mutex> lk(compile_lock);
+			if (request.generation != compile_generation)
+				continue;
+
+			// Out of space: hand it back empty, the CPU thread clears the cache.
+			if (!IsCodeSpaceLow())
+			{
+				in_compile_thread = true;
+				request.code = EmitBlock(request.analysis, &request.ops[0], blocks.GetBlock(request.block_num));
+				in_compile_thread = false;
+			}
+
+			std::lock_guard<std::mutex> queue_lk(queue_lock);
+			compiled_queue.push_back(request);
+		}
+	}
+}
+
+// Returns false if the block should be compiled right away instead.
+bool Jit64::CompileInBackground(u32 em_address)
+{
+	if (!PublishBackgroundCompiles())
+		return false;
+
+	if (blocks.GetBlockNumberFromStartAddress(em_address) >= 0)
+		return true;
+
+	if (compile_pending.find(em_address) == compile_pending.end())
+	{
+		if (blocks.IsFull())
+			return false;
+
+		BackgroundCompile request;
+		AnalyzeBlock(em_address, &code_buffer, request.analysis);
+		if (request.analysis.memoryException || request.analysis.size == 0)
+			return false;
+
+		request.ops.assign(code_buffer.codebuffer, code_buffer.codebuffer + request.analysis.size);
+		request.block_num = blocks.AllocateBlock(em_address);
+		request.generation = compile_generation;
+		request.code = NULL;
+
+		// Keep DestroyBlock away from the slot until the block is published.
+		blocks.GetBlock(request.block_num)->invalid = true;
+
+		{
+			std::lock_guard<std::mutex> lk(queue_lock);
+			compile_queue.push_back(request);
+		}
+		compile_pending.insert(em_address);
+		compile_event.Set();
+	}
+
+	InterpretBlock();
+	return true;
+}
+
+// Returns false if the compile thread ran out of code space.
+bool Jit64::PublishBackgroundCompiles()
+{
+	std::deque<BackgroundCompile> compiled;
+	{
+		std::lock_guard<std::mutex> lk(queue_lock);
+		compiled.swap(compiled_queue);
+	}
+
+	bool out_of_space = false;
+	for (BackgroundCompile &request : compiled)
+	{
+		const u32 address = request.analysis.address;
+		compile_pending.erase(address);
+
+		if (!request.code)
+		{
+			blocks.ReleaseBlock(request.block_num);
+			out_of_space = true;
+			continue;
+		}
+
+		if (blocks.GetBlockNumberFromStartAddress(address) >= 0)
+		{
+			blocks.ReleaseBlock(request.block_num);
+			continue;
+		}
+
+		// The code may have changed while the block was being compiled.
+		bool changed = false;
+		size_t num_fifo_writes = 0;
+		for (const PPCAnalyst::CodeOp &op : request.ops)
+		{
+			if (JitInterface::Read_Opcode_JIT(op.address) != op.inst.hex)
+				changed = true;
+			if (js.fifoWriteAddresses.find(op.address) != js.fifoWriteAddresses.end())
+				num_fifo_writes++;
+		}
+		if (changed || num_fifo_writes != request.analysis.fifoWriteAddresses.size())
+		{
+			blocks.ReleaseBlock(request.block_num);
+			continue;
+		}
+
+		// So may the function exit liveness was taken from.
+		BlockAnalysis check = request.analysis;
+		ComputeExitLiveness(&request.ops[0], check);
+		if (check.exitLiveGPRs != request.analysis.exitLiveGPRs ||
+			check.dependencyAddress != request.analysis.dependencyAddress)
+		{
+			blocks.ReleaseBlock(request.block_num);
+			continue;
+		}
+
+		JitBlock *b = blocks.GetBlock(request.block_num);
+		b->invalid = false;
+		blocks.FinalizeBlock(request.block_num, jo.enableBlocklink, request.code);
+		blocks.GetDiskCache().RecordBlock(JitDiskCache::ComputeKey(address, &request.ops[0], b->originalSize));
+	}
+
+	return !out_of_space;
+}
+
+// Called with compile_lock held, before the block cache and code space are reset.
+void Jit64::CancelBackgroundCompiles()
+{
+	compile_generation++;
+
+	std::lock_guard<std::mutex> lk(queue_lock);
+	compile_queue.clear();
+	compiled_queue.clear();
+	compile_pending.clear();
+}
+
+// Runs one block in the interpreter, the same way Interpreter::Run does.
+void Jit64::InterpretBlock()
+{
+	Interpreter *interpreter = Interpreter::getInstance();
+
+	Interpreter::m_EndBlock = false;
+	int cycles = 0;
+	while (!Interpreter::m_EndBlock)
+		cycles += interpreter->SingleStepInner();
+	CoreTiming::downcount -= cycles;
+
+	if (PowerPC::ppcState.Exceptions)
+	{
+		PowerPC::CheckExceptions();
+		PC = NPC;
+	}
+}
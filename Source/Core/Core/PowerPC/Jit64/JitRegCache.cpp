@@ -177,6 +177,24 @@ void RegCache::DiscardRegContentsIfCached(int preg)
 	}
 }
 
+void RegCache::DiscardDead(u32 live_regs)
+{
+	for (int i = 0; i < 32; i++)
+	{
+		if ((live_regs & (1U << i)) || !regs[i].away)
+			continue;
+
+		if (regs[i].location.IsSimpleReg())
+		{
+			DiscardRegContentsIfCached(i);
+		}
+		else if (regs[i].location.IsImm())
+		{
+			regs[i].away = false;
+			regs[i].location = GetDefaultLocation(i);
+		}
+	}
+}
 
 void GPRRegCache::SetImmediate32(int preg, u32 immValue)
 {
@@ -67,6 +67,8 @@ public:
 	virtual void Start(PPCAnalyst::BlockRegStats &stats) = 0;
 
 	void DiscardRegContentsIfCached(int preg);
+	// Forgets every register not in live_regs without writing it back.
+	void DiscardDead(u32 live_regs);
 	void SetEmitter(XEmitter *emitter) {emit = emitter;}
 
 	void FlushR(X64Reg reg);
@@ -71,6 +71,7 @@ void Jit64::bx(UGeckoInstruction inst)
 		return;
 	}
 
+	gpr.DiscardDead(js.exitLiveGPRs);
 	gpr.Flush(FLUSH_ALL);
 	fpr.Flush(FLUSH_ALL);
 
@@ -103,19 +104,25 @@ void Jit64::bcx(UGeckoInstruction inst)
 	JITDISABLE(bJITBranchOff)
 
 	// USES_CR
-	_assert_msg_(DYNA_REC, js.isLastInstruction, "bcx not last instruction of block");
+	_assert_msg_(DYNA_REC, js.isLastInstruction || js.op->sideExit, "bcx not last instruction of block");
 
+	// Covers both exits
+	if (js.isLastInstruction)
+		gpr.DiscardDead(js.exitLiveGPRs);
 	gpr.Flush(FLUSH_ALL);
 	fpr.Flush(FLUSH_ALL);
 
+	// The counting makes the exits too long for short jumps.
+	const bool far = branch_profile != NULL;
+
 	FixupBranch pCTRDontBranch;
 	if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)  // Decrement and test CTR
 	{
 		SUB(32, M(&CTR), Imm8(1));
 		if (inst.BO & BO_BRANCH_IF_CTR_0)
-			pCTRDontBranch = J_CC(CC_NZ);
+			pCTRDontBranch = J_CC(CC_NZ, far);
 		else
-			pCTRDontBranch = J_CC(CC_Z);
+			pCTRDontBranch = J_CC(CC_Z, far);
 	}
 
 	FixupBranch pConditionDontBranch;
@@ -123,25 +130,53 @@ void Jit64::bcx(UGeckoInstruction inst)
 	{
 		TEST(8, M(&PowerPC::ppcState.cr_fast[inst.BI >> 2]), Imm8(8 >> (inst.BI & 3)));
 		if (inst.BO & BO_BRANCH_IF_TRUE)  // Conditional branch
-			pConditionDontBranch = J_CC(CC_Z);
+			pConditionDontBranch = J_CC(CC_Z, far);
 		else
-			pConditionDontBranch = J_CC(CC_NZ);
+			pConditionDontBranch = J_CC(CC_NZ, far);
 	}
 
-	if (inst.LK)
-		MOV(32, M(&LR), Imm32(js.compilerPC + 4));
-
 	u32 destination;
 	if(inst.AA)
 		destination = SignExt16(inst.BD << 2);
 	else
 		destination = js.compilerPC + SignExt16(inst.BD << 2);
+
+	// A branch trace formation followed: the block goes on the way it mostly
+	// goes, and only leaves the other way.
+	if (!js.isLastInstruction)
+	{
+		FixupBranch pTaken;
+		if (js.op->sideExit == destination)
+			WriteExit(destination);
+		else
+			pTaken = J(true);
+
+		if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
+			SetJumpTarget( pConditionDontBranch );
+		if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+			SetJumpTarget( pCTRDontBranch );
+
+		if (js.op->sideExit != destination)
+		{
+			WriteExit(js.compilerPC + 4);
+			SetJumpTarget(pTaken);
+		}
+		return;
+	}
+
+	if (inst.LK)
+		MOV(32, M(&LR), Imm32(js.compilerPC + 4));
+
+	if (branch_profile)
+		WriteCounterIncrement(&branch_profile->taken);
 	WriteExit(destination);
 
 	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
 		SetJumpTarget( pConditionDontBranch );
 	if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
 		SetJumpTarget( pCTRDontBranch );
+	if (branch_profile)
+		WriteCounterIncrement(&branch_profile->notTaken);
 	WriteExit(js.compilerPC + 4);
 }
 
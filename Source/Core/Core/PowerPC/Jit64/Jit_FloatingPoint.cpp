@@ -40,6 +40,11 @@ void Jit64::fp_tri_op(int d, int a, int b, bool reversible, bool single, void (X
 		{
 			MOVSD(XMM0, fpr.R(b));
 			fpr.BindToRegister(d, !single);
+			if (!single)
+			{
+				// MOVSD from memory would clear ps1
+				fpr.BindToRegister(a, true, false);
+			}
 			MOVSD(fpr.RX(d), fpr.R(a));
 			(this->*op)(fpr.RX(d), Gen::R(XMM0));
 		}
@@ -50,6 +55,7 @@ void Jit64::fp_tri_op(int d, int a, int b, bool reversible, bool single, void (X
 		fpr.BindToRegister(d, !single);
 		if(!single)
 		{
+			fpr.BindToRegister(a, true, false);
 			fpr.BindToRegister(b, true, false);
 		}
 		MOVSD(fpr.RX(d), fpr.R(a));
@@ -154,7 +160,8 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
 		XORPD(XMM0, M((void*)&psSignBits2));
 		break;
 	}
-	fpr.BindToRegister(d, false);
+	// The double forms leave ps1 alone.
+	fpr.BindToRegister(d, !single_precision);
 	//YES it is necessary to dupe the result :(
 	//TODO : analysis - does the top reg get used? If so, dupe, if not, don't.
 	if (single_precision) {
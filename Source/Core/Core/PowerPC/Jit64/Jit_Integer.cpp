@@ -318,8 +318,9 @@ void Jit64::cmpXX(UGeckoInstruction inst)
 		(js.next_inst.BO & BO_DONT_DECREMENT_FLAG) &&
 		!(js.next_inst.BO & BO_DONT_CHECK_CONDITION)) {
 			// Looks like a decent conditional branch that we can merge with.
-			// It only test CR, not CTR.
-			if (test_crf == crf) {
+			// It only test CR, not CTR. Side exits and counted branches are
+			// left to bcx.
+			if (test_crf == crf && !js.op[1].sideExit && !branch_profile) {
 				merge_branch = true;
 			}
 	}
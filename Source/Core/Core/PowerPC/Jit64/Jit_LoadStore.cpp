@@ -96,12 +96,10 @@ void Jit64::lXXx(UGeckoInstruction inst)
 	// IMHO those Idles should always be skipped and replaced by a more controllable "native" Idle methode
 	// ... maybe the throttle one already do that :p
 	// if (CommandProcessor::AllowIdleSkipping() && PixelEngine::AllowIdleSkipping())
+	// AnalyzeBlock looks for the pattern, the code may be compiled on another thread.
+	auto idle_load = block_analysis->idleLoadAddresses.find(js.compilerPC);
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bSkipIdle &&
-		inst.OPCD == 32 &&
-		(inst.hex & 0xFFFF0000) == 0x800D0000 &&
-		(Memory::ReadUnchecked_U32(js.compilerPC + 4) == 0x28000000 ||
-		(SConfig::GetInstance().m_LocalCoreStartupParameter.bWii && Memory::ReadUnchecked_U32(js.compilerPC + 4) == 0x2C000000)) &&
-		Memory::ReadUnchecked_U32(js.compilerPC + 8) == 0x4182fff8)
+		idle_load != block_analysis->idleLoadAddresses.end())
 	{
 		// TODO(LinesPrower):
 		// - Rewrite this!
@@ -120,7 +118,7 @@ void Jit64::lXXx(UGeckoInstruction inst)
 		u32 registersInUse = RegistersInUse();
 		ABI_PushRegistersAndAdjustStack(registersInUse, false);
 
-		ABI_CallFunctionC((void *)&PowerPC::OnIdle, PowerPC::ppcState.gpr[a] + (s32)(s16)inst.SIMM_16);
+		ABI_CallFunctionC((void *)&PowerPC::OnIdle, idle_load->second);
 
 		ABI_PopRegistersAndAdjustStack(registersInUse, false);
 
@@ -198,9 +196,17 @@ void Jit64::lXXx(UGeckoInstruction inst)
 		}
 	}
 
+	// Memory checks are only done by the Read_U* functions.
+	const void *hw_read = NULL;
+	if (jo.constantAddresses && opAddress.IsImm() && !js.memcheck && !Core::g_CoreStartupParameter.bEnableDebugging)
+		hw_read = Memory::GetHWReadHandler((u32)opAddress.offset, accessSize);
+
 	gpr.Lock(a, b, d);
 	gpr.BindToRegister(d, js.memcheck, true);
-	SafeLoadToReg(gpr.RX(d), opAddress, accessSize, 0, RegistersInUse(), signExtend);
+	if (hw_read)
+		ReadFromConstHWAddress(gpr.RX(d), hw_read, (u32)opAddress.offset, accessSize, signExtend);
+	else
+		SafeLoadToReg(gpr.RX(d), opAddress, accessSize, 0, RegistersInUse(), signExtend);
 
 	if (update && js.memcheck && !zeroOffset)
 	{
@@ -222,8 +228,8 @@ void Jit64::dcbst(UGeckoInstruction inst)
 	// If the dcbst instruction is preceded by dcbt, it is flushing a prefetched
 	// memory location.  Do not invalidate the JIT cache in this case as the memory
 	// will be the same.
-	// dcbt = 0x7c00022c
-	if ((Memory::ReadUnchecked_U32(js.compilerPC - 4) & 0x7c00022c) != 0x7c00022c)
+	// dcbt = 0x7c00022c, AnalyzeBlock checks for it.
+	if (!block_analysis->dcbstAfterDcbt.count(js.compilerPC))
 	{
 		Default(inst); return;
 	}
@@ -252,6 +258,71 @@ void Jit64::dcbz(UGeckoInstruction inst)
 #endif
 }
 
+void Jit64::WriteToConstAddress(int accessSize, int s, u32 address)
+{
+	if ((address & 0xFFFFF000) == 0xCC008000 && jo.optimizeGatherPipe)
+	{
+		MOV(32, M(&PC), Imm32(jit->js.compilerPC)); // Helps external systems know which instruction triggered the write
+		gpr.FlushLockX(ABI_PARAM1);
+		MOV(32, R(ABI_PARAM1), gpr.R(s));
+		switch (accessSize)
+		{
+			// No need to protect these, they don't touch any state
+			// question - should we inline them instead? Pro: Lose a CALL   Con: Code bloat
+		case 8:  CALL((void *)asm_routines.fifoDirectWrite8);  break;
+		case 16: CALL((void *)asm_routines.fifoDirectWrite16); break;
+		case 32: CALL((void *)asm_routines.fifoDirectWrite32); break;
+		}
+		js.fifoBytesThisBlock += accessSize >> 3;
+		gpr.UnlockAllX();
+	}
+	else if (Memory::IsRAMAddress(address))
+	{
+		MOV(32, R(EAX), gpr.R(s));
+		BSWAP(accessSize, EAX);
+		WriteToConstRamAddress(accessSize, R(EAX), address);
+	}
+	else
+	{
+		MOV(32, M(&PC), Imm32(jit->js.compilerPC)); // Helps external systems know which instruction triggered the write
+		// Hardware registers go straight to their handler, memory checks are only done by the Write_U* functions.
+		void *func = NULL;
+		if (jo.constantAddresses && !Core::g_CoreStartupParameter.bEnableDebugging)
+			func = (void *)Memory::GetHWWriteHandler(address, accessSize);
+		if (!func)
+		{
+			switch (accessSize)
+			{
+			case 32: func = (void *)&Memory::Write_U32; break;
+			case 16: func = (void *)&Memory::Write_U16; break;
+			case 8:  func = (void *)&Memory::Write_U8;  break;
+			}
+		}
+		u32 registersInUse = RegistersInUse();
+		ABI_PushRegistersAndAdjustStack(registersInUse, false);
+		ABI_CallFunctionAC(func, gpr.R(s), address);
+		ABI_PopRegistersAndAdjustStack(registersInUse, false);
+	}
+}
+
+// The handlers take the value by reference, and only write accessSize bits of it.
+static u32 s_hw_read_value;
+
+void Jit64::ReadFromConstHWAddress(X64Reg reg_value, const void *handler, u32 address, int accessSize, bool signExtend)
+{
+	u32 registersInUse = RegistersInUse();
+	ABI_PushRegistersAndAdjustStack(registersInUse, false);
+	ABI_CallFunctionPC((void *)handler, &s_hw_read_value, address);
+	ABI_PopRegistersAndAdjustStack(registersInUse, false);
+
+	if (accessSize == 32)
+		MOV(32, R(reg_value), M(&s_hw_read_value));
+	else if (signExtend)
+		MOVSX(32, accessSize, reg_value, M(&s_hw_read_value));
+	else
+		MOVZX(32, accessSize, reg_value, M(&s_hw_read_value));
+}
+
 void Jit64::stX(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
@@ -280,50 +351,10 @@ void Jit64::stX(UGeckoInstruction inst)
 			// fun tricks...
 			u32 addr = ((a == 0) ? 0 : (u32)gpr.R(a).offset);
 			addr += offset;
-			if ((addr & 0xFFFFF000) == 0xCC008000 && jo.optimizeGatherPipe)
-			{
-				MOV(32, M(&PC), Imm32(jit->js.compilerPC)); // Helps external systems know which instruction triggered the write
-				gpr.FlushLockX(ABI_PARAM1);
-				MOV(32, R(ABI_PARAM1), gpr.R(s));
-				if (update)
-					gpr.SetImmediate32(a, addr);
-				switch (accessSize)
-				{
-					// No need to protect these, they don't touch any state
-					// question - should we inline them instead? Pro: Lose a CALL   Con: Code bloat
-				case 8:  CALL((void *)asm_routines.fifoDirectWrite8);  break;
-				case 16: CALL((void *)asm_routines.fifoDirectWrite16); break;
-				case 32: CALL((void *)asm_routines.fifoDirectWrite32); break;
-				}
-				js.fifoBytesThisBlock += accessSize >> 3;
-				gpr.UnlockAllX();
-				return;
-			}
-			else if (Memory::IsRAMAddress(addr))
-			{
-				MOV(32, R(EAX), gpr.R(s));
-				BSWAP(accessSize, EAX);
-				WriteToConstRamAddress(accessSize, R(EAX), addr);
-				if (update)
-					gpr.SetImmediate32(a, addr);
-				return;
-			}
-			else
-			{
-				MOV(32, M(&PC), Imm32(jit->js.compilerPC)); // Helps external systems know which instruction triggered the write
-				u32 registersInUse = RegistersInUse();
-				ABI_PushRegistersAndAdjustStack(registersInUse, false);
-				switch (accessSize)
-				{
-				case 32: ABI_CallFunctionAC(true ? ((void *)&Memory::Write_U32) : ((void *)&Memory::Write_U32_Swap), gpr.R(s), addr); break;
-				case 16: ABI_CallFunctionAC(true ? ((void *)&Memory::Write_U16) : ((void *)&Memory::Write_U16_Swap), gpr.R(s), addr); break;
-				case 8:  ABI_CallFunctionAC((void *)&Memory::Write_U8, gpr.R(s), addr);  break;
-				}
-				ABI_PopRegistersAndAdjustStack(registersInUse, false);
-				if (update)
-					gpr.SetImmediate32(a, addr);
-				return;
-			}
+			WriteToConstAddress(accessSize, s, addr);
+			if (update)
+				gpr.SetImmediate32(a, addr);
+			return;
 		}
 
 		// Optimized stack access?
@@ -401,6 +432,25 @@ void Jit64::stXx(UGeckoInstruction inst)
 		Default(inst);
 		return;
 	}
+
+	int accessSize;
+	switch (inst.SUBOP10 & ~32) {
+		case 151: accessSize = 32; break;
+		case 407: accessSize = 16; break;
+		case 215: accessSize = 8; break;
+		default: PanicAlert("stXx: invalid access size");
+			accessSize = 0; break;
+	}
+
+	if (gpr.R(a).IsImm() && gpr.R(b).IsImm() && !js.memcheck)
+	{
+		u32 addr = (u32)gpr.R(a).offset + (u32)gpr.R(b).offset;
+		WriteToConstAddress(accessSize, s, addr);
+		if (inst.SUBOP10 & 32)
+			gpr.SetImmediate32(a, addr);
+		return;
+	}
+
 	gpr.Lock(a, b, s);
 	gpr.FlushLockX(ECX, EDX);
 
@@ -415,14 +465,6 @@ void Jit64::stXx(UGeckoInstruction inst)
 		MOV(32, R(EDX), gpr.R(a));
 		ADD(32, R(EDX), gpr.R(b));
 	}
-	int accessSize;
-	switch (inst.SUBOP10 & ~32) {
-		case 151: accessSize = 32; break;
-		case 407: accessSize = 16; break;
-		case 215: accessSize = 8; break;
-		default: PanicAlert("stXx: invalid access size");
-			accessSize = 0; break;
-	}
 
 	MOV(32, R(ECX), gpr.R(s));
 	SafeWriteRegToReg(ECX, EDX, accessSize, 0, RegistersInUse());
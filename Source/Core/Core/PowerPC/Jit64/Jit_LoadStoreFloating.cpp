@@ -21,7 +21,9 @@ const u8 GC_ALIGNED16(bswapShuffle2x8[16]) = {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13
 
 namespace {
 
+#ifdef _M_IX86
 u64 GC_ALIGNED16(temp64);
+#endif
 u32 GC_ALIGNED16(temp32);
 }
 // TODO: Add peephole optimizations for multiple consecutive lfd/lfs/stfd/stfs since they are so common,
@@ -73,37 +75,29 @@ void Jit64::lfd(UGeckoInstruction inst)
 		return;
 	}
 	s32 offset = (s32)(s16)inst.SIMM_16;
-	gpr.FlushLockX(ABI_PARAM1);
-	gpr.Lock(a);
-	MOV(32, R(ABI_PARAM1), gpr.R(a));
 	// TODO - optimize. This has to load the previous value - upper double should stay unmodified.
 	fpr.Lock(d);
 	fpr.BindToRegister(d, true);
 	X64Reg xd = fpr.RX(d);
 
-	if (cpu_info.bSSSE3)
-	{
 #ifdef _M_X64
-		MOVQ_xmm(XMM0, MComplex(RBX, ABI_PARAM1, SCALE_1, offset));
+	// Same fastmem and backpatching path as the integer loads.
+	gpr.Lock(a);
+	SafeLoadToReg(RAX, gpr.R(a), 64, offset, RegistersInUse(), false);
+	MOVQ_xmm(XMM0, R(RAX));
+	MOVSD(xd, R(XMM0));
 #else
+	gpr.FlushLockX(ABI_PARAM1);
+	gpr.Lock(a);
+	MOV(32, R(ABI_PARAM1), gpr.R(a));
+
+	if (cpu_info.bSSSE3)
+	{
 		AND(32, R(ABI_PARAM1), Imm32(Memory::MEMVIEW32_MASK));
 		MOVQ_xmm(XMM0, MDisp(ABI_PARAM1, (u32)Memory::base + offset));
-#endif
 		PSHUFB(XMM0, M((void *)bswapShuffle1x8Dupe));
 		MOVSD(xd, R(XMM0));
 	} else {
-#ifdef _M_X64
-		MOV(64, R(EAX), MComplex(RBX, ABI_PARAM1, SCALE_1, offset));
-		BSWAP(64, EAX);
-		MOV(64, M(&temp64), R(EAX));
-
-		MEMCHECK_START
-
-		MOVSD(XMM0, M(&temp64));
-		MOVSD(xd, R(XMM0));
-
-		MEMCHECK_END
-#else
 		AND(32, R(ABI_PARAM1), Imm32(Memory::MEMVIEW32_MASK));
 		MOV(32, R(EAX), MDisp(ABI_PARAM1, (u32)Memory::base + offset));
 		BSWAP(32, EAX);
@@ -118,8 +112,8 @@ void Jit64::lfd(UGeckoInstruction inst)
 		MOVSD(xd, R(XMM0));
 
 		MEMCHECK_END
-#endif
 	}
+#endif
 
 	gpr.UnlockAll();
 	gpr.UnlockAllX();
@@ -141,7 +135,27 @@ void Jit64::stfd(UGeckoInstruction inst)
 		Default(inst);
 		return;
 	}
+	s32 offset = (s32)(s16)inst.SIMM_16;
 
+#ifdef _M_X64
+	if (gpr.R(a).IsImm() && Memory::IsRAMAddress((u32)gpr.R(a).offset + offset))
+	{
+		MOVAPD(XMM0, fpr.R(s));
+		MOVQ_xmm(R(RAX), XMM0);
+		BSWAP(64, RAX);
+		WriteToConstRamAddress(64, R(RAX), (u32)gpr.R(a).offset + offset);
+		return;
+	}
+
+	// Same fastmem and backpatching path as the integer stores.
+	gpr.FlushLockX(ABI_PARAM1);
+	gpr.Lock(a);
+	fpr.Lock(s);
+	MOV(32, R(ABI_PARAM1), gpr.R(a));
+	MOVAPD(XMM0, fpr.R(s));
+	MOVQ_xmm(R(RAX), XMM0);
+	SafeWriteRegToReg(RAX, ABI_PARAM1, 64, offset, RegistersInUse());
+#else
 	u32 mem_mask = Memory::ADDR_MASK_HW_ACCESS;
 	if (Core::g_CoreStartupParameter.bMMU ||
 		Core::g_CoreStartupParameter.bTLBHack) {
@@ -159,7 +173,6 @@ void Jit64::stfd(UGeckoInstruction inst)
 	fpr.Lock(s);
 	gpr.BindToRegister(a, true, false);
 
-	s32 offset = (s32)(s16)inst.SIMM_16;
 	LEA(32, ABI_PARAM1, MDisp(gpr.R(a).GetSimpleReg(), offset));
 	TEST(32, R(ABI_PARAM1), Imm32(mem_mask));
 	FixupBranch safe = J_CC(CC_NZ);
@@ -168,12 +181,8 @@ void Jit64::stfd(UGeckoInstruction inst)
 	if (cpu_info.bSSSE3) {
 		MOVAPD(XMM0, fpr.R(s));
 		PSHUFB(XMM0, M((void*)bswapShuffle1x8));
-#ifdef _M_X64
-		MOVQ_xmm(MComplex(RBX, ABI_PARAM1, SCALE_1, 0), XMM0);
-#else
 		AND(32, R(ECX), Imm32(Memory::MEMVIEW32_MASK));
 		MOVQ_xmm(MDisp(ABI_PARAM1, (u32)Memory::base), XMM0);
-#endif
 	} else {
 		MOVAPD(XMM0, fpr.R(s));
 		MOVD_xmm(R(EAX), XMM0);
@@ -198,6 +207,7 @@ void Jit64::stfd(UGeckoInstruction inst)
 	SafeWriteRegToReg(EAX, ABI_PARAM1, 32, 4, RegistersInUse());
 
 	SetJumpTarget(exit);
+#endif
 
 	gpr.UnlockAll();
 	gpr.UnlockAllX();
@@ -304,24 +314,20 @@ void Jit64::lfsx(UGeckoInstruction inst)
 	{
 		ADD(32, R(EAX), gpr.R(inst.RA));
 	}
+#ifdef _M_IX86
 	if (cpu_info.bSSSE3 && !js.memcheck) {
 		fpr.Lock(inst.RS);
 		fpr.BindToRegister(inst.RS, false, true);
 		X64Reg r = fpr.R(inst.RS).GetSimpleReg();
-#ifdef _M_IX86
 		AND(32, R(EAX), Imm32(Memory::MEMVIEW32_MASK));
 		MOVD_xmm(r, MDisp(EAX, (u32)Memory::base));
-#else
-		MOVD_xmm(r, MComplex(RBX, EAX, SCALE_1, 0));
-#endif
-		MEMCHECK_START
-
 		PSHUFB(r, M((void *)bswapShuffle1x4));
 		CVTSS2SD(r, R(r));
 		MOVDDUP(r, R(r));
-
-		MEMCHECK_END
-	} else {
+	} else
+#endif
+	{
+		// On x64 this takes the same fastmem and backpatching path as lfs.
 		SafeLoadToReg(EAX, R(EAX), 32, 0, RegistersInUse(), false);
 
 		MEMCHECK_START
@@ -13,6 +13,7 @@
 #include "JitRegCache.h"
 
 const u8 GC_ALIGNED16(pbswapShuffle2x4[16]) = {3, 2, 1, 0, 7, 6, 5, 4, 8, 9, 10, 11, 12, 13, 14, 15};
+static const float GC_ALIGNED16(m_one[]) = {1.0f, 0.0f, 0.0f, 0.0f};
 
 // The big problem is likely instructions that set the quantizers in the same block.
 // We will have to break block after quantizers are written to.
@@ -48,6 +49,25 @@ void Jit64::psq_st(UGeckoInstruction inst)
 		MOV(32, gpr.R(a), R(ECX));
 	MOVZX(32, 16, EAX, M(&PowerPC::ppcState.spr[SPR_GQR0 + inst.I]));
 	MOVZX(32, 8, EDX, R(AL));
+#ifdef _M_X64
+	// Unquantized floats are stored inline, through the same fastmem and
+	// backpatching path as the integer stores. Only the other types go
+	// through the quantizing routines.
+	TEST(32, R(EDX), R(EDX));
+	FixupBranch quantized = J_CC(CC_NZ, true);
+	if (inst.W) {
+		CVTSD2SS(XMM0, fpr.R(s));
+		MOVD_xmm(R(EAX), XMM0);
+		SafeWriteRegToReg(EAX, ECX, 32, 0, RegistersInUse());
+	} else {
+		CVTPD2PS(XMM0, fpr.R(s));
+		MOVQ_xmm(R(RAX), XMM0);
+		ROL(64, R(RAX), Imm8(32));
+		SafeWriteRegToReg(RAX, ECX, 64, 0, RegistersInUse());
+	}
+	FixupBranch stored = J(true);
+	SetJumpTarget(quantized);
+#endif
 	// FIXME: Fix ModR/M encoding to allow [EDX*4+disp32] without a base register!
 #ifdef _M_IX86
 	int addr_scale = SCALE_4;
@@ -64,6 +84,9 @@ void Jit64::psq_st(UGeckoInstruction inst)
 		CVTPD2PS(XMM0, fpr.R(s));
 		CALLptr(MScaled(EDX, addr_scale, (u32)(u64)asm_routines.pairedStoreQuantized));
 	}
+#ifdef _M_X64
+	SetJumpTarget(stored);
+#endif
 	gpr.UnlockAll();
 	gpr.UnlockAllX();
 }
@@ -96,6 +119,22 @@ void Jit64::psq_l(UGeckoInstruction inst)
 		MOV(32, gpr.R(inst.RA), R(ECX));
 	MOVZX(32, 16, EAX, M(((char *)&GQR(inst.I)) + 2));
 	MOVZX(32, 8, EDX, R(AL));
+#ifdef _M_X64
+	// Same for the loads.
+	TEST(32, R(EDX), R(EDX));
+	FixupBranch quantized = J_CC(CC_NZ, true);
+	if (inst.W) {
+		SafeLoadToReg(ECX, R(ECX), 32, 0, RegistersInUse(), false);
+		MOVD_xmm(XMM0, R(ECX));
+		UNPCKLPS(XMM0, M((void*)m_one));
+	} else {
+		SafeLoadToReg(RCX, R(RCX), 64, 0, RegistersInUse(), false);
+		ROL(64, R(RCX), Imm8(32));
+		MOVQ_xmm(XMM0, R(RCX));
+	}
+	FixupBranch loaded = J(true);
+	SetJumpTarget(quantized);
+#endif
 	if (inst.W)
 		OR(32, R(EDX), Imm8(8));
 #ifdef _M_IX86
@@ -106,6 +145,9 @@ void Jit64::psq_l(UGeckoInstruction inst)
 	ABI_AlignStack(0);
 	CALLptr(MScaled(EDX, addr_scale, (u32)(u64)asm_routines.pairedLoadQuantized));
 	ABI_RestoreStack(0);
+#ifdef _M_X64
+	SetJumpTarget(loaded);
+#endif
 
 //	MEMCHECK_START // FIXME: MMU does not work here because of unsafe memory access
 
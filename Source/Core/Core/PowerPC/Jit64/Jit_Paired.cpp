@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "Common.h"
+#include "CPUDetect.h"
 
 #include "Jit.h"
 #include "JitRegCache.h"
@@ -35,8 +36,8 @@ void Jit64::ps_mr(UGeckoInstruction inst)
 
 void Jit64::ps_sel(UGeckoInstruction inst)
 {
-	// we can't use (V)BLENDVPD here because it just looks at the sign bit
-	// but we need -0 = +0
+	// we can't use (V)BLENDVPD on a directly because it just looks at the sign bit
+	// but we need -0 = +0; the compare mask below is fine though
 
 	INSTRUCTION_START
 	JITDISABLE(bJITPairedOff)
@@ -54,12 +55,22 @@ void Jit64::ps_sel(UGeckoInstruction inst)
 	XORPD(XMM1, R(XMM1));
 	// XMM0 = XMM0 < 0 ? all 1s : all 0s
 	CMPPD(XMM0, R(XMM1), LT);
-	MOVAPD(XMM1, R(XMM0));
-	ANDPD(XMM0, fpr.R(b));
-	ANDNPD(XMM1, fpr.R(c));
-	ORPD(XMM0, R(XMM1));
-	fpr.BindToRegister(d, false);
-	MOVAPD(fpr.RX(d), R(XMM0));
+	if (cpu_info.bSSE4_1)
+	{
+		MOVAPD(XMM1, fpr.R(c));
+		BLENDVPD(XMM1, fpr.R(b));
+		fpr.BindToRegister(d, false);
+		MOVAPD(fpr.RX(d), R(XMM1));
+	}
+	else
+	{
+		MOVAPD(XMM1, R(XMM0));
+		ANDPD(XMM0, fpr.R(b));
+		ANDNPD(XMM1, fpr.R(c));
+		ORPD(XMM0, R(XMM1));
+		fpr.BindToRegister(d, false);
+		MOVAPD(fpr.RX(d), R(XMM0));
+	}
 	fpr.UnlockAll();
 }
 
@@ -146,7 +157,8 @@ add a,b,a
 */
 
 //There's still a little bit more optimization that can be squeezed out of this
-void Jit64::tri_op(int d, int a, int b, bool reversible, void (XEmitter::*op)(X64Reg, OpArg))
+void Jit64::tri_op(int d, int a, int b, bool reversible, void (XEmitter::*op)(X64Reg, OpArg),
+                   void (XEmitter::*avxOp)(X64Reg, X64Reg, OpArg))
 {
 	fpr.Lock(d, a, b);
 
@@ -155,6 +167,12 @@ void Jit64::tri_op(int d, int a, int b, bool reversible, void (XEmitter::*op)(X6
 		fpr.BindToRegister(d, true);
 		(this->*op)(fpr.RX(d), fpr.R(b));
 	}
+	else if (cpu_info.bAVX && fpr.R(a).IsSimpleReg())
+	{
+		// No copy of a into d first, and none of b either when it is d.
+		fpr.BindToRegister(d, d == b);
+		(this->*avxOp)(fpr.RX(d), fpr.RX(a), fpr.R(b));
+	}
 	else if (d == b)
 	{
 		if (reversible)
@@ -190,10 +208,10 @@ void Jit64::ps_arith(UGeckoInstruction inst)
 	}
 	switch (inst.SUBOP5)
 	{
-	case 18: tri_op(inst.FD, inst.FA, inst.FB, false, &XEmitter::DIVPD); break; //div
-	case 20: tri_op(inst.FD, inst.FA, inst.FB, false, &XEmitter::SUBPD); break; //sub
-	case 21: tri_op(inst.FD, inst.FA, inst.FB, true,  &XEmitter::ADDPD); break; //add
-	case 25: tri_op(inst.FD, inst.FA, inst.FC, true, &XEmitter::MULPD); break; //mul
+	case 18: tri_op(inst.FD, inst.FA, inst.FB, false, &XEmitter::DIVPD, &XEmitter::VDIVPD); break; //div
+	case 20: tri_op(inst.FD, inst.FA, inst.FB, false, &XEmitter::SUBPD, &XEmitter::VSUBPD); break; //sub
+	case 21: tri_op(inst.FD, inst.FA, inst.FB, true,  &XEmitter::ADDPD, &XEmitter::VADDPD); break; //add
+	case 25: tri_op(inst.FD, inst.FA, inst.FC, true, &XEmitter::MULPD, &XEmitter::VMULPD); break; //mul
 	default:
 		_assert_msg_(DYNA_REC, 0, "ps_arith WTF!!!");
 	}
@@ -224,6 +242,15 @@ void Jit64::ps_sum(UGeckoInstruction inst)
 		MOVAPD(fpr.R(d), XMM0);
 		break;
 	case 11:
+		if (cpu_info.bSSE4_1)
+		{
+			// Sum the lower of a with both of b, then take c's lower back
+			MOVDDUP(XMM0, fpr.R(a));
+			ADDPD(XMM0, fpr.R(b));
+			BLENDPD(XMM0, fpr.R(c), 1);
+			MOVAPD(fpr.R(d), XMM0);
+			break;
+		}
 		// Do the sum in lower subregisters, merge lowers
 		MOVAPD(XMM0, fpr.R(a));
 		MOVAPD(XMM1, fpr.R(b));
@@ -257,23 +284,25 @@ void Jit64::ps_muls(UGeckoInstruction inst)
 	{
 	case 12:
 		// Single multiply scalar high
-		// TODO - faster version for when regs are different
-		MOVAPD(XMM0, fpr.R(a));
 		MOVDDUP(XMM1, fpr.R(c));
-		MULPD(XMM0, R(XMM1));
-		MOVAPD(fpr.R(d), XMM0);
 		break;
 	case 13:
-		// TODO - faster version for when regs are different
-		MOVAPD(XMM0, fpr.R(a));
 		MOVAPD(XMM1, fpr.R(c));
 		SHUFPD(XMM1, R(XMM1), 3); // copy higher to lower
-		MULPD(XMM0, R(XMM1));
-		MOVAPD(fpr.R(d), XMM0);
 		break;
 	default:
 		PanicAlert("ps_muls WTF!!!");
 	}
+	if (cpu_info.bAVX && fpr.R(a).IsSimpleReg())
+	{
+		VMULPD(fpr.RX(d), fpr.RX(a), R(XMM1));
+	}
+	else
+	{
+		MOVAPD(XMM0, fpr.R(a));
+		MULPD(XMM0, R(XMM1));
+		MOVAPD(fpr.R(d), XMM0);
+	}
 	ForceSinglePrecisionP(fpr.RX(d));
 	fpr.UnlockAll();
 }
@@ -292,6 +321,42 @@ void Jit64::ps_mergeXX(UGeckoInstruction inst)
 	int b = inst.FB;
 	fpr.Lock(a,b,d);
 
+	if (cpu_info.bAVX && fpr.R(a).IsSimpleReg())
+	{
+		fpr.BindToRegister(d, d == b);
+		switch (inst.SUBOP10)
+		{
+		case 528:
+			VUNPCKLPD(fpr.RX(d), fpr.RX(a), fpr.R(b));
+			break; //00
+		case 560:
+			VSHUFPD(fpr.RX(d), fpr.RX(a), fpr.R(b), 2);
+			break; //01
+		case 592:
+			VSHUFPD(fpr.RX(d), fpr.RX(a), fpr.R(b), 1);
+			break; //10
+		case 624:
+			VUNPCKHPD(fpr.RX(d), fpr.RX(a), fpr.R(b));
+			break; //11
+		default:
+			_assert_msg_(DYNA_REC, 0, "ps_merge - invalid op");
+		}
+		fpr.UnlockAll();
+		return;
+	}
+
+	// ps_merge01 keeps a half of each; blend the other half into d in place.
+	if (inst.SUBOP10 == 560 && cpu_info.bSSE4_1 && (d == a || d == b))
+	{
+		fpr.BindToRegister(d, true);
+		if (d == a)
+			BLENDPD(fpr.RX(d), fpr.R(b), 2);
+		else
+			BLENDPD(fpr.RX(d), fpr.R(a), 1);
+		fpr.UnlockAll();
+		return;
+	}
+
 	MOVAPD(XMM0, fpr.R(a));
 	switch (inst.SUBOP10)
 	{
@@ -330,35 +395,47 @@ void Jit64::ps_maddXX(UGeckoInstruction inst)
 	int d = inst.FD;
 	fpr.Lock(a,b,c,d);
 
-	MOVAPD(XMM0, fpr.R(a));
+	OpArg multiplier;
 	switch (inst.SUBOP5)
 	{
 	case 14: //madds0
 		MOVDDUP(XMM1, fpr.R(c));
-		MULPD(XMM0, R(XMM1));
-		ADDPD(XMM0, fpr.R(b));
+		multiplier = R(XMM1);
 		break;
 	case 15: //madds1
 		MOVAPD(XMM1, fpr.R(c));
 		SHUFPD(XMM1, R(XMM1), 3); // copy higher to lower
-		MULPD(XMM0, R(XMM1));
-		ADDPD(XMM0, fpr.R(b));
+		multiplier = R(XMM1);
 		break;
-	case 28: //msub
-		MULPD(XMM0, fpr.R(c));
-		SUBPD(XMM0, fpr.R(b));
+	default:
+		multiplier = fpr.R(c);
 		break;
+	}
+	if (cpu_info.bAVX && fpr.R(a).IsSimpleReg())
+	{
+		VMULPD(XMM0, fpr.RX(a), multiplier);
+	}
+	else
+	{
+		MOVAPD(XMM0, fpr.R(a));
+		MULPD(XMM0, multiplier);
+	}
+
+	switch (inst.SUBOP5)
+	{
+	case 14: //madds0
+	case 15: //madds1
 	case 29: //madd
-		MULPD(XMM0, fpr.R(c));
 		ADDPD(XMM0, fpr.R(b));
 		break;
+	case 28: //msub
+		SUBPD(XMM0, fpr.R(b));
+		break;
 	case 30: //nmsub
-		MULPD(XMM0, fpr.R(c));
 		SUBPD(XMM0, fpr.R(b));
 		XORPD(XMM0, M((void*)&psSignBits));
 		break;
 	case 31: //nmadd
-		MULPD(XMM0, fpr.R(c));
 		ADDPD(XMM0, fpr.R(b));
 		XORPD(XMM0, M((void*)&psSignBits));
 		break;
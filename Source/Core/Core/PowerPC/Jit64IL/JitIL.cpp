@@ -716,9 +716,11 @@ const u8* JitIL::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 
 	b->codeSize = (u32)(GetCodePtr() - normalEntry);
 	b->originalSize = size;
+	b->registersInUse.swap(registersInUseAtLoc);
+	registersInUseAtLoc.clear();
 
 #ifdef JIT_LOG_X86
-	LogGeneratedX86(size, code_buf, normalEntry, b);
+	LogGeneratedX86(size, code_buf->codebuffer, normalEntry, b);
 #endif
 
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITILOutputIR)
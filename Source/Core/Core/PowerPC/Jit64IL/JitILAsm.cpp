@@ -195,6 +195,8 @@ void JitILAsmRoutineManager::Generate()
 	RET();
 
 	GenerateCommon();
+
+	JitRegister::Register(enterCode, (u32)(GetCodePtr() - enterCode), "JIT_Dispatcher");
 }
 
 void JitILAsmRoutineManager::GenerateCommon()
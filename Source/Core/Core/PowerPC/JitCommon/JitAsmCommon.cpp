@@ -75,6 +75,17 @@ void CommonAsmRoutines::GenFifoXmm64Write()
 static const u8 GC_ALIGNED16(pbswapShuffle1x4[16]) = {3, 2, 1, 0, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
 static const u8 GC_ALIGNED16(pbswapShuffle2x4[16]) = {3, 2, 1, 0, 7, 6, 5, 4, 8, 9, 10, 11, 12, 13, 14, 15};
 
+// Two big endian integers, as loaded from memory, to a pair of s32s ready for
+// CVTDQ2PS. 0x80 zeroes the byte; the signed ones go to the top of each
+// dword, to be shifted back down arithmetically.
+static const u8 GC_ALIGNED16(pdequantizeShuffleU8[16]) = {0, 0x80, 0x80, 0x80, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80};
+static const u8 GC_ALIGNED16(pdequantizeShuffleS8[16]) = {0x80, 0x80, 0x80, 0, 0x80, 0x80, 0x80, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80};
+static const u8 GC_ALIGNED16(pdequantizeShuffleU16[16]) = {1, 0, 0x80, 0x80, 3, 2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80};
+static const u8 GC_ALIGNED16(pdequantizeShuffleS16[16]) = {0x80, 0x80, 1, 0, 0x80, 0x80, 3, 2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80};
+// And back: the low halves of two dwords, or two words, to big endian.
+static const u8 GC_ALIGNED16(pquantizeShuffleU16[16]) = {1, 0, 5, 4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80};
+static const u8 GC_ALIGNED16(pbswapShuffle2x2[16]) = {1, 0, 3, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
 static const float GC_ALIGNED16(m_quantizeTableS[]) =
 {
 	(1 <<  0),	(1 <<  1),	(1 <<  2),	(1 <<  3),
@@ -233,14 +244,18 @@ void CommonAsmRoutines::GenQuantizedStores()
 	MINPS(XMM0, R(XMM1));
 
 	CVTTPS2DQ(XMM0, R(XMM0));
-	MOVQ_xmm(M(psTemp), XMM0);
-	// place ps[0] into the higher word, ps[1] into the lower
-	// so no need in ROL after BSWAP
-	MOVZX(32, 16, EAX, M((char*)psTemp + 0));
-	SHL(32, R(EAX), Imm8(16));
-	MOV(16, R(AX), M((char*)psTemp + 4));
-
-	BSWAP(32, EAX);
+	if (cpu_info.bSSSE3) {
+		PSHUFB(XMM0, M((void *)pquantizeShuffleU16));
+		MOVD_xmm(R(EAX), XMM0);
+	} else {
+		MOVQ_xmm(M(psTemp), XMM0);
+		// place ps[0] into the higher word, ps[1] into the lower
+		// so no need in ROL after BSWAP
+		MOVZX(32, 16, EAX, M((char*)psTemp + 0));
+		SHL(32, R(EAX), Imm8(16));
+		MOV(16, R(AX), M((char*)psTemp + 4));
+		BSWAP(32, EAX);
+	}
 	SafeWriteRegToReg(EAX, ECX, 32, 0, QUANTIZED_REGS_TO_SAVE, SAFE_LOADSTORE_NO_SWAP | SAFE_LOADSTORE_NO_PROLOG | SAFE_LOADSTORE_NO_FASTMEM);
 
 	RET();
@@ -258,9 +273,14 @@ void CommonAsmRoutines::GenQuantizedStores()
 #endif
 	CVTTPS2DQ(XMM0, R(XMM0));
 	PACKSSDW(XMM0, R(XMM0));
-	MOVD_xmm(R(EAX), XMM0);
-	BSWAP(32, EAX);
-	ROL(32, R(EAX), Imm8(16));
+	if (cpu_info.bSSSE3) {
+		PSHUFB(XMM0, M((void *)pbswapShuffle2x2));
+		MOVD_xmm(R(EAX), XMM0);
+	} else {
+		MOVD_xmm(R(EAX), XMM0);
+		BSWAP(32, EAX);
+		ROL(32, R(EAX), Imm8(16));
+	}
 	SafeWriteRegToReg(EAX, ECX, 32, 0, QUANTIZED_REGS_TO_SAVE, SAFE_LOADSTORE_NO_SWAP | SAFE_LOADSTORE_NO_PROLOG | SAFE_LOADSTORE_NO_FASTMEM);
 
 	RET();
@@ -429,9 +449,13 @@ void CommonAsmRoutines::GenQuantizedLoads()
 	const u8* loadPairedU8Two = AlignCode4();
 	UnsafeLoadRegToRegNoSwap(ECX, ECX, 16, 0);
 	MOVD_xmm(XMM0, R(ECX));
-	PXOR(XMM1, R(XMM1));
-	PUNPCKLBW(XMM0, R(XMM1));
-	PUNPCKLWD(XMM0, R(XMM1));
+	if (cpu_info.bSSSE3) {
+		PSHUFB(XMM0, M((void *)pdequantizeShuffleU8));
+	} else {
+		PXOR(XMM1, R(XMM1));
+		PUNPCKLBW(XMM0, R(XMM1));
+		PUNPCKLWD(XMM0, R(XMM1));
+	}
 	CVTDQ2PS(XMM0, R(XMM0));
 	SHR(32, R(EAX), Imm8(6));
 	MOVSS(XMM1, MDisp(EAX, (u32)(u64)m_dequantizeTableS));
@@ -452,8 +476,12 @@ void CommonAsmRoutines::GenQuantizedLoads()
 	const u8* loadPairedS8Two = AlignCode4();
 	UnsafeLoadRegToRegNoSwap(ECX, ECX, 16, 0);
 	MOVD_xmm(XMM0, R(ECX));
-	PUNPCKLBW(XMM0, R(XMM0));
-	PUNPCKLWD(XMM0, R(XMM0));
+	if (cpu_info.bSSSE3) {
+		PSHUFB(XMM0, M((void *)pdequantizeShuffleS8));
+	} else {
+		PUNPCKLBW(XMM0, R(XMM0));
+		PUNPCKLWD(XMM0, R(XMM0));
+	}
 	PSRAD(XMM0, 24);
 	CVTDQ2PS(XMM0, R(XMM0));
 	SHR(32, R(EAX), Imm8(6));
@@ -475,11 +503,21 @@ void CommonAsmRoutines::GenQuantizedLoads()
 	RET();
 
 	const u8* loadPairedU16Two = AlignCode4();
-	UnsafeLoadRegToReg(ECX, ECX, 32, 0, false);
-	ROL(32, R(ECX), Imm8(16));
-	MOVD_xmm(XMM0, R(ECX));
-	PXOR(XMM1, R(XMM1));
-	PUNPCKLWD(XMM0, R(XMM1));
+	if (cpu_info.bSSSE3) {
+#ifdef _M_X64
+		MOVD_xmm(XMM0, MComplex(RBX, RCX, 1, 0));
+#else
+		AND(32, R(ECX), Imm32(Memory::MEMVIEW32_MASK));
+		MOVD_xmm(XMM0, MDisp(ECX, (u32)Memory::base));
+#endif
+		PSHUFB(XMM0, M((void *)pdequantizeShuffleU16));
+	} else {
+		UnsafeLoadRegToReg(ECX, ECX, 32, 0, false);
+		ROL(32, R(ECX), Imm8(16));
+		MOVD_xmm(XMM0, R(ECX));
+		PXOR(XMM1, R(XMM1));
+		PUNPCKLWD(XMM0, R(XMM1));
+	}
 	CVTDQ2PS(XMM0, R(XMM0));
 	SHR(32, R(EAX), Imm8(6));
 	MOVSS(XMM1, MDisp(EAX, (u32)(u64)m_dequantizeTableS));
@@ -499,10 +537,20 @@ void CommonAsmRoutines::GenQuantizedLoads()
 	RET();
 
 	const u8* loadPairedS16Two = AlignCode4();
-	UnsafeLoadRegToReg(ECX, ECX, 32, 0, false);
-	ROL(32, R(ECX), Imm8(16));
-	MOVD_xmm(XMM0, R(ECX));
-	PUNPCKLWD(XMM0, R(XMM0));
+	if (cpu_info.bSSSE3) {
+#ifdef _M_X64
+		MOVD_xmm(XMM0, MComplex(RBX, RCX, 1, 0));
+#else
+		AND(32, R(ECX), Imm32(Memory::MEMVIEW32_MASK));
+		MOVD_xmm(XMM0, MDisp(ECX, (u32)Memory::base));
+#endif
+		PSHUFB(XMM0, M((void *)pdequantizeShuffleS16));
+	} else {
+		UnsafeLoadRegToReg(ECX, ECX, 32, 0, false);
+		ROL(32, R(ECX), Imm8(16));
+		MOVD_xmm(XMM0, R(ECX));
+		PUNPCKLWD(XMM0, R(XMM0));
+	}
 	PSRAD(XMM0, 16);
 	CVTDQ2PS(XMM0, R(XMM0));
 	SHR(32, R(EAX), Imm8(6));
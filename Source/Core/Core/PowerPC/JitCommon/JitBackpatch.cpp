@@ -73,6 +73,9 @@ const u8 *TrampolineCache::GetReadTrampoline(const InstructionInfo &info, u32 re
 	ABI_PushRegistersAndAdjustStack(registersInUse, true);
 	switch (info.operandSize)
 	{
+	case 8:
+		CALL((void *)&Memory::Read_U64);
+		break;
 	case 4:
 		CALL((void *)&Memory::Read_U32);
 		break;
@@ -87,7 +90,7 @@ const u8 *TrampolineCache::GetReadTrampoline(const InstructionInfo &info, u32 re
 
 	if (dataReg != EAX)
 	{
-		MOV(32, R(dataReg), R(EAX));
+		MOV(info.operandSize == 8 ? 64 : 32, R(dataReg), R(EAX));
 	}
 
 	ABI_PopRegistersAndAdjustStack(registersInUse, true);
@@ -185,15 +188,13 @@ const u8 *Jitx86Base::BackPatch(u8 *codePtr, u32 emAddress, void *ctx_void)
 		return 0;
 	}
 
-	auto it = registersInUseAtLoc.find(codePtr);
-	if (it == registersInUseAtLoc.end())
+	u32 registersInUse;
+	if (!blocks.GetRegistersInUse(codePtr, &registersInUse))
 	{
 		PanicAlert("BackPatch: no register use entry for address %p", codePtr);
 		return 0;
 	}
 
-	u32 registersInUse = it->second;
-
 	if (!info.isMemoryWrite)
 	{
 		XEmitter emitter(codePtr);
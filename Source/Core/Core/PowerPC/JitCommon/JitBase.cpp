@@ -24,14 +24,14 @@ u32 Helper_Mask(u8 mb, u8 me)
 		);
 }
 
-void LogGeneratedX86(int size, PPCAnalyst::CodeBuffer *code_buffer, const u8 *normalEntry, JitBlock *b)
+void LogGeneratedX86(int size, const PPCAnalyst::CodeOp *ops, const u8 *normalEntry, JitBlock *b)
 {
 	char pDis[1000] = "";
 
 	for (int i = 0; i < size; i++)
 	{
 		char temp[256] = "";
-		const PPCAnalyst::CodeOp &op = code_buffer->codebuffer[i];
+		const PPCAnalyst::CodeOp &op = ops[i];
 		DisassembleGekko(op.inst.hex, op.address, temp, 256);
 		sprintf(pDis, "%08x %s", op.address, temp);
 		DEBUG_LOG(DYNA_REC,"IR_X86 PPC: %s\n", pDis);
@@ -47,6 +47,12 @@ protected:
 		bool optimizeGatherPipe;
 		bool fastInterrupts;
 		bool accurateSinglePrecision;
+		bool tieredCompilation;
+		bool backgroundCompile;
+		bool registerLiveness;
+		bool blockEviction;
+		bool traceFormation;
+		bool constantAddresses;
 	};
 	struct JitState
 	{
@@ -58,6 +64,8 @@ protected:
 		int blockSize;
 		int instructionNumber;
 		int downcountAmount;
+		// GPRs that may be read after the final exit of the block.
+		u32 exitLiveGPRs;
 		u32 numLoadStoreInst;
 		u32 numFloatingPointInst;
 
@@ -96,6 +104,9 @@ public:
 	virtual const CommonAsmRoutinesBase *GetAsmRoutines() = 0;
 
 	virtual bool IsInCodeSpace(u8 *ptr) = 0;
+
+	// The code in this range changed (icbi and friends).
+	virtual void InvalidateICache(u32 address, u32 length) { GetBlockCache()->InvalidateICache(address, length); }
 };
 
 class Jitx86Base : public JitBase, public EmuCodeBlock
@@ -117,4 +128,4 @@ void Jit(u32 em_address);
 
 // Merged routines that should be moved somewhere better
 u32 Helper_Mask(u8 mb, u8 me);
-void LogGeneratedX86(int size, PPCAnalyst::CodeBuffer *code_buffer, const u8 *normalEntry, JitBlock *b);
+void LogGeneratedX86(int size, const PPCAnalyst::CodeOp *ops, const u8 *normalEntry, JitBlock *b);
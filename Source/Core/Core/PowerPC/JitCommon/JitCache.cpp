@@ -9,6 +9,9 @@
 // performance hit, it's not enabled by default, but it's useful for
 // locating performance issues.
 
+#include <algorithm>
+#include <functional>
+
 #include "Common.h"
 
 #ifdef _WIN32
@@ -16,6 +19,7 @@
 #endif
 
 #include "JitBase.h"
+#include "JitRegister.h"
 #include "MemoryUtil.h"
 #include "disasm.h"
 
@@ -33,11 +37,17 @@ op_agent_t agent;
 #pragma comment(lib, "jitprofiling.lib")
 #endif
 
+#ifdef JIT_RECORD_BLOCK_EVENTS
+#include "FileUtil.h"
+
+static File::IOFile s_block_events("JitBlockEvents.txt", "w");
+#endif
+
 using namespace Gen;
 
 	bool JitBaseBlockCache::IsFull() const
 	{
-		return GetNumBlocks() >= MAX_NUM_BLOCKS - 1;
+		return GetNumBlocks() >= MAX_NUM_BLOCKS - 1 && free_blocks.empty();
 	}
 
 	void JitBaseBlockCache::Init()
@@ -103,13 +113,15 @@ using namespace Gen;
 			Core::DisplayMessage("Clearing code cache.", 3000);
 #endif
 
+		links_to.clear();
+		block_map.clear();
+		registers_in_use.clear();
 		for (int i = 0; i < num_blocks; i++)
 		{
 			DestroyBlock(i, false);
 		}
-		links_to.clear();
-		block_map.clear();
 		valid_block.reset();
+		free_blocks.clear();
 		num_blocks = 0;
 		memset(blockCodePointers, 0, sizeof(u8*)*MAX_NUM_BLOCKS);
 	}
@@ -162,12 +174,30 @@ using namespace Gen;
 
 	int JitBaseBlockCache::AllocateBlock(u32 em_address)
 	{
-		JitBlock &b = blocks[num_blocks];
+		int block_num;
+		if (!free_blocks.empty())
+		{
+			block_num = free_blocks.back();
+			free_blocks.pop_back();
+		}
+		else
+		{
+			block_num = num_blocks++; //commit the current block
+		}
+		JitBlock &b = blocks[block_num];
+		b.checkedEntry = NULL;
 		b.invalid = false;
 		b.originalAddress = em_address;
+		b.dependencySize = 0;
 		b.linkData.clear();
-		num_blocks++; //commit the current block
-		return num_blocks - 1;
+		b.registersInUse.clear();
+		return block_num;
+	}
+
+	void JitBaseBlockCache::ReleaseBlock(int block_num)
+	{
+		blocks[block_num].invalid = true;
+		FreeBlock(block_num);
 	}
 
 	void JitBaseBlockCache::FinalizeBlock(int block_num, bool block_link, const u8 *code_ptr)
@@ -183,18 +213,44 @@ using namespace Gen;
 		for (u32 i = 0; i < (b.originalSize + 7) / 8; ++i)
 			valid_block[pAddr / 32 + i] = true;
 
-		block_map[std::make_pair(pAddr + 4 * b.originalSize - 1, pAddr)] = block_num;
+		u32 start, end;
+		GetBlockRange(block_num, &start, &end);
+		if (b.dependencySize)
+		{
+			for (u32 i = start / 32; i <= end / 32; ++i)
+				valid_block[i] = true;
+		}
+		BlockRange range = {start, end, block_num};
+		for (u32 page = start >> BLOCK_MAP_PAGE_SHIFT; page <= end >> BLOCK_MAP_PAGE_SHIFT; page++)
+			block_map[page].push_back(range);
+
+		for (const auto& e : b.registersInUse)
+			registers_in_use[e.first] = e.second;
+
 		if (block_link)
 		{
 			for (const auto& e : b.linkData)
 			{
-				links_to.insert(std::pair<u32, int>(e.exitAddress, block_num));
+				links_to[e.exitAddress].push_back(block_num);
 			}
 
 			LinkBlock(block_num);
 			LinkBlockExits(block_num);
 		}
 
+#ifdef JIT_RECORD_BLOCK_EVENTS
+		fprintf(s_block_events.GetHandle(), "c %08x %u", b.originalAddress, b.originalSize);
+		for (const auto& e : b.linkData)
+			fprintf(s_block_events.GetHandle(), " %08x", e.exitAddress);
+		fprintf(s_block_events.GetHandle(), "\n");
+#endif
+
+		if (b.checkedEntry <= b.normalEntry)
+		{
+			JitRegister::Register(b.checkedEntry, (u32)(b.normalEntry + b.codeSize - b.checkedEntry),
+			                      "JIT_PPC_%08x", b.originalAddress);
+		}
+
 #if defined USE_OPROFILE && USE_OPROFILE
 		char buf[100];
 		sprintf(buf, "EmuCode%x", b.originalAddress);
@@ -226,11 +282,11 @@ using namespace Gen;
 	u32* JitBaseBlockCache::GetICachePtr(u32 addr)
 	{
 		if (addr & JIT_ICACHE_VMEM_BIT)
-			return (u32*)(jit->GetBlockCache()->iCacheVMEM + (addr & JIT_ICACHE_MASK));
+			return (u32*)(iCacheVMEM + (addr & JIT_ICACHE_MASK));
 		else if (addr & JIT_ICACHE_EXRAM_BIT)
-			return (u32*)(jit->GetBlockCache()->iCacheEx + (addr & JIT_ICACHEEX_MASK));
+			return (u32*)(iCacheEx + (addr & JIT_ICACHEEX_MASK));
 		else
-			return (u32*)(jit->GetBlockCache()->iCache + (addr & JIT_ICACHE_MASK));
+			return (u32*)(iCache + (addr & JIT_ICACHE_MASK));
 	}
 
 	int JitBaseBlockCache::GetBlockNumberFromStartAddress(u32 addr)
@@ -253,6 +309,15 @@ using namespace Gen;
 		return (CompiledCode)blockCodePointers[block_num];
 	}
 
+	bool JitBaseBlockCache::GetRegistersInUse(const u8 *code, u32 *registers) const
+	{
+		auto it = registers_in_use.find(code);
+		if (it == registers_in_use.end())
+			return false;
+		*registers = it->second;
+		return true;
+	}
+
 	//Block linker
 	//Make sure to have as many blocks as possible compiled before calling this
 	//It's O(N), so it's fast :)
@@ -281,40 +346,84 @@ using namespace Gen;
 		}
 	}
 
-	using namespace std;
-
 	void JitBaseBlockCache::LinkBlock(int i)
 	{
 		LinkBlockExits(i);
 		JitBlock &b = blocks[i];
-		pair<multimap<u32, int>::iterator, multimap<u32, int>::iterator> ppp;
-		// equal_range(b) returns pair<iterator,iterator> representing the range
-		// of element with key b
-		ppp = links_to.equal_range(b.originalAddress);
-		if (ppp.first == ppp.second)
+		auto it = links_to.find(b.originalAddress);
+		if (it == links_to.end())
 			return;
-		for (multimap<u32, int>::iterator iter = ppp.first; iter != ppp.second; ++iter) {
-			// PanicAlert("Linking block %i to block %i", iter->second, i);
-			LinkBlockExits(iter->second);
+		for (int source : it->second)
+		{
+			// PanicAlert("Linking block %i to block %i", source, i);
+			LinkBlockExits(source);
 		}
 	}
 
 	void JitBaseBlockCache::UnlinkBlock(int i)
 	{
 		JitBlock &b = blocks[i];
-		pair<multimap<u32, int>::iterator, multimap<u32, int>::iterator> ppp;
-		ppp = links_to.equal_range(b.originalAddress);
-		if (ppp.first == ppp.second)
+		auto it = links_to.find(b.originalAddress);
+		if (it == links_to.end())
 			return;
-		for (multimap<u32, int>::iterator iter = ppp.first; iter != ppp.second; ++iter) {
-			JitBlock &sourceBlock = blocks[iter->second];
+		std::vector<int> &sources = it->second;
+		for (int source : sources)
+		{
+			JitBlock &sourceBlock = blocks[source];
 			for (auto& e : sourceBlock.linkData)
 			{
 				if (e.exitAddress == b.originalAddress)
 					e.linkStatus = false;
 			}
 		}
-		links_to.erase(b.originalAddress);
+
+		// Live sources stay registered, so that they are linked to the block
+		// compiled next at this address (e.g. when a block tiers up).
+		sources.erase(std::remove_if(sources.begin(), sources.end(),
+			[this](int source) { return blocks[source].invalid; }), sources.end());
+		if (sources.empty())
+			links_to.erase(it);
+	}
+
+	// The physical range the block map tracks for a block. Blocks that failed
+	// to fetch their first instruction still cover that one instruction.
+	// Code the block depends on is folded in, gaps and all.
+	void JitBaseBlockCache::GetBlockRange(int block_num, u32 *start, u32 *end) const
+	{
+		const JitBlock &b = blocks[block_num];
+		*start = b.originalAddress & 0x1FFFFFFF;
+		*end = *start + 4 * std::max<u32>(b.originalSize, 1) - 1;
+		if (b.dependencySize)
+		{
+			u32 dep_start = b.dependencyAddress & 0x1FFFFFFF;
+			*start = std::min(*start, dep_start);
+			*end = std::max(*end, dep_start + b.dependencySize - 1);
+		}
+	}
+
+	void JitBaseBlockCache::RemoveBlockFromMap(int block_num)
+	{
+		u32 start, end;
+		GetBlockRange(block_num, &start, &end);
+		for (u32 page = start >> BLOCK_MAP_PAGE_SHIFT; page <= end >> BLOCK_MAP_PAGE_SHIFT; page++)
+		{
+			auto it = block_map.find(page);
+			if (it == block_map.end())
+				continue;
+
+			std::vector<BlockRange> &bucket = it->second;
+			for (size_t i = 0; i < bucket.size(); i++)
+			{
+				if (bucket[i].block_num == block_num)
+				{
+					bucket[i] = bucket.back();
+					bucket.pop_back();
+					break;
+				}
+			}
+			if (bucket.empty())
+				block_map.erase(it);
+		}
 	}
 
 	void JitBaseBlockCache::DestroyBlock(int block_num, bool invalidate)
@@ -334,6 +443,7 @@ using namespace Gen;
 		b.invalid = true;
 		*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
 
+		RemoveBlockFromMap(block_num);
 		UnlinkBlock(block_num);
 
 		// Send anyone who tries to run this block back to the dispatcher.
@@ -342,11 +452,100 @@ using namespace Gen;
 		WriteDestroyBlock(b.checkedEntry, b.originalAddress);
 	}
 
+	// The slot is marked free by having no code.
+	void JitBaseBlockCache::FreeBlock(int block_num)
+	{
+		JitBlock &b = blocks[block_num];
+		for (const auto& e : b.linkData)
+		{
+			auto it = links_to.find(e.exitAddress);
+			if (it == links_to.end())
+				continue;
+			std::vector<int> &sources = it->second;
+			sources.erase(std::remove(sources.begin(), sources.end(), block_num), sources.end());
+			if (sources.empty())
+				links_to.erase(it);
+		}
+		b.linkData.clear();
+		// Released slots never got theirs in.
+		if (blockCodePointers[block_num])
+		{
+			for (const auto& e : b.registersInUse)
+				registers_in_use.erase(e.first);
+		}
+		b.registersInUse.clear();
+		b.checkedEntry = NULL;
+		b.runCount = 0;
+		blockCodePointers[block_num] = NULL;
+		free_blocks.push_back(block_num);
+	}
+
+	void JitBaseBlockCache::EvictCode(const u8 *start, const u8 *end, u32 min_run_count, std::vector<u32> &hot)
+	{
+		// Blocks destroyed earlier are freed along with the live ones, their
+		// code was only kept for the stub at the entry.
+		std::vector<std::pair<u32, u32>> hot_blocks;
+		int evicted = 0;
+		for (int i = 0; i < num_blocks; i++)
+		{
+			JitBlock &b = blocks[i];
+			if (!b.checkedEntry || b.checkedEntry < start || b.checkedEntry >= end)
+				continue;
+
+			if (!b.invalid)
+			{
+				if ((u32)b.runCount >= min_run_count)
+					hot_blocks.push_back(std::make_pair((u32)b.runCount, b.originalAddress));
+				b.invalid = true;
+				*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
+				RemoveBlockFromMap(i);
+				evicted++;
+			}
+			FreeBlock(i);
+		}
+
+		// Exits that were linked to an evicted block, and those that jump to the
+		// stub of a destroyed one, go back to the dispatcher. The stubs may be
+		// gone, so that's done for every exit that isn't linked to a live block.
+		// The sources stay in links_to, to be linked again if the block returns.
+		for (int i = 0; i < num_blocks; i++)
+		{
+			JitBlock &b = blocks[i];
+			if (b.invalid || !b.checkedEntry)
+				continue;
+
+			for (auto& e : b.linkData)
+			{
+				if (e.linkStatus && GetBlockNumberFromStartAddress(e.exitAddress) >= 0)
+					continue;
+				WriteDestroyBlock(e.exitPtrs, e.exitAddress);
+				e.linkStatus = false;
+			}
+			b.runCount = 0;
+		}
+
+		std::sort(hot_blocks.begin(), hot_blocks.end(), std::greater<std::pair<u32, u32>>());
+		hot.clear();
+		for (const auto& block : hot_blocks)
+			hot.push_back(block.second);
+
+		num_evictions++;
+		num_evicted_blocks += evicted;
+	}
+
 	void JitBaseBlockCache::InvalidateICache(u32 address, const u32 length)
 	{
 		// Convert the logical address to a physical address for the block map
 		u32 pAddr = address & 0x1FFFFFFF;
 
+#ifdef JIT_RECORD_BLOCK_EVENTS
+		fprintf(s_block_events.GetHandle(), "i %08x %u\n", address, length);
+#endif
+
+		// Blocks stored by a previous session may become valid again now
+		disk_cache.InvalidateRange(address, length);
+		PPCAnalyst::InvalidateLiveness(address, length);
+
 		// Optimize the common case of length == 32 which is used by Interpreter::dcb*
 		bool destroy_block = true;
 		if (length == 32)
@@ -358,20 +557,29 @@ using namespace Gen;
 		}
 
 		// destroy JIT blocks
-		// !! this works correctly under assumption that any two overlapping blocks end at the same address
-		if (destroy_block)
+		if (destroy_block && length)
 		{
-			std::map<pair<u32,u32>, u32>::iterator it1 = block_map.lower_bound(std::make_pair(pAddr, 0)), it2 = it1;
-			while (it2 != block_map.end() && it2->first.second < pAddr + length)
-		{
-				JitBlock &b = blocks[it2->second];
-				*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
-				DestroyBlock(it2->second, true);
-				++it2;
+			// Physical addresses end at 0x1FFFFFFF, stop there rather than wrap.
+			u32 pEnd = length - 1 > 0x1FFFFFFF - pAddr ? 0x1FFFFFFF : pAddr + length - 1;
+
+			// Collect first, destroying a block removes it from every page it covers.
+			std::vector<int> victims;
+			for (u32 page = pAddr >> BLOCK_MAP_PAGE_SHIFT; page <= pEnd >> BLOCK_MAP_PAGE_SHIFT; page++)
+			{
+				auto it = block_map.find(page);
+				if (it == block_map.end())
+					continue;
+				for (const BlockRange& range : it->second)
+				{
+					if (range.start <= pEnd && range.end >= pAddr)
+						victims.push_back(range.block_num);
+				}
 			}
-			if (it1 != it2)
+
+			for (int block_num : victims)
 			{
-				block_map.erase(it1, it2);
+				if (!blocks[block_num].invalid)
+					DestroyBlock(block_num, true);
 			}
 		}
 
@@ -386,17 +594,17 @@ using namespace Gen;
 		if (address & JIT_ICACHE_VMEM_BIT)
 		{
 			u32 cacheaddr = address & JIT_ICACHE_MASK;
-			memset(iCacheVMEM + cacheaddr, JIT_ICACHE_INVALID_BYTE, length);
+			memset(iCacheVMEM + cacheaddr, JIT_ICACHE_INVALID_BYTE, std::min<u32>(length, JIT_ICACHE_SIZE - cacheaddr));
 		}
 		else if (address & JIT_ICACHE_EXRAM_BIT)
 		{
 			u32 cacheaddr = address & JIT_ICACHEEX_MASK;
-			memset(iCacheEx + cacheaddr, JIT_ICACHE_INVALID_BYTE, length);
+			memset(iCacheEx + cacheaddr, JIT_ICACHE_INVALID_BYTE, std::min<u32>(length, JIT_ICACHEEX_SIZE - cacheaddr));
 		}
 		else
 		{
 			u32 cacheaddr = address & JIT_ICACHE_MASK;
-			memset(iCache + cacheaddr, JIT_ICACHE_INVALID_BYTE, length);
+			memset(iCache + cacheaddr, JIT_ICACHE_INVALID_BYTE, std::min<u32>(length, JIT_ICACHE_SIZE - cacheaddr));
 		}
 	}
 	void JitBlockCache::WriteLinkBlock(u8* location, const u8* address)
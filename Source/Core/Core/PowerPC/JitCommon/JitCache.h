@@ -5,9 +5,10 @@
 #pragma once
 
 #include <bitset>
-#include <map>
+#include <unordered_map>
 #include <vector>
 
+#include "JitDiskCache.h"
 #include "../Gekko.h"
 #include "../PPCAnalyst.h"
 
@@ -15,6 +16,10 @@
 // Add the VTune include/lib directories to the project directories to get this to build.
 // #define USE_VTUNE
 
+// Define this to log every block compile and icache invalidation to
+// JitBlockEvents.txt, which Source/UnitTests can replay as a benchmark.
+// #define JIT_RECORD_BLOCK_EVENTS
+
 // emulate CPU with unlimited instruction cache
 // the only way to invalidate a region is the "icbi" instruction
 #define JIT_UNLIMITED_ICACHE
@@ -37,7 +42,12 @@ struct JitBlock
 	u32 originalAddress;
 	u32 codeSize;
 	u32 originalSize;
+	// Code outside the block that its code generation relied on, such as the
+	// function exit liveness was taken from. Changing it destroys the block.
+	u32 dependencyAddress;
+	u32 dependencySize; // in bytes, 0 if none
 	int runCount;  // for profiling.
+	int tierUpCount; // runs left before a baseline block gets recompiled.
 	int flags;
 
 	bool invalid;
@@ -49,13 +59,14 @@ struct JitBlock
 	};
 	std::vector<LinkData> linkData;
 
-#ifdef _WIN32
+	// Registers in use at each fastmem access, for the backpatcher.
+	std::vector<std::pair<const u8 *, u32>> registersInUse;
+
 	// we don't really need to save start and stop
 	// TODO (mb2): ticStart and ticStop -> "local var" mean "in block" ... low priority ;)
 	u64 ticStart;		// for profiling - time.
 	u64 ticStop;		// for profiling - time.
 	u64 ticCounter;	// for profiling - time.
-#endif
 
 #ifdef USE_VTUNE
 	char blockName[32];
@@ -67,21 +78,43 @@ typedef void (*CompiledCode)();
 
 class JitBaseBlockCache
 {
+	// Physical address range of a block, as stored in the page buckets.
+	struct BlockRange
+	{
+		u32 start;
+		u32 end; // inclusive
+		int block_num;
+	};
+
+	enum
+	{
+		MAX_NUM_BLOCKS = 65536*2,
+		BLOCK_MAP_PAGE_SHIFT = 12,
+	};
+
 	const u8 **blockCodePointers;
 	JitBlock *blocks;
 	int num_blocks;
-	std::multimap<u32, int> links_to;
-	std::map<std::pair<u32,u32>, u32> block_map; // (end_addr, start_addr) -> number
+	// exit address -> blocks that have an exit to it
+	std::unordered_map<u32, std::vector<int>> links_to;
+	// physical page -> ranges of all blocks that overlap the page
+	std::unordered_map<u32, std::vector<BlockRange>> block_map;
 	std::bitset<0x20000000 / 32> valid_block;
-	enum
-	{
-		MAX_NUM_BLOCKS = 65536*2
-	};
+	// fastmem access -> registers in use there, for the finalized blocks
+	std::unordered_map<const u8 *, u32> registers_in_use;
+	JitDiskCache disk_cache;
+	// Slots of evicted blocks, reused before new ones.
+	std::vector<int> free_blocks;
+	int num_evictions;
+	int num_evicted_blocks;
 
 	bool RangeIntersect(int s1, int e1, int s2, int e2) const;
 	void LinkBlockExits(int i);
 	void LinkBlock(int i);
 	void UnlinkBlock(int i);
+	void GetBlockRange(int block_num, u32 *start, u32 *end) const;
+	void RemoveBlockFromMap(int block_num);
+	void FreeBlock(int block_num);
 
 	// Virtual for overloaded
 	virtual void WriteLinkBlock(u8* location, const u8* address) = 0;
@@ -90,9 +123,12 @@ class JitBaseBlockCache
 public:
 	JitBaseBlockCache() :
 		blockCodePointers(0), blocks(0), num_blocks(0),
+		num_evictions(0), num_evicted_blocks(0),
 		iCache(0), iCacheEx(0), iCacheVMEM(0) {}
 	int AllocateBlock(u32 em_address);
 	void FinalizeBlock(int block_num, bool block_link, const u8 *code_ptr);
+	// Hands back a slot from AllocateBlock whose block won't be finalized.
+	void ReleaseBlock(int block_num);
 
 	void Clear();
 	void ClearSafe();
@@ -112,16 +148,30 @@ public:
 
 	u32* GetICachePtr(u32 addr);
 
+	JitDiskCache &GetDiskCache() { return disk_cache; }
+
 	// Fast way to get a block. Only works on the first ppc instruction of a block.
 	int GetBlockNumberFromStartAddress(u32 em_address);
 
 	u32 GetOriginalFirstOp(int block_num);
+
+	// Finds the registers in use at a fastmem access of a finalized block.
+	bool GetRegistersInUse(const u8 *code, u32 *registers) const;
 	CompiledCode GetCompiledCodeFromBlock(int block_num);
 
 	// DOES NOT WORK CORRECTLY WITH INLINING
 	void InvalidateICache(u32 address, const u32 length);
 	void DestroyBlock(int block_num, bool invalidate);
 
+	// Throws out every block whose code lies in [start, end) and frees its
+	// slot, so that the code space can be reused. Exits of other blocks that
+	// jump in there go back to the dispatcher. Returns the addresses of the
+	// evicted blocks that ran at least min_run_count times, hottest first.
+	// Run counts start over for the blocks that stay.
+	void EvictCode(const u8 *start, const u8 *end, u32 min_run_count, std::vector<u32> &hot);
+	int GetNumEvictions() const { return num_evictions; }
+	int GetNumEvictedBlocks() const { return num_evicted_blocks; }
+
 	// Not currently used
 	//void DestroyBlocksWithFlag(BlockFlag death_flag);
 };
@@ -0,0 +1,95 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "FileUtil.h"
+#include "Hash.h"
+#include "JitDiskCache.h"
+
+void JitDiskCache::Init(const std::string& game_id)
+{
+	m_known.clear();
+	m_pending.clear();
+	m_retry.clear();
+
+	if (!File::Exists(File::GetUserPath(D_CACHE_IDX)))
+		File::CreateDir(File::GetUserPath(D_CACHE_IDX).c_str());
+
+	std::string filename = File::GetUserPath(D_CACHE_IDX) + "jit-" + game_id + ".cache";
+	u32 num_entries = m_file.OpenAndRead(filename.c_str(), *this);
+	INFO_LOG(DYNA_REC, "Loaded %u JIT blocks to warm up from %s", num_entries, filename.c_str());
+	m_enabled = true;
+}
+
+void JitDiskCache::Shutdown()
+{
+	if (!m_enabled)
+		return;
+
+	m_file.Sync();
+	m_file.Close();
+	m_enabled = false;
+	m_known.clear();
+	m_pending.clear();
+	m_retry.clear();
+}
+
+void JitDiskCache::Read(const JitDiskCacheKey &key, const u8 *value, u32 value_size)
+{
+	m_known.insert(std::make_pair(key.address, key.hash));
+	m_pending.insert(std::make_pair(key.address, key));
+	m_retry.insert(key.address);
+}
+
+JitDiskCacheKey JitDiskCache::ComputeKey(u32 address, const PPCAnalyst::CodeOp *ops, int num_ops)
+{
+	// Hash the address along with each instruction, merged blocks aren't contiguous.
+	std::vector<u32> code(num_ops * 2);
+	for (int i = 0; i < num_ops; i++)
+	{
+		code[i * 2] = ops[i].address;
+		code[i * 2 + 1] = ops[i].inst.hex;
+	}
+
+	JitDiskCacheKey key;
+	key.address = address;
+	key.numInstructions = num_ops;
+	key.hash = num_ops ? GetMurmurHash3((const u8*)&code[0], num_ops * 8, 0) : 0;
+	return key;
+}
+
+void JitDiskCache::RecordBlock(const JitDiskCacheKey &key)
+{
+	if (!m_enabled || !key.numInstructions)
+		return;
+
+	if (m_known.insert(std::make_pair(key.address, key.hash)).second)
+		m_file.Append(key, NULL, 0);
+}
+
+void JitDiskCache::InvalidateRange(u32 address, u32 length)
+{
+	if (m_pending.empty() || length == 0)
+		return;
+
+	// Compare offsets, address + length wraps for ranges at the top of the address space.
+	for (auto it = m_pending.lower_bound(address); it != m_pending.end() && it->first - address < length; ++it)
+		m_retry.insert(it->first);
+}
+
+void JitDiskCache::TakeBlocksToWarm(std::vector<JitDiskCacheKey> &out)
+{
+	for (u32 address : m_retry)
+	{
+		auto range = m_pending.equal_range(address);
+		for (auto it = range.first; it != range.second; ++it)
+			out.push_back(it->second);
+	}
+	m_retry.clear();
+}
+
+void JitDiskCache::MarkWarmed(u32 address)
+{
+	m_pending.erase(address);
+	m_retry.erase(address);
+}
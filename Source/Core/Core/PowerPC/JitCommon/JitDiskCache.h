@@ -0,0 +1,66 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "LinearDiskCache.h"
+#include "../PPCAnalyst.h"
+
+// Persistent, per-game record of the blocks the JIT has compiled.
+//
+// Emitted x86 code can't be reused across sessions as-is: it embeds absolute
+// pointers to ppcState, the dispatcher and the trampolines, all of which move
+// between runs. Instead we store where each block started and a hash of the
+// PPC code it was compiled from (as fetched through the instruction cache).
+// On the next boot the JIT recompiles every stored block whose code still
+// hashes the same up front, so warm starts don't stutter on first execution.
+struct JitDiskCacheKey
+{
+	u32 address;
+	u32 numInstructions;
+	u64 hash;
+};
+
+class JitDiskCache : private LinearDiskCacheReader<JitDiskCacheKey, u8>
+{
+public:
+	JitDiskCache() : m_enabled(false) {}
+
+	void Init(const std::string& game_id);
+	void Shutdown();
+
+	// Computes the key for a block that was flattened into ops.
+	static JitDiskCacheKey ComputeKey(u32 address, const PPCAnalyst::CodeOp *ops, int num_ops);
+
+	// Remembers a freshly compiled block for the next session.
+	void RecordBlock(const JitDiskCacheKey &key);
+
+	// Code in this range was (re)loaded; stored blocks in it get another chance.
+	void InvalidateRange(u32 address, u32 length);
+
+	bool HasBlocksToWarm() const { return !m_retry.empty(); }
+	// Hands out the stored blocks that haven't been tried since they last changed.
+	void TakeBlocksToWarm(std::vector<JitDiskCacheKey> &out);
+	// The block was compiled (or no longer needs to be), stop tracking it.
+	void MarkWarmed(u32 address);
+
+private:
+	void Read(const JitDiskCacheKey &key, const u8 *value, u32 value_size) override;
+
+	LinearDiskCache<JitDiskCacheKey, u8> m_file;
+	bool m_enabled;
+
+	// Every key that is on disk, so that we never append duplicates.
+	std::set<std::pair<u32, u64>> m_known;
+	// Stored blocks that haven't been compiled this session yet. The same
+	// address can show up with different code, e.g. for overlays.
+	std::multimap<u32, JitDiskCacheKey> m_pending;
+	std::set<u32> m_retry;
+};
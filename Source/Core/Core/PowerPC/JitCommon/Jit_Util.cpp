@@ -13,6 +13,54 @@ using namespace Gen;
 static const u8 GC_ALIGNED16(pbswapShuffle1x4[16]) = {3, 2, 1, 0, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
 static u32 GC_ALIGNED16(float_buffer);
 
+// Whether to look MMU accesses that miss the fast path up in the fast TLB
+// before calling into Memory.
+static bool UseFastTLB()
+{
+#ifdef _M_X64
+	return Core::g_CoreStartupParameter.bMMU
+#ifdef ENABLE_MEM_CHECK
+	    && !Core::g_CoreStartupParameter.bEnableDebugging
+#endif
+	    ;
+#else
+	return false;
+#endif
+}
+
+bool EmuCodeBlock::FastTLBLookup(X64Reg reg_addr, const u32 *table, u32 registersInUse, X64Reg reg_keep, FixupBranch &miss)
+{
+#ifdef _M_X64
+	// Registers the call on the slow path would clobber anyway, if nothing lives
+	// there. ABI_ALL_CALLEE_SAVED is really the caller-saved set: RSI and RDI
+	// are callee-saved on Win64, hold guest registers and may not be in
+	// registersInUse (see QUANTIZED_REGS_TO_SAVE).
+	static const X64Reg scratch_order[] = {RCX, RDX, R8, R9, R10, R11, RSI, RDI};
+	X64Reg scratch[2];
+	int num_scratch = 0;
+	for (X64Reg reg : scratch_order)
+	{
+		if (num_scratch < 2 && (ABI_ALL_CALLEE_SAVED & (1 << reg)) && !(registersInUse & (1 << reg)) &&
+			reg != reg_addr && reg != reg_keep)
+			scratch[num_scratch++] = reg;
+	}
+	if (num_scratch < 2)
+		return false;
+
+	MOV(64, R(scratch[0]), ImmPtr((void *)table));
+	MOV(32, R(scratch[1]), R(reg_addr));
+	SHR(32, R(scratch[1]), Imm8(Memory::FAST_TLB_PAGE_SHIFT));
+	MOV(32, R(scratch[1]), MComplex(scratch[0], scratch[1], SCALE_4, 0));
+	TEST(32, R(scratch[1]), R(scratch[1]));
+	miss = J_CC(CC_Z, true);
+	AND(32, R(reg_addr), Imm32(0xFFF));
+	OR(32, R(reg_addr), R(scratch[1]));
+	return true;
+#else
+	return false;
+#endif
+}
+
 void EmuCodeBlock::UnsafeLoadRegToReg(X64Reg reg_addr, X64Reg reg_value, int accessSize, s32 offset, bool signExtend)
 {
 #ifdef _M_X64
@@ -69,13 +117,13 @@ u8 *EmuCodeBlock::UnsafeLoadToReg(X64Reg reg_value, Gen::OpArg opAddress, int ac
 		}
 
 		result = GetWritableCodePtr();
-		MOVZX(32, accessSize, reg_value, MComplex(RBX, opAddress.GetSimpleReg(), SCALE_1, offset));
+		MOVZX(accessSize == 64 ? 64 : 32, accessSize, reg_value, MComplex(RBX, opAddress.GetSimpleReg(), SCALE_1, offset));
 	}
 	else
 	{
 		MOV(32, R(reg_value), opAddress);
 		result = GetWritableCodePtr();
-		MOVZX(32, accessSize, reg_value, MComplex(RBX, reg_value, SCALE_1, offset));
+		MOVZX(accessSize == 64 ? 64 : 32, accessSize, reg_value, MComplex(RBX, reg_value, SCALE_1, offset));
 	}
 #else
 	if (opAddress.IsImm())
@@ -97,7 +145,11 @@ u8 *EmuCodeBlock::UnsafeLoadToReg(X64Reg reg_value, Gen::OpArg opAddress, int ac
 	if (accessSize == 8)
 		NOP(2);
 
-	if (accessSize == 32)
+	if (accessSize == 64)
+	{
+		BSWAP(64, reg_value);
+	}
+	else if (accessSize == 32)
 	{
 		BSWAP(32, reg_value);
 	}
@@ -135,7 +187,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 	{
 		u8 *mov = UnsafeLoadToReg(reg_value, opAddress, accessSize, offset, signExtend);
 
-		registersInUseAtLoc[mov] = registersInUse;
+		registersInUseAtLoc.push_back(std::make_pair(mov, registersInUse));
 	}
 	else
 #endif
@@ -165,6 +217,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				ABI_PushRegistersAndAdjustStack(registersInUse, false);
 				switch (accessSize)
 				{
+				case 64: ABI_CallFunctionC((void *)&Memory::Read_U64, address); break;
 				case 32: ABI_CallFunctionC((void *)&Memory::Read_U32, address); break;
 				case 16: ABI_CallFunctionC((void *)&Memory::Read_U16_ZX, address); break;
 				case 8:  ABI_CallFunctionC((void *)&Memory::Read_U8_ZX, address); break;
@@ -180,7 +233,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				}
 				else if (reg_value != EAX)
 				{
-					MOVZX(32, accessSize, reg_value, R(EAX));
+					MOVZX(accessSize == 64 ? 64 : 32, accessSize, reg_value, R(EAX));
 				}
 
 				MEMCHECK_END
@@ -188,16 +241,28 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 		}
 		else
 		{
-			if (offset)
+			const bool fast_tlb = UseFastTLB();
+			if (offset || fast_tlb)
 			{
 				MOV(32, R(EAX), opAddress);
-				ADD(32, R(EAX), Imm32(offset));
+				if (offset)
+					ADD(32, R(EAX), Imm32(offset));
 				TEST(32, R(EAX), Imm32(mem_mask));
 				FixupBranch fast = J_CC(CC_Z, true);
 
+				FixupBranch tlb_miss, tlb_hit;
+				bool tlb = fast_tlb && FastTLBLookup(EAX, Memory::fast_tlb_read, registersInUse, reg_value, tlb_miss);
+				if (tlb)
+				{
+					UnsafeLoadToReg(reg_value, R(EAX), accessSize, 0, signExtend);
+					tlb_hit = J(true);
+					SetJumpTarget(tlb_miss);
+				}
+
 				ABI_PushRegistersAndAdjustStack(registersInUse, false);
 				switch (accessSize)
 				{
+				case 64: ABI_CallFunctionR((void *)&Memory::Read_U64, EAX); break;
 				case 32: ABI_CallFunctionR((void *)&Memory::Read_U32, EAX); break;
 				case 16: ABI_CallFunctionR((void *)&Memory::Read_U16_ZX, EAX); break;
 				case 8:  ABI_CallFunctionR((void *)&Memory::Read_U8_ZX, EAX);  break;
@@ -213,7 +278,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				}
 				else if (reg_value != EAX)
 				{
-					MOVZX(32, accessSize, reg_value, R(EAX));
+					MOVZX(accessSize == 64 ? 64 : 32, accessSize, reg_value, R(EAX));
 				}
 
 				MEMCHECK_END
@@ -222,6 +287,8 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				SetJumpTarget(fast);
 				UnsafeLoadToReg(reg_value, R(EAX), accessSize, 0, signExtend);
 				SetJumpTarget(exit);
+				if (tlb)
+					SetJumpTarget(tlb_hit);
 			}
 			else
 			{
@@ -231,6 +298,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				ABI_PushRegistersAndAdjustStack(registersInUse, false);
 				switch (accessSize)
 				{
+				case 64: ABI_CallFunctionA((void *)&Memory::Read_U64, opAddress); break;
 				case 32: ABI_CallFunctionA((void *)&Memory::Read_U32, opAddress); break;
 				case 16: ABI_CallFunctionA((void *)&Memory::Read_U16_ZX, opAddress); break;
 				case 8:  ABI_CallFunctionA((void *)&Memory::Read_U8_ZX, opAddress);  break;
@@ -246,7 +314,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				}
 				else if (reg_value != EAX)
 				{
-					MOVZX(32, accessSize, reg_value, R(EAX));
+					MOVZX(accessSize == 64 ? 64 : 32, accessSize, reg_value, R(EAX));
 				}
 
 				MEMCHECK_END
@@ -299,7 +367,7 @@ void EmuCodeBlock::SafeWriteRegToReg(X64Reg reg_value, X64Reg reg_addr, int acce
 			NOP(1);
 		}
 
-		registersInUseAtLoc[mov] = registersInUse;
+		registersInUseAtLoc.push_back(std::make_pair(mov, registersInUse));
 		return;
 	}
 #endif
@@ -326,9 +394,20 @@ void EmuCodeBlock::SafeWriteRegToReg(X64Reg reg_value, X64Reg reg_addr, int acce
 	FixupBranch fast = J_CC(CC_Z, true);
 	bool noProlog = (0 != (flags & SAFE_LOADSTORE_NO_PROLOG));
 	bool swap = !(flags & SAFE_LOADSTORE_NO_SWAP);
+
+	FixupBranch tlb_miss, tlb_hit;
+	bool tlb = UseFastTLB() && FastTLBLookup(reg_addr, Memory::fast_tlb_write, registersInUse, reg_value, tlb_miss);
+	if (tlb)
+	{
+		UnsafeWriteRegToReg(reg_value, reg_addr, accessSize, 0, swap);
+		tlb_hit = J(true);
+		SetJumpTarget(tlb_miss);
+	}
+
 	ABI_PushRegistersAndAdjustStack(registersInUse, noProlog);
 	switch (accessSize)
 	{
+	case 64: ABI_CallFunctionRR(swap ? ((void *)&Memory::Write_U64) : ((void *)&Memory::Write_U64_Swap), reg_value, reg_addr, false); break;
 	case 32: ABI_CallFunctionRR(swap ? ((void *)&Memory::Write_U32) : ((void *)&Memory::Write_U32_Swap), reg_value, reg_addr, false); break;
 	case 16: ABI_CallFunctionRR(swap ? ((void *)&Memory::Write_U16) : ((void *)&Memory::Write_U16_Swap), reg_value, reg_addr, false); break;
 	case 8:  ABI_CallFunctionRR((void *)&Memory::Write_U8, reg_value, reg_addr, false);  break;
@@ -338,6 +417,8 @@ void EmuCodeBlock::SafeWriteRegToReg(X64Reg reg_value, X64Reg reg_addr, int acce
 	SetJumpTarget(fast);
 	UnsafeWriteRegToReg(reg_value, reg_addr, accessSize, 0, swap);
 	SetJumpTarget(exit);
+	if (tlb)
+		SetJumpTarget(tlb_hit);
 }
 
 void EmuCodeBlock::SafeWriteFloatToReg(X64Reg xmm_value, X64Reg reg_addr, u32 registersInUse, int flags)
@@ -5,7 +5,7 @@
 #pragma once
 
 #include "x64Emitter.h"
-#include <unordered_map>
+#include <vector>
 
 #define MEMCHECK_START \
 	FixupBranch memException; \
@@ -33,6 +33,7 @@ public:
 		SAFE_LOADSTORE_NO_PROLOG = 2,
 		SAFE_LOADSTORE_NO_FASTMEM = 4
 	};
+	// accessSize can be 64 on x64, for the floating point loads and stores.
 	void SafeLoadToReg(Gen::X64Reg reg_value, const Gen::OpArg & opAddress, int accessSize, s32 offset, u32 registersInUse, bool signExtend, int flags = 0);
 	void SafeWriteRegToReg(Gen::X64Reg reg_value, Gen::X64Reg reg_addr, int accessSize, s32 offset, u32 registersInUse, int flags = 0);
 
@@ -48,5 +49,13 @@ public:
 	void ForceSinglePrecisionS(Gen::X64Reg xmm);
 	void ForceSinglePrecisionP(Gen::X64Reg xmm);
 protected:
-	std::unordered_map<u8 *, u32> registersInUseAtLoc;
+	// MMU: looks the page of reg_addr up in one of Memory's fast TLB tables and
+	// translates reg_addr in place. Jumps to miss, with reg_addr untouched, if
+	// the page isn't there. Returns false, emitting nothing, if it can't find
+	// two free scratch registers besides reg_addr and reg_keep.
+	bool FastTLBLookup(Gen::X64Reg reg_addr, const u32 *table, u32 registersInUse, Gen::X64Reg reg_keep, Gen::FixupBranch &miss);
+
+	// Registers in use at each fastmem access of the block being emitted. The
+	// emitter moves them into the JitBlock when it's done with the block.
+	std::vector<std::pair<const u8 *, u32>> registersInUseAtLoc;
 };
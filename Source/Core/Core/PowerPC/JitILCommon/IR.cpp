@@ -29,7 +29,12 @@ The first step of code generation is producing the IR; this is roughly
 equivalent to all of code generation in the previous code. In addition
 to storing the IR, some optimizations occur in this step: the primary
 optimizations are that redundant register loads/stores are eliminated,
-and constant-folding is done.
+and constant-folding is done.  Integer operations are also numbered by
+their operands, so an operation that was already done in the block reuses
+the earlier result, and a load from RAM reuses an earlier load from the
+same address if nothing was stored in between.  Register stores are only
+dropped when nothing can leave the block between them and the store that
+replaces them.
 
 The second step is a quick pass over the IL to figure out liveness: this
 information is used both for dead code elimination and to find the last
@@ -95,7 +100,6 @@ Scheduling to reduce register pressure: PowerPC	compilers like to push
 	uses far away from definitions, but it's rather unfriendly to modern
 	x86 processors, which are short on registers and extremely good at
 	instruction reordering.
-Common subexpression elimination
 Optimize load/store of sum using complex addressing (partially implemented)
 Loop optimizations (loop-carried registers, LICM)
 Code refactoring/cleanup
@@ -131,6 +135,19 @@ using namespace Gen;
 
 namespace IREmitter {
 
+// Integer operations that only depend on their operands
+static bool isPureOp(unsigned Opcode) {
+	switch (Opcode) {
+	case SExt8: case SExt16: case BSwap32: case BSwap16: case Cntlzw: case Not:
+	case Add: case Mul: case And: case Or: case Xor:
+	case MulHighUnsigned: case Sub: case Shl: case Shrl: case Sarl: case Rol:
+	case ICmpCRSigned: case ICmpCRUnsigned:
+		return true;
+	default:
+		return isICmp(Opcode) != 0;
+	}
+}
+
 InstLoc IRBuilder::EmitZeroOp(unsigned Opcode, unsigned extra = 0) {
 	InstLoc curIndex = InstList.data() + InstList.size();
 	InstList.push_back(Opcode | (extra << 8));
@@ -139,6 +156,14 @@ InstLoc IRBuilder::EmitZeroOp(unsigned Opcode, unsigned extra = 0) {
 }
 
 InstLoc IRBuilder::EmitUOp(unsigned Opcode, InstLoc Op1, unsigned extra) {
+	const bool pure = isPureOp(Opcode);
+	ValueKey key = makeValueKey(Opcode, Op1, 0, extra);
+	if (pure) {
+		std::map<ValueKey, InstLoc>::iterator it = ValueCache.find(key);
+		if (it != ValueCache.end())
+			return it->second;
+	}
+
 	InstLoc curIndex = InstList.data() + InstList.size();
 	unsigned backOp1 = (s32)(curIndex - 1 - Op1);
 	if (backOp1 >= 256) {
@@ -149,10 +174,20 @@ InstLoc IRBuilder::EmitUOp(unsigned Opcode, InstLoc Op1, unsigned extra) {
 	}
 	InstList.push_back(Opcode | (backOp1 << 8) | (extra << 16));
 	MarkUsed.push_back(false);
+	if (pure)
+		ValueCache[key] = curIndex;
 	return curIndex;
 }
 
 InstLoc IRBuilder::EmitBiOp(unsigned Opcode, InstLoc Op1, InstLoc Op2, unsigned extra) {
+	const bool pure = isPureOp(Opcode);
+	ValueKey key = makeValueKey(Opcode, Op1, Op2, extra);
+	if (pure) {
+		std::map<ValueKey, InstLoc>::iterator it = ValueCache.find(key);
+		if (it != ValueCache.end())
+			return it->second;
+	}
+
 	InstLoc curIndex = InstList.data() + InstList.size();
 	unsigned backOp1 = (s32)(curIndex - 1 - Op1);
 	if (backOp1 >= 255) {
@@ -171,6 +206,8 @@ InstLoc IRBuilder::EmitBiOp(unsigned Opcode, InstLoc Op1, InstLoc Op2, unsigned
 	}
 	InstList.push_back(Opcode | (backOp1 << 8) | (backOp2 << 16) | (extra << 24));
 	MarkUsed.push_back(false);
+	if (pure)
+		ValueCache[key] = curIndex;
 	return curIndex;
 }
 
@@ -282,6 +319,9 @@ InstLoc IRBuilder::FoldZeroOp(unsigned Opcode, unsigned extra) {
 
 InstLoc IRBuilder::FoldUOp(unsigned Opcode, InstLoc Op1, unsigned extra) {
 	if (Opcode == StoreGReg) {
+		// The cache always has what the register holds, or is about to.
+		if (GRegCache[extra] == Op1)
+			return Op1;
 		// Reg store folding: save the value for load folding.
 		// If there's a previous store, zap it because it's dead.
 		GRegCache[extra] = Op1;
@@ -300,6 +340,8 @@ InstLoc IRBuilder::FoldUOp(unsigned Opcode, InstLoc Op1, unsigned extra) {
 		return FRegCacheStore[extra];
 	}
 	if (Opcode == StoreCarry) {
+		if (CarryCache == Op1)
+			return Op1;
 		CarryCache = Op1;
 		if (CarryCacheStore) {
 			*CarryCacheStore = 0;
@@ -308,6 +350,8 @@ InstLoc IRBuilder::FoldUOp(unsigned Opcode, InstLoc Op1, unsigned extra) {
 		return CarryCacheStore;
 	}
 	if (Opcode == StoreCR) {
+		if (CRCache[extra] == Op1)
+			return Op1;
 		CRCache[extra] = Op1;
 		if (CRCacheStore[extra]) {
 			*CRCacheStore[extra] = 0;
@@ -316,6 +360,8 @@ InstLoc IRBuilder::FoldUOp(unsigned Opcode, InstLoc Op1, unsigned extra) {
 		return CRCacheStore[extra];
 	}
 	if (Opcode == StoreCTR) {
+		if (CTRCache == Op1)
+			return Op1;
 		CTRCache = Op1;
 		if (CTRCacheStore) {
 			*CTRCacheStore = 0;
@@ -323,6 +369,27 @@ InstLoc IRBuilder::FoldUOp(unsigned Opcode, InstLoc Op1, unsigned extra) {
 		CTRCacheStore = EmitUOp(StoreCTR, Op1, extra);
 		return CTRCacheStore;
 	}
+	if (Opcode == Load8 || Opcode == Load16 || Opcode == Load32 ||
+	    Opcode == LoadSingle || Opcode == LoadDouble) {
+		// Load-to-load forwarding. Only from RAM: reading a hardware
+		// register can have side effects, and gives a new value each time.
+		if (!isRAMAddress(Op1))
+			return EmitUOp(Opcode, Op1, extra);
+		ValueKey key = makeValueKey(Opcode, Op1, 0, extra);
+		std::map<ValueKey, InstLoc>::iterator it = MemCache.find(key);
+		if (it != MemCache.end())
+			return it->second;
+		InstLoc load = EmitUOp(Opcode, Op1, extra);
+		MemCache[key] = load;
+		return load;
+	}
+	if (Opcode == FPExceptionCheck || Opcode == DSIExceptionCheck ||
+	    Opcode == ExtExceptionCheck || Opcode == BreakPointCheck) {
+		// These can leave the block, and the registers have to be up to
+		// date by then.
+		ClearStoreCaches();
+		return EmitUOp(Opcode, Op1, extra);
+	}
 	if (Opcode == CompactMRegToPacked) {
 		if (getOpcode(*Op1) == ExpandPackedToMReg)
 			return getOp1(Op1);
@@ -1008,6 +1075,7 @@ InstLoc IRBuilder::FoldInterpreterFallback(InstLoc Op1, InstLoc Op2) {
 	}
 	CTRCache = 0;
 	CTRCacheStore = 0;
+	MemCache.clear();
 	return EmitBiOp(InterpreterFallback, Op1, Op2);
 }
 
@@ -1024,6 +1092,17 @@ InstLoc IRBuilder::FoldDoubleBiOp(unsigned Opcode, InstLoc Op1, InstLoc Op2) {
 }
 
 InstLoc IRBuilder::FoldBiOp(unsigned Opcode, InstLoc Op1, InstLoc Op2, unsigned extra) {
+	switch (Opcode) {
+	case Store8: case Store16: case Store32:
+	case StoreSingle: case StoreDouble: case StorePaired:
+		// The store might overlap any of them.
+		MemCache.clear();
+		break;
+	case BranchCond: case IdleBranch:
+		ClearStoreCaches();
+		break;
+	}
+
 	switch (Opcode) {
 		case Add: return FoldAdd(Op1, Op2);
 		case Sub: return FoldSub(Op1, Op2);
@@ -1061,6 +1140,35 @@ unsigned IRBuilder::GetImmValue(InstLoc I) const {
 	return ConstList[*I >> 8];
 }
 
+u64 IRBuilder::getValueNumber(InstLoc I) const {
+	if (isImm(*I))
+		return (1ULL << 32) | GetImmValue(I);
+	return (u64)(I - InstList.data());
+}
+
+IRBuilder::ValueKey IRBuilder::makeValueKey(unsigned Opcode, InstLoc Op1, InstLoc Op2, unsigned extra) const {
+	ValueKey key;
+	key.Opcode = Opcode | (extra << 8);
+	key.Op1 = getValueNumber(Op1);
+	key.Op2 = Op2 ? getValueNumber(Op2) : ~0ULL;
+	// Commutative operators
+	if (Opcode >= Add && Opcode <= Xor && key.Op1 > key.Op2)
+		std::swap(key.Op1, key.Op2);
+	return key;
+}
+
+void IRBuilder::ClearStoreCaches() {
+	// The values stay, the stores just can't be dropped anymore.
+	for (unsigned i = 0; i < 32; i++) {
+		GRegCacheStore[i] = 0;
+		FRegCacheStore[i] = 0;
+	}
+	CarryCacheStore = 0;
+	for (unsigned i = 0; i < 8; i++)
+		CRCacheStore[i] = 0;
+	CTRCacheStore = 0;
+}
+
 void IRBuilder::SetMarkUsed(InstLoc I) {
 	const unsigned i = (unsigned)(I - InstList.data());
 	MarkUsed[i] = true;
@@ -1209,6 +1317,20 @@ InstLoc IRBuilder::isNeg(InstLoc I) const {
 	return NULL;
 }
 
+// True if I is an address in RAM: a constant one, or an offset from the stack
+// pointer or one of the small data area pointers (r1, r2, r13), which the
+// ABI keeps pointing at RAM. Any other register could hold a hardware address.
+bool IRBuilder::isRAMAddress(InstLoc I) const {
+	if (isImm(*I))
+		return Memory::IsRAMAddress(GetImmValue(I), true);
+	if (getOpcode(*I) == Add && isImm(*getOp2(I)))
+		I = getOp1(I);
+	if (getOpcode(*I) != LoadGReg)
+		return false;
+	const unsigned reg = *I >> 8;
+	return reg == 1 || reg == 2 || reg == 13;
+}
+
 // TODO: Move the following code to a separated file.
 struct Writer
 {
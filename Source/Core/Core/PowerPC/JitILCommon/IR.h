@@ -5,6 +5,7 @@
 #pragma once
 
 #include "x64Emitter.h"
+#include <map>
 #include <vector>
 
 namespace IREmitter {
@@ -389,19 +390,19 @@ public:
 		return FoldUOp(SystemCall, pc);
 	}
 	InstLoc EmitFPExceptionCheck(InstLoc pc) {
-		return EmitUOp(FPExceptionCheck, pc);
+		return FoldUOp(FPExceptionCheck, pc);
 	}
 	InstLoc EmitDSIExceptionCheck(InstLoc pc) {
-		return EmitUOp(DSIExceptionCheck, pc);
+		return FoldUOp(DSIExceptionCheck, pc);
 	}
 	InstLoc EmitISIException(InstLoc dest) {
 		return EmitUOp(ISIException, dest);
 	}
 	InstLoc EmitExtExceptionCheck(InstLoc pc) {
-		return EmitUOp(ExtExceptionCheck, pc);
+		return FoldUOp(ExtExceptionCheck, pc);
 	}
 	InstLoc EmitBreakPointCheck(InstLoc pc) {
-		return EmitUOp(BreakPointCheck, pc);
+		return FoldUOp(BreakPointCheck, pc);
 	}
 	InstLoc EmitRFIExit() {
 		return FoldZeroOp(RFIExit, 0);
@@ -559,6 +560,8 @@ public:
 		}
 		CTRCache = 0;
 		CTRCacheStore = 0;
+		ValueCache.clear();
+		MemCache.clear();
 	}
 
 	IRBuilder() { Reset(); }
@@ -571,6 +574,22 @@ private:
 	void simplifyCommutative(unsigned Opcode, InstLoc& Op1, InstLoc& Op2);
 	bool maskedValueIsZero(InstLoc Op1, InstLoc Op2) const;
 	InstLoc isNeg(InstLoc I) const;
+	bool isRAMAddress(InstLoc I) const;
+
+	// Value numbering: an operation with the same operands as one already in
+	// the block gives the same value. Constants are compared by value.
+	struct ValueKey {
+		unsigned Opcode;
+		u64 Op1, Op2;
+		bool operator<(const ValueKey& other) const {
+			if (Opcode != other.Opcode) return Opcode < other.Opcode;
+			if (Op1 != other.Op1) return Op1 < other.Op1;
+			return Op2 < other.Op2;
+		}
+	};
+	u64 getValueNumber(InstLoc I) const;
+	ValueKey makeValueKey(unsigned Opcode, InstLoc Op1, InstLoc Op2, unsigned extra) const;
+	void ClearStoreCaches();
 
 	std::vector<Inst> InstList; // FIXME: We must ensure this is continuous!
 	std::vector<bool> MarkUsed;	// Used for IRWriter
@@ -586,6 +605,10 @@ private:
 	InstLoc CTRCacheStore;
 	InstLoc CRCache[8];
 	InstLoc CRCacheStore[8];
+	// Pure integer operations in the block
+	std::map<ValueKey, InstLoc> ValueCache;
+	// Guest memory loads since the last store
+	std::map<ValueKey, InstLoc> MemCache;
 };
 
 };
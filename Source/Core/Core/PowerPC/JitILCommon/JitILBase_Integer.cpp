@@ -476,41 +476,45 @@ void JitILBase::srawx(UGeckoInstruction inst)
 	INSTRUCTION_START
 	JITDISABLE(bJITIntegerOff)
 	// FIXME: We can do a lot better on 64-bit
-	IREmitter::InstLoc val, samt, mask, mask2, test;
+	IREmitter::InstLoc val, samt, res, mask, mask2, big, test;
 	val = ibuild.EmitLoadGReg(inst.RS);
 	samt = ibuild.EmitLoadGReg(inst.RB);
 	mask = ibuild.EmitIntConst(-1);
-	val = ibuild.EmitSarl(val, samt);
-	mask = ibuild.EmitShl(mask, samt);
-	samt = ibuild.EmitShl(samt, ibuild.EmitIntConst(26));
-	samt = ibuild.EmitSarl(samt, ibuild.EmitIntConst(31));
-	samt = ibuild.EmitAnd(samt, ibuild.EmitIntConst(31));
-	val = ibuild.EmitSarl(val, samt);
-	ibuild.EmitStoreGReg(val, inst.RA);
 	mask = ibuild.EmitShl(mask, samt);
+	// All ones if the shift amount is 32 or more
+	big = ibuild.EmitShl(samt, ibuild.EmitIntConst(26));
+	big = ibuild.EmitSarl(big, ibuild.EmitIntConst(31));
+	res = ibuild.EmitSarl(val, samt);
+	res = ibuild.EmitSarl(res, ibuild.EmitAnd(big, ibuild.EmitIntConst(31)));
+	ibuild.EmitStoreGReg(res, inst.RA);
+	// Carry if RS is negative and ones were shifted out of it, which for 32 or
+	// more is all of it.
+	mask2 = ibuild.EmitXor(mask, ibuild.EmitIntConst(0x7FFFFFFF));
+	mask = ibuild.EmitXor(mask, ibuild.EmitAnd(mask2, big));
 	mask2 = ibuild.EmitAnd(mask, ibuild.EmitIntConst(0x7FFFFFFF));
 	test = ibuild.EmitOr(val, mask2);
 	test = ibuild.EmitICmpUgt(test, mask);
 	ibuild.EmitStoreCarry(test);
 
 	if (inst.Rc)
-		ComputeRC(ibuild, val);
+		ComputeRC(ibuild, res);
 }
 
 void JitILBase::srawix(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
 	JITDISABLE(bJITIntegerOff)
-	IREmitter::InstLoc val = ibuild.EmitLoadGReg(inst.RS), test;
-	val = ibuild.EmitSarl(val, ibuild.EmitIntConst(inst.SH));
-	ibuild.EmitStoreGReg(val, inst.RA);
+	IREmitter::InstLoc val = ibuild.EmitLoadGReg(inst.RS), res, test;
+	res = ibuild.EmitSarl(val, ibuild.EmitIntConst(inst.SH));
+	ibuild.EmitStoreGReg(res, inst.RA);
+	// Carry if RS is negative and ones were shifted out of it
 	unsigned int mask = -1u << inst.SH;
 	test = ibuild.EmitOr(val, ibuild.EmitIntConst(mask & 0x7FFFFFFF));
 	test = ibuild.EmitICmpUgt(test, ibuild.EmitIntConst(mask));
 
 	ibuild.EmitStoreCarry(test);
 	if (inst.Rc)
-		ComputeRC(ibuild, val);
+		ComputeRC(ibuild, res);
 }
 
 // count leading zeroes
@@ -4,11 +4,15 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <cstring>
+#include <map>
+#include <string>
 
 #ifdef _WIN32
 #include <windows.h>
 #endif
 
+#include "CachedInterpreter.h"
 #include "JitInterface.h"
 #include "JitCommon/JitBase.h"
 
@@ -27,7 +31,9 @@
 #endif
 
 #include "Profiler.h"
+#include "PPCAnalyst.h"
 #include "PPCSymbolDB.h"
+#include "StringUtil.h"
 #include "HW/Memmap.h"
 #include "ConfigManager.h"
 
@@ -36,10 +42,14 @@ bool bMMU = false;
 
 namespace JitInterface
 {
+	static CachedInterpreter *cached_interpreter = NULL;
+
 	void DoState(PointerWrap &p)
 	{
 		if (jit && p.GetMode() == PointerWrap::MODE_READ)
 			jit->GetBlockCache()->ClearSafe();
+		if (cached_interpreter && p.GetMode() == PointerWrap::MODE_READ)
+			cached_interpreter->ClearCache();
 	}
 	CPUCoreBase *InitJitCore(int core)
 	{
@@ -73,6 +83,14 @@ namespace JitInterface
 				break;
 			}
 			#endif
+			case 5:
+			{
+				// Not a JitBase, works on every host.
+				cached_interpreter = new CachedInterpreter();
+				cached_interpreter->Init();
+				jit = NULL;
+				return cached_interpreter;
+			}
 			default:
 			{
 				PanicAlert("Unrecognizable cpu_core: %d", core);
@@ -113,6 +131,11 @@ namespace JitInterface
 				break;
 			}
 			#endif
+			case 5:
+			{
+				// Uses the interpreter's tables.
+				break;
+			}
 			default:
 			{
 				PanicAlert("Unrecognizable cpu_core: %d", core);
@@ -122,9 +145,25 @@ namespace JitInterface
 	}
 	CPUCoreBase *GetCore()
 	{
+		if (cached_interpreter)
+			return cached_interpreter;
 		return jit;
 	}
 
+	// Per-function totals for the profile reports.
+	struct FunctionStat
+	{
+		std::string name;
+		u32 address;
+		int numBlocks;
+		u64 runCount;
+		u64 cost;
+		u64 ticks;
+
+		bool operator <(const FunctionStat &other) const
+		{ return ticks != other.ticks ? ticks > other.ticks : cost > other.cost; }
+	};
+
 	void WriteProfileResults(const char *filename)
 	{
 		// Can't really do this with no jit core available
@@ -133,26 +172,52 @@ namespace JitInterface
 		std::vector<BlockStat> stats;
 		stats.reserve(jit->GetBlockCache()->GetNumBlocks());
 		u64 cost_sum = 0;
-	#ifdef _WIN32
 		u64 timecost_sum = 0;
-		u64 countsPerSec;
-		QueryPerformanceFrequency((LARGE_INTEGER *)&countsPerSec);
-	#endif
+		const u64 countsPerSec = Profiler::GetTicksPerSecond();
+
+		// Function start -> totals; blocks outside any known function are keyed by their own address.
+		std::map<u32, FunctionStat> functions;
+		const SymbolDB::XFuncMap &symbols = g_symbolDB.Symbols();
+
 		for (int i = 0; i < jit->GetBlockCache()->GetNumBlocks(); i++)
 		{
 			const JitBlock *block = jit->GetBlockCache()->GetBlock(i);
 			// Rough heuristic.  Mem instructions should cost more.
 			u64 cost = block->originalSize * (block->runCount / 4);
-	#ifdef _WIN32
 			u64 timecost = block->ticCounter;
-	#endif
 			// Todo: tweak.
 			if (block->runCount >= 1)
 				stats.push_back(BlockStat(i, cost));
+			else
+				continue;
 			cost_sum += cost;
-	#ifdef _WIN32
 			timecost_sum += timecost;
-	#endif
+
+			const Symbol *symbol = NULL;
+			auto it = symbols.upper_bound(block->originalAddress);
+			if (it != symbols.begin())
+			{
+				--it;
+				if (block->originalAddress < it->second.address + it->second.size)
+					symbol = &it->second;
+			}
+
+			const u32 key = symbol ? symbol->address : block->originalAddress;
+			auto inserted = functions.insert(std::make_pair(key, FunctionStat()));
+			FunctionStat &func = inserted.first->second;
+			if (inserted.second)
+			{
+				func.name = symbol ? symbol->name : StringFromFormat("zz_%08x_", key);
+				func.address = key;
+				func.numBlocks = 0;
+				func.runCount = 0;
+				func.cost = 0;
+				func.ticks = 0;
+			}
+			func.numBlocks++;
+			func.runCount += block->runCount;
+			func.cost += cost;
+			func.ticks += timecost;
 		}
 
 		sort(stats.begin(), stats.end());
@@ -170,18 +235,64 @@ namespace JitInterface
 			{
 				std::string name = g_symbolDB.GetDescription(block->originalAddress);
 				double percent = 100.0 * (double)stat.cost / (double)cost_sum;
-	#ifdef _WIN32
-				double timePercent = 100.0 * (double)block->ticCounter / (double)timecost_sum;
-				fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\t%.2lf\t%llf\t%lf\t%i\n",
+				double timePercent = timecost_sum ? 100.0 * (double)block->ticCounter / (double)timecost_sum : 0.0;
+				fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\t%.2lf\t%.2lf\t%lf\t%i\n",
 						block->originalAddress, name.c_str(), stat.cost,
 						block->ticCounter, percent, timePercent,
 						(double)block->ticCounter*1000.0/(double)countsPerSec, block->codeSize);
-	#else
-				fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t???\t%.2lf\t???\t???\t%i\n",
-						block->originalAddress, name.c_str(), stat.cost,  percent, block->codeSize);
-	#endif
 			}
 		}
+
+		std::string basename = filename;
+		if (basename.size() > 4 && basename.compare(basename.size() - 4, 4, ".txt") == 0)
+			basename.resize(basename.size() - 4);
+
+		std::vector<FunctionStat> sorted_functions;
+		sorted_functions.reserve(functions.size());
+		for (const auto& func : functions)
+			sorted_functions.push_back(func.second);
+		sort(sorted_functions.begin(), sorted_functions.end());
+
+		std::string functions_filename = basename + "-functions.txt";
+		File::IOFile ff(functions_filename, "w");
+		if (!ff)
+		{
+			PanicAlert("Failed to open %s", functions_filename.c_str());
+			return;
+		}
+		fprintf(ff.GetHandle(), "funcAddr\tfuncName\tblocks\truns\tcost\ttimeCost\tpercent\ttimePercent\tOvAllinFuncTime(ms)\n");
+		for (const FunctionStat &func : sorted_functions)
+		{
+			double percent = cost_sum ? 100.0 * (double)func.cost / (double)cost_sum : 0.0;
+			double timePercent = timecost_sum ? 100.0 * (double)func.ticks / (double)timecost_sum : 0.0;
+			fprintf(ff.GetHandle(), "%08x\t%s\t%i\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%.2lf\t%.2lf\t%lf\n",
+					func.address, func.name.c_str(), func.numBlocks, func.runCount, func.cost,
+					func.ticks, percent, timePercent, (double)func.ticks*1000.0/(double)countsPerSec);
+		}
+
+		// Collapsed stacks, one "function;block ticks" line per block, for flamegraph.pl and friends.
+		// There is no call stack to speak of, so functions are the roots.
+		std::string folded_filename = basename + ".folded";
+		File::IOFile ffolded(folded_filename, "w");
+		if (!ffolded)
+		{
+			PanicAlert("Failed to open %s", folded_filename.c_str());
+			return;
+		}
+		for (auto& stat : stats)
+		{
+			const JitBlock *block = jit->GetBlockCache()->GetBlock(stat.blockNum);
+			// Without counters, fall back to the cost heuristic.
+			u64 weight = timecost_sum ? block->ticCounter : stat.cost;
+			if (!weight)
+				continue;
+
+			const char *description = g_symbolDB.GetDescription(block->originalAddress);
+			std::string name = strcmp(description, " --- ") ? description : StringFromFormat("zz_%08x_", block->originalAddress);
+			std::replace(name.begin(), name.end(), ';', ':');
+			std::replace(name.begin(), name.end(), ' ', '_');
+			fprintf(ffolded.GetHandle(), "%s;blk_%08x %" PRIu64 "\n", name.c_str(), block->originalAddress, weight);
+		}
 		#endif
 	}
 	bool IsInCodeSpace(u8 *ptr)
@@ -197,17 +308,23 @@ namespace JitInterface
 	{
 		if (jit)
 			jit->ClearCache();
+		if (cached_interpreter)
+			cached_interpreter->ClearCache();
 	}
 	void ClearSafe()
 	{
 		if (jit)
 			jit->GetBlockCache()->ClearSafe();
+		if (cached_interpreter)
+			cached_interpreter->ClearCache();
 	}
 
 	void InvalidateICache(u32 address, u32 size)
 	{
 		if (jit)
-			jit->GetBlockCache()->InvalidateICache(address, size);
+			jit->InvalidateICache(address, size);
+		if (cached_interpreter)
+			cached_interpreter->InvalidateICache(address, size);
 	}
 
 	u32 Read_Opcode_JIT(u32 _Address)
@@ -235,13 +352,49 @@ namespace JitInterface
 		return inst;
 	}
 
+	u32 Peek_Opcode_JIT(u32 _Address)
+	{
+	#ifdef FAST_ICACHE
+		if (bMMU && !bFakeVMEM && (_Address & Memory::ADDR_MASK_MEM1))
+		{
+			_Address = Memory::TranslateAddress(_Address, Memory::FLAG_NO_EXCEPTION);
+			if (_Address == 0)
+			{
+				return 0;
+			}
+		}
+
+		u32 inst;
+		if ( (_Address & 0x0FFFFF00) == 0x00000500 )
+			inst = Memory::ReadUnchecked_U32(_Address);
+		else
+			inst = PowerPC::ppcState.iCache.PeekInstruction(_Address);
+	#else
+		u32 inst = Memory::ReadUnchecked_U32(_Address);
+	#endif
+		return inst;
+	}
+
 	void Shutdown()
 	{
+		if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITIdleLoopReport)
+		{
+			PPCAnalyst::WriteIdleLoopReport(File::GetUserPath(D_LOGS_IDX) +
+				SConfig::GetInstance().m_LocalCoreStartupParameter.GetUniqueID() + "_IdleLoops.txt");
+		}
+		PPCAnalyst::ClearIdleLoops();
+
 		if (jit)
 		{
 			jit->Shutdown();
 			delete jit;
 			jit = NULL;
 		}
+		if (cached_interpreter)
+		{
+			cached_interpreter->Shutdown();
+			delete cached_interpreter;
+			cached_interpreter = NULL;
+		}
 	}
 }
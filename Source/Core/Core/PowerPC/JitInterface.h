@@ -24,6 +24,8 @@ namespace JitInterface
 
 	// used by JIT to read instructions
 	u32 Read_Opcode_JIT(const u32 _Address);
+	// For code that may never run: doesn't load it into the instruction cache
+	u32 Peek_Opcode_JIT(const u32 _Address);
 
 	// Clearing CodeCache
 	void ClearCache();
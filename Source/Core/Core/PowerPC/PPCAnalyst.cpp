@@ -5,7 +5,9 @@
 #include <string>
 #include <queue>
 
+#include "FileUtil.h"
 #include "StringUtil.h"
+#include "PowerPCDisasm.h"
 #include "Interpreter/Interpreter.h"
 #include "../HW/Memmap.h"
 #include "JitInterface.h"
@@ -32,6 +34,8 @@ namespace PPCAnalyst {
 using namespace std;
 
 static const int CODEBUFFER_SIZE = 32000;
+// Start address -> size in instructions of the busy-wait loops Flatten found.
+static std::map<u32, int> s_idle_loops;
 // 0 does not perform block merging
 static const int FUNCTION_FOLLOWING_THRESHOLD = 16;
 
@@ -48,6 +52,7 @@ CodeBuffer::~CodeBuffer()
 
 void AnalyzeFunction2(Symbol &func);
 u32 EvaluateBranchTarget(UGeckoInstruction instr, u32 pc);
+static bool IsIdleLoop(const CodeOp *code, int num_inst);
 
 #define INVALID_TARGET ((u32)-1)
 
@@ -273,7 +278,8 @@ bool CanSwapAdjacentOps(const CodeOp &a, const CodeOp &b)
 u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 			BlockRegStats *fpa, bool &broken_block, CodeBuffer *buffer,
 			int blockSize, u32* merged_addresses,
-			int capacity_of_merged_addresses, int& size_of_merged_addresses)
+			int capacity_of_merged_addresses, int& size_of_merged_addresses,
+			MergeMode merge_mode, BranchHintFunc branch_hint, bool peek_code)
 {
 	if (capacity_of_merged_addresses < FUNCTION_FOLLOWING_THRESHOLD) {
 		PanicAlert("Capacity of merged_addresses is too small!");
@@ -313,10 +319,13 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 	u32 returnAddress = 0;
 
 	// Do analysis of the code, look for dependencies etc
+	bool merge_blocks = merge_mode == MERGE_ALWAYS ||
+		(merge_mode == MERGE_IF_ENABLED && SConfig::GetInstance().m_LocalCoreStartupParameter.bMergeBlocks);
+
 	int numSystemInstructions = 0;
 	for (int i = 0; i < maxsize; i++)
 	{
-		UGeckoInstruction inst = JitInterface::Read_Opcode_JIT(address);
+		UGeckoInstruction inst = peek_code ? JitInterface::Peek_Opcode_JIT(address) : JitInterface::Read_Opcode_JIT(address);
 
 		if (inst.hex != 0)
 		{
@@ -330,6 +339,7 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 			code[i].branchTo = -1;
 			code[i].branchToIndex = -1;
 			code[i].skip = false;
+			code[i].sideExit = 0;
 			numCycles += opinfo->numCyclesMinusOne + 1;
 
 			code[i].wantsCR0 = false;
@@ -433,6 +443,7 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 
 			bool follow = false;
 			u32 destination = 0;
+			u32 side_exit = 0;
 			if (inst.OPCD == 18 && blockSize > 1)
 			{
 				//Is bx - should we inline? yes!
@@ -455,6 +466,20 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 				if (inst.LK)
 					returnAddress = address + 4;
 			}
+			else if (inst.OPCD == 16 && !inst.LK && branch_hint)
+			{
+				// bcx - follow it the way it mostly goes, the other way becomes
+				// a side exit.
+				u32 target = inst.AA ? SignExt16(inst.BD << 2) : address + SignExt16(inst.BD << 2);
+				BranchHint hint = target != address + 4 ? branch_hint(address) : BRANCH_UNKNOWN;
+				if (hint != BRANCH_UNKNOWN)
+				{
+					destination = hint == BRANCH_MOSTLY_TAKEN ? target : address + 4;
+					side_exit = hint == BRANCH_MOSTLY_TAKEN ? address + 4 : target;
+					if (destination != blockstart)
+						follow = true;
+				}
+			}
 			else if (inst.OPCD == 31 && inst.SUBOP10 == 467)
 			{
 				// mtspr
@@ -477,7 +502,7 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 			if (numFollows > FUNCTION_FOLLOWING_THRESHOLD)
 				follow = false;
 
-			if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bMergeBlocks) {
+			if (!merge_blocks) {
 				follow = false;
 			}
 
@@ -495,6 +520,7 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 				// We don't "code[i].skip = true" here
 				// because bx may store a certain value to the link register.
 				// Instead, we skip a part of bx in Jit**::bx().
+				code[i].sideExit = side_exit;
 				address = destination;
 				merged_addresses[size_of_merged_addresses++] = address;
 			}
@@ -507,6 +533,14 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 	}
 	st->numCycles = numCycles;
 
+	// Before the reordering below, which doesn't change what the loop does
+	// but would make it harder to see.
+	if (foundExit && numFollows == 0 && IsIdleLoop(code, num_inst))
+	{
+		st->isIdleLoop = true;
+		s_idle_loops[blockstart] = num_inst;
+	}
+
 	// Instruction Reordering Pass
 	if (num_inst > 1)
 	{
@@ -544,6 +578,13 @@ u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 	bool wantsPS1 = true;
 	for (int i = num_inst - 1; i >= 0; i--)
 	{
+		// So does the code a side exit leaves to.
+		if (code[i].sideExit)
+		{
+			wantsCR0 = true;
+			wantsCR1 = true;
+			wantsPS1 = true;
+		}
 		if (code[i].outputCR0)
 			wantsCR0 = false;
 		if (code[i].outputCR1)
@@ -698,4 +739,375 @@ void FindFunctions(u32 startAddr, u32 endAddr, PPCSymbolDB *func_db)
 		leafSize, niceSize, unniceSize);
 }
 
+// Function-scope GPR liveness
+// A register is live at an instruction if some path through the function
+// may read it before writing it. Anything we can't see through (calls,
+// returns, indirect branches, branches out of the function, instructions
+// whose register usage the opcode tables don't describe) reads everything.
+
+static const u32 ALL_GPRS = 0xFFFFFFFF;
+// Larger "functions" are usually a symbol map gone wrong.
+static const u32 MAX_LIVENESS_FUNCTION_SIZE = 0x10000;
+
+struct FunctionLiveness
+{
+	u32 size;
+	std::vector<u32> live; // live GPRs before each instruction
+};
+
+// Keyed by physical start address.
+static std::map<u32, FunctionLiveness> s_liveness;
+
+// Returns false if the instruction may touch GPRs the opcode flags don't mention.
+static bool GetGPRUsage(UGeckoInstruction inst, u32 *in, u32 *out)
+{
+	*in = 0;
+	*out = 0;
+
+	GekkoOPInfo *opinfo = GetOpInfo(inst);
+	if (!opinfo)
+		return false;
+
+	int flags = opinfo->flags;
+	if (flags & FL_EVIL)
+		return false;
+
+	switch (opinfo->type)
+	{
+	case OPTYPE_INTEGER:
+		// eciwx, ecowx, eieio
+		if (!(flags & (FL_IN_A | FL_IN_A0 | FL_IN_B | FL_IN_C | FL_IN_S | FL_OUT_A | FL_OUT_D)))
+			return false;
+		break;
+	case OPTYPE_LOAD:
+	case OPTYPE_STORE:
+	case OPTYPE_LOADFP:
+	case OPTYPE_STOREFP:
+	case OPTYPE_FPU:
+		break;
+	case OPTYPE_PS:
+		// The indexed paired loads and stores have no register flags at all.
+		if ((flags & FL_LOADSTORE) && !(flags & (FL_IN_A | FL_IN_A0)))
+			return false;
+		break;
+	case OPTYPE_CR:
+		break;
+	case OPTYPE_SPR:
+		// mfspr; mtspr reads rS without saying so.
+		if (!(flags & FL_OUT_D))
+			return false;
+		break;
+	default:
+		return false;
+	}
+
+	if (flags & FL_OUT_A)
+		*out |= 1U << inst.RA;
+	if (flags & FL_OUT_D)
+		*out |= 1U << inst.RD;
+	if ((flags & FL_IN_A) || ((flags & FL_IN_A0) && inst.RA != 0))
+		*in |= 1U << inst.RA;
+	if (flags & FL_IN_B)
+		*in |= 1U << inst.RB;
+	if (flags & FL_IN_C)
+		*in |= 1U << inst.RC;
+	// The indexed integer stores don't flag the register they store.
+	if ((flags & FL_IN_S) || opinfo->type == OPTYPE_STORE)
+		*in |= 1U << inst.RS;
+	return true;
+}
+
+static void ComputeLiveness(u32 start, FunctionLiveness &func)
+{
+	const int num_inst = func.size / 4;
+	std::vector<UGeckoInstruction> code(num_inst);
+	for (int i = 0; i < num_inst; i++)
+		code[i] = Memory::ReadUnchecked_U32(start + i * 4);
+
+	func.live.assign(num_inst, 0);
+
+	// Everything starts out dead; iterate until nothing new becomes live.
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (int i = num_inst - 1; i >= 0; i--)
+		{
+			const UGeckoInstruction inst = code[i];
+			const u32 address = start + i * 4;
+			const u32 next = i + 1 < num_inst ? func.live[i + 1] : ALL_GPRS;
+			u32 live;
+
+			if (inst.OPCD == 18 || inst.OPCD == 16)
+			{
+				u32 target;
+				if (inst.OPCD == 18)
+					target = SignExt26(inst.LI << 2);
+				else
+					target = SignExt16(inst.BD << 2);
+				if (!inst.AA)
+					target += address;
+
+				if (inst.LK || target < start || target >= start + func.size || (target & 3))
+					live = ALL_GPRS;
+				else
+					live = func.live[(target - start) / 4];
+
+				// Not taken
+				if (inst.OPCD == 16)
+					live |= next;
+			}
+			else if (inst.OPCD == 19)
+			{
+				// bclrx, bcctrx, rfi, rfid; the rest are CR ops and isync.
+				if (inst.SUBOP10 == 16 || inst.SUBOP10 == 528 || inst.SUBOP10 == 50 || inst.SUBOP10 == 18)
+					live = ALL_GPRS;
+				else
+					live = next;
+			}
+			else
+			{
+				u32 in, out;
+				if (GetGPRUsage(inst, &in, &out))
+					live = (next & ~out) | in;
+				else
+					live = ALL_GPRS;
+			}
+
+			if (live != func.live[i])
+			{
+				func.live[i] = live;
+				changed = true;
+			}
+		}
+	}
+}
+
+u32 GetLiveGPRs(u32 address, u32 *func_start, u32 *func_size)
+{
+	if (!Memory::IsRAMAddress(address) || (address & 3))
+		return ALL_GPRS;
+
+	const u32 paddr = address & 0x1FFFFFFF;
+	auto it = s_liveness.upper_bound(paddr);
+	if (it != s_liveness.begin())
+	{
+		--it;
+		if (paddr >= it->first + it->second.size)
+			it = s_liveness.end();
+	}
+	else
+	{
+		it = s_liveness.end();
+	}
+
+	if (it == s_liveness.end())
+	{
+		Symbol *symbol = g_symbolDB.GetSymbolFromAddr(address);
+		if (!symbol || symbol->size <= 0 || (u32)symbol->size > MAX_LIVENESS_FUNCTION_SIZE ||
+			(symbol->address & 3) || !Memory::IsRAMAddress(symbol->address + symbol->size - 4))
+			return ALL_GPRS;
+
+		const u32 start = symbol->address & 0x1FFFFFFF;
+		// Overlapping symbols; don't bother.
+		auto next = s_liveness.lower_bound(start);
+		if (next != s_liveness.end() && next->first < start + symbol->size)
+			return ALL_GPRS;
+		if (next != s_liveness.begin())
+		{
+			--next;
+			if (next->first + next->second.size > start)
+				return ALL_GPRS;
+		}
+
+		FunctionLiveness &func = s_liveness[start];
+		func.size = symbol->size;
+		ComputeLiveness(symbol->address, func);
+		it = s_liveness.find(start);
+	}
+
+	*func_start = (address & ~0x1FFFFFFF) | it->first;
+	*func_size = it->second.size;
+	return it->second.live[(paddr - it->first) / 4];
+}
+
+void InvalidateLiveness(u32 address, u32 length)
+{
+	if (s_liveness.empty() || length == 0)
+		return;
+
+	const u32 paddr = address & 0x1FFFFFFF;
+	const u32 pend = paddr + length;
+	auto it = s_liveness.lower_bound(paddr >= MAX_LIVENESS_FUNCTION_SIZE ? paddr - MAX_LIVENESS_FUNCTION_SIZE : 0);
+	while (it != s_liveness.end() && it->first < pend)
+	{
+		if (it->first + it->second.size > paddr)
+			s_liveness.erase(it++);
+		else
+			++it;
+	}
+}
+
+void ClearLiveness()
+{
+	s_liveness.clear();
+}
+
+// Busy-wait loops
+// A block that branches back to its own start, and in between only loads and
+// computes from what it loaded and from registers the loop never changes, does
+// the same thing every time round until something else (an interrupt handler,
+// the GPU, a DMA) changes memory, which can't happen before the next event.
+// Getting this wrong only costs timing: the loop still runs after the skip.
+
+static const int MAX_IDLE_LOOP_SIZE = 16;
+
+// A load only waits on memory when it reads RAM: hardware registers (and
+// whatever a pointer register happens to point at) can change without an
+// event. Like the lwz/cmp/bc pattern in the JIT, loads off the small data
+// area registers are trusted to hit RAM, and everything else needs an address
+// the loop itself builds from constants.
+static bool IsRAMLoad(UGeckoInstruction inst, u32 known, const u32 *values, u32 written)
+{
+	u32 address;
+	if (inst.OPCD == 31)
+	{
+		if ((inst.RA && !(known & (1 << inst.RA))) || !(known & (1 << inst.RB)))
+			return false;
+		address = (inst.RA ? values[inst.RA] : 0) + values[inst.RB];
+	}
+	else if ((inst.RA == 13 || inst.RA == 2) && !(written & (1 << inst.RA)))
+	{
+		return true;
+	}
+	else
+	{
+		if (inst.RA && !(known & (1 << inst.RA)))
+			return false;
+		address = (inst.RA ? values[inst.RA] : 0) + (s32)(s16)inst.SIMM_16;
+	}
+	return Memory::IsRAMAddress(address);
+}
+
+static bool IsIdleLoop(const CodeOp *code, int num_inst)
+{
+	if (num_inst < 1 || num_inst > MAX_IDLE_LOOP_SIZE)
+		return false;
+
+	const u32 start = code[0].address;
+	const CodeOp &branch = code[num_inst - 1];
+	const UGeckoInstruction inst = branch.inst;
+	if (branch.address != start + (num_inst - 1) * 4 || inst.LK)
+		return false;
+
+	u32 target;
+	if (inst.OPCD == 18)
+	{
+		target = SignExt26(inst.LI << 2);
+	}
+	else if (inst.OPCD == 16)
+	{
+		// Counting CTR down is a delay loop, it ends by itself.
+		if (!(inst.BO & BO_DONT_DECREMENT_FLAG))
+			return false;
+		target = SignExt16(inst.BD << 2);
+	}
+	else
+	{
+		return false;
+	}
+	if (!inst.AA)
+		target += branch.address;
+	if (target != start)
+		return false;
+
+	// GPRs read before the loop writes them, and written by it. The CR only
+	// matters to the branch, and XER[CA] isn't read.
+	u32 invariant = 0;
+	u32 written = 0;
+	// GPRs holding a constant the loop put there with li/lis/addi/ori.
+	u32 known = 0;
+	u32 values[32];
+	for (int i = 0; i < num_inst - 1; i++)
+	{
+		const CodeOp &op = code[i];
+		if (op.address != start + i * 4)
+			return false;
+		// nop
+		if (op.inst.hex == 0x60000000)
+			continue;
+
+		const int flags = op.opinfo->flags;
+		if (op.opinfo->type != OPTYPE_INTEGER && op.opinfo->type != OPTYPE_LOAD)
+			return false;
+		if (flags & (FL_READ_CA | FL_ENDBLOCK | FL_CHECKEXCEPTIONS | FL_TIMER))
+			return false;
+
+		u32 in, out;
+		if (!GetGPRUsage(op.inst, &in, &out))
+			return false;
+		if (op.opinfo->type == OPTYPE_LOAD && !IsRAMLoad(op.inst, known, values, written))
+			return false;
+		invariant |= in & ~written;
+		written |= out;
+
+		const u32 known_in = known;
+		known &= ~out;
+		switch (op.inst.OPCD)
+		{
+		case 14: // addi
+		case 15: // addis
+			if (!op.inst.RA || (known_in & (1 << op.inst.RA)))
+			{
+				const u32 imm = op.inst.OPCD == 15 ? (u32)op.inst.SIMM_16 << 16 : (u32)(s32)(s16)op.inst.SIMM_16;
+				values[op.inst.RD] = (op.inst.RA ? values[op.inst.RA] : 0) + imm;
+				known |= 1 << op.inst.RD;
+			}
+			break;
+		case 24: // ori
+		case 25: // oris
+			if (known_in & (1 << op.inst.RS))
+			{
+				values[op.inst.RA] = values[op.inst.RS] | (op.inst.OPCD == 25 ? op.inst.UIMM << 16 : op.inst.UIMM);
+				known |= 1 << op.inst.RA;
+			}
+			break;
+		}
+	}
+
+	// Otherwise something (a counter, a pointer) moves every time round.
+	return !(invariant & written);
+}
+
+void WriteIdleLoopReport(const std::string &filename)
+{
+	if (s_idle_loops.empty())
+		return;
+
+	File::IOFile f(filename, "w");
+	if (!f)
+	{
+		ERROR_LOG(DYNA_REC, "Failed to open %s", filename.c_str());
+		return;
+	}
+
+	fprintf(f.GetHandle(), "Busy-wait loops: %u\n", (u32)s_idle_loops.size());
+	for (const auto &loop : s_idle_loops)
+	{
+		fprintf(f.GetHandle(), "\n%08x\t%s\n", loop.first, g_symbolDB.GetDescription(loop.first));
+		for (int i = 0; i < loop.second; i++)
+		{
+			const u32 address = loop.first + i * 4;
+			char disasm[256];
+			DisassembleGekko(Memory::ReadUnchecked_U32(address), address, disasm, 256);
+			fprintf(f.GetHandle(), "\t%08x\t%s\n", address, disasm);
+		}
+	}
+}
+
+void ClearIdleLoops()
+{
+	s_idle_loops.clear();
+}
+
 }  // namespace
@@ -39,12 +39,17 @@ struct CodeOp //16B
 	bool outputCR1;
 	bool outputPS1;
 	bool skip;  // followed BL-s for example
+	// For a conditional branch Flatten followed, where the block leaves when
+	// it goes the other way. 0 for everything else.
+	u32 sideExit;
 };
 
 struct BlockStats
 {
 	bool isFirstBlockOfFunction;
 	bool isLastBlockOfFunction;
+	// Branches back to its start and can't leave before memory changes.
+	bool isIdleLoop;
 	int numCycles;
 };
 
@@ -95,12 +100,49 @@ public:
 
 };
 
+// Whether Flatten inlines the targets of unconditional branches into the block.
+enum MergeMode
+{
+	MERGE_IF_ENABLED, // follow the BlockMerging setting
+	MERGE_NEVER,
+	MERGE_ALWAYS,
+};
+
+// Which way the conditional branch at an address mostly goes, going by what
+// the JIT has seen it do.
+enum BranchHint
+{
+	BRANCH_UNKNOWN,
+	BRANCH_MOSTLY_TAKEN,
+	BRANCH_MOSTLY_NOT_TAKEN,
+};
+typedef BranchHint (*BranchHintFunc)(u32 address);
+
+// With a branch_hint and merging, conditional branches that mostly go one
+// way are followed too, making the block a trace with side exits.
+// With peek_code the code is read without loading it into the instruction
+// cache, for blocks compiled ahead of time that the game may never run.
 u32 Flatten(u32 address, int *realsize, BlockStats *st, BlockRegStats *gpa,
 			BlockRegStats *fpa, bool &broken_block, CodeBuffer *buffer,
 			int blockSize, u32* merged_addresses,
-			int capacity_of_merged_addresses, int& size_of_merged_addresses);
+			int capacity_of_merged_addresses, int& size_of_merged_addresses,
+			MergeMode merge_mode = MERGE_IF_ENABLED, BranchHintFunc branch_hint = NULL,
+			bool peek_code = false);
 void LogFunctionCall(u32 addr);
 void FindFunctions(u32 startAddr, u32 endAddr, PPCSymbolDB *func_db);
 bool AnalyzeFunction(u32 startAddr, Symbol &func, int max_size = 0);
 
+// Returns the GPRs that may be read at address before being written, going by
+// the function the symbol database puts it in, or all of them if unknown.
+// When known, *func_start and *func_size get the code it was derived from.
+u32 GetLiveGPRs(u32 address, u32 *func_start, u32 *func_size);
+// Code in this range changed, forget the liveness derived from it.
+void InvalidateLiveness(u32 address, u32 length);
+void ClearLiveness();
+
+// Lists the busy-wait loops Flatten has found (and flagged with
+// BlockStats::isIdleLoop) since the last clear, with their disassembly.
+void WriteIdleLoopReport(const std::string &filename);
+void ClearIdleLoops();
+
 }  // namespace
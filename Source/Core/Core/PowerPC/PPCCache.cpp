@@ -167,4 +167,18 @@ namespace PowerPC
 		return res;
 	}
 
+	u32 InstructionCache::PeekInstruction(u32 addr) const
+	{
+		if (!HID0.ICE)
+			return Memory::ReadUnchecked_U32(addr);
+		u32 set = (addr >> 5) & 0x7f;
+		u32 tag = addr >> 12;
+		for (u32 i = 0; i < 8; i++)
+		{
+			if (tags[set][i] == tag && (valid[set] & (1<<i)))
+				return Common::swap32(data[set][i][(addr>>2)&7]);
+		}
+		return Memory::ReadUnchecked_U32(addr);
+	}
+
 }
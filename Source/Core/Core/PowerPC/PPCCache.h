@@ -37,6 +37,8 @@ namespace PowerPC
 
 		InstructionCache();
 		u32 ReadInstruction(u32 addr);
+		// Same result as ReadInstruction, but leaves the cache as it is.
+		u32 PeekInstruction(u32 addr) const;
 		void Invalidate(u32 addr);
 		void Init();
 		void Reset();
@@ -3,6 +3,16 @@
 // Refer to the license.txt file included.
 
 #include "JitInterface.h"
+#include "Profiler.h"
+#include "Timer.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#ifdef _WIN32
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
 
 namespace Profiler
 {
@@ -10,6 +20,28 @@ namespace Profiler
 bool g_ProfileBlocks;
 bool g_ProfileInstructions;
 
+u64 GetTicksPerSecond()
+{
+	static u64 ticks_per_second = 0;
+	if (ticks_per_second)
+		return ticks_per_second;
+
+#if defined(_M_IX86) || defined(_M_X64)
+	// Spin for a bit against the wall clock.
+	const u32 start_ms = Common::Timer::GetTimeMs();
+	const u64 start_ticks = __rdtsc();
+	u32 elapsed_ms;
+	do
+	{
+		elapsed_ms = Common::Timer::GetTimeMs() - start_ms;
+	} while (elapsed_ms < 100);
+	ticks_per_second = (__rdtsc() - start_ticks) * 1000 / elapsed_ms;
+#else
+	ticks_per_second = 1;
+#endif
+	return ticks_per_second;
+}
+
 void WriteProfileResults(const char *filename)
 {
 	JitInterface::WriteProfileResults(filename);
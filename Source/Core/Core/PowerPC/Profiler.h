@@ -5,13 +5,39 @@
 
 #pragma once
 
-#ifdef _WIN32
+#include "Common.h"
+
+// Block profiling reads the time stamp counter when a block is entered and
+// again at whichever exit it leaves by, and adds the difference to the
+// block's ticCounter. The counters are only emitted by Jit64; JitIL has its
+// own profiler (JITILTimeProfiling).
+
+#if defined(_M_X64)
 
-#ifdef _M_IX86
 #define PROFILER_QUERY_PERFORMANCE_COUNTER(pt)		\
-					LEA(32, EAX, M(pt)); PUSH(EAX);	\
-					CALL(QueryPerformanceCounter)
-// TODO: r64 way
+					RDTSC();	\
+					SHL(64, R(RDX), Imm8(32));	\
+					OR(64, R(RAX), R(RDX));	\
+					MOV(64, R(RCX), ImmPtr(pt));	\
+					MOV(64, MatR(RCX), R(RAX))
+// asm write : (u64) dt += t1-t0
+#define PROFILER_ADD_DIFF_LARGE_INTEGER(pdt, pt1, pt0)	\
+					MOV(64, R(RCX), ImmPtr(pt1));	\
+					MOV(64, R(RAX), MatR(RCX));	\
+					MOV(64, R(RCX), ImmPtr(pt0));	\
+					SUB(64, R(RAX), MatR(RCX));	\
+					MOV(64, R(RCX), ImmPtr(pdt));	\
+					ADD(64, MatR(RCX), R(RAX))
+
+#define PROFILER_VPUSH	PUSH(RAX);PUSH(RCX);PUSH(RDX)
+#define PROFILER_VPOP	POP(RDX);POP(RCX);POP(RAX)
+
+#elif defined(_M_IX86)
+
+#define PROFILER_QUERY_PERFORMANCE_COUNTER(pt)		\
+					RDTSC();	\
+					MOV(32, M(pt), R(EAX));	\
+					MOV(32, M(((u8*)pt) + 4), R(EDX))
 // asm write : (u64) dt += t1-t0
 #define PROFILER_ADD_DIFF_LARGE_INTEGER(pdt, pt1, pt0)	\
 					MOV(32, R(EAX), M(pt1));	\
@@ -27,14 +53,6 @@
 #define PROFILER_VPUSH	PUSH(EAX);PUSH(ECX);PUSH(EDX)
 #define PROFILER_VPOP	POP(EDX);POP(ECX);POP(EAX)
 
-#else
-
-#define PROFILER_QUERY_PERFORMANCE_COUNTER(pt)
-#define PROFILER_ADD_DIFF_LARGE_INTEGER(pdt, pt1, pt0)
-#define PROFILER_VPUSH
-#define PROFILER_VPOP
-#endif
-
 #else
 // TODO
 #define PROFILER_QUERY_PERFORMANCE_COUNTER(pt)
@@ -58,5 +76,11 @@ namespace Profiler
 extern bool g_ProfileBlocks;
 extern bool g_ProfileInstructions;
 
+// How fast the counters above tick, measured on first use.
+u64 GetTicksPerSecond();
+
+// Writes the per-block report to filename, and next to it a per-function
+// report (<name>-functions.txt) and collapsed stacks for flame graphs
+// (<name>.folded).
 void WriteProfileResults(const char *filename);
 }
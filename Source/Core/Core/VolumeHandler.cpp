@@ -4,6 +4,7 @@
 
 #include "VolumeHandler.h"
 #include "VolumeCreator.h"
+#include "HW/WriteWatch.h"
 
 namespace VolumeHandler
 {
@@ -67,6 +68,7 @@ bool ReadToPtr(u8* ptr, u64 _dwOffset, u64 _dwLength)
 {
 	if (g_pVolume != NULL && ptr)
 	{
+		WriteWatch::PrepareHostWrite(ptr, (size_t)_dwLength);
 		g_pVolume->Read(_dwOffset, _dwLength, ptr);
 		return true;
 	}
@@ -77,6 +79,7 @@ bool RAWReadToPtr( u8* ptr, u64 _dwOffset, u64 _dwLength )
 {
 	if (g_pVolume != NULL && ptr)
 	{
+		WriteWatch::PrepareHostWrite(ptr, (size_t)_dwLength);
 		g_pVolume->RAWRead(_dwOffset, _dwLength, ptr);
 		return true;
 	}
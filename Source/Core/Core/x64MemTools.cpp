@@ -12,6 +12,7 @@
 #include "Common.h"
 #include "MemTools.h"
 #include "HW/Memmap.h"
+#include "HW/WriteWatch.h"
 #include "PowerPC/PowerPC.h"
 #include "PowerPC/JitInterface.h"
 #ifndef _M_GENERIC
@@ -42,6 +43,10 @@ void print_trace(const char * msg)
 
 bool DoFault(u64 bad_address, SContext *ctx)
 {
+	// Writes to watched pages can come from anywhere, not just JIT code.
+	if (WriteWatch::HandleFault((uintptr_t)bad_address))
+		return true;
+
 	if (!JitInterface::IsInCodeSpace((u8*) ctx->CTX_PC))
 	{
 		// Let's not prevent debugging.
@@ -0,0 +1,338 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <deque>
+#include <vector>
+
+#include "Common.h"
+#include "Hash.h"
+#include "MemoryUtil.h"
+#include "Thread.h"
+
+#include "AsyncTextureDecoder.h"
+#include "VideoConfig.h"
+
+namespace AsyncTextureDecoder
+{
+
+enum
+{
+	// Textures smaller than this aren't worth splitting up or prefetching.
+	MIN_THREADED_TEXELS = 128 * 128,
+	NUM_PREFETCH_SLOTS = 8,
+};
+
+// RGBA8 and CMPR are always decoded to 32 bits per texel.
+static const int DECODED_TEXEL_SIZE = 4;
+
+struct Slice
+{
+	u8 *dst;
+	const u8 *src;
+	int width;
+	int height;
+	int texformat;
+	bool rgbaOnly;
+};
+
+enum PrefetchState
+{
+	PREFETCH_EMPTY,
+	PREFETCH_QUEUED,
+	PREFETCH_DECODING, // owned by a worker thread
+	PREFETCH_DONE,
+};
+
+struct PrefetchSlot
+{
+	PrefetchState state;
+	const u8 *src;
+	int width;
+	int height;
+	int texformat;
+	bool rgbaOnly;
+	u64 known_hash;
+	u32 hash_samples;
+
+	u64 hash;
+	PC_TexFormat pcfmt;
+
+	u8 *buffer;
+	u32 buffer_size;
+};
+
+static std::vector<std::thread> s_workers;
+static std::mutex s_lock;
+static std::condition_variable s_work_available;
+static std::condition_variable s_work_done;
+static bool s_running;
+
+static std::deque<Slice> s_slices;
+static int s_slices_pending;
+
+static std::deque<unsigned int> s_prefetch_queue;
+static PrefetchSlot s_prefetch[NUM_PREFETCH_SLOTS];
+
+static void DecodeSlice(const Slice &slice)
+{
+	TexDecoder_Decode(slice.dst, slice.src, slice.width, slice.height, slice.texformat, 0, 0, slice.rgbaOnly);
+}
+
+static void DecodePrefetch(PrefetchSlot &slot)
+{
+	const int size = TexDecoder_GetTextureSizeInBytes(slot.width, slot.height, slot.texformat);
+
+	slot.pcfmt = PC_TEX_FMT_NONE;
+	slot.hash = GetHash64(slot.src, size, slot.hash_samples);
+	if (slot.hash == slot.known_hash)
+		return;
+
+	PC_TexFormat pcfmt = TexDecoder_Decode(slot.buffer, slot.src, slot.width, slot.height, slot.texformat, 0, 0, slot.rgbaOnly);
+
+	// The CPU may have modified the texture while we were decoding it.
+	if (GetHash64(slot.src, size, slot.hash_samples) == slot.hash)
+		slot.pcfmt = pcfmt;
+}
+
+static void WorkerThread()
+{
+	Common::SetCurrentThreadName("Texture decoder");
+
+	std::unique_lock<std::mutex> lk(s_lock);
+	while (true)
+	{
+		while (s_running && s_slices.empty() && s_prefetch_queue.empty())
+			s_work_available.wait(lk);
+
+		if (!s_running)
+			return;
+
+		// Slices have priority, the video thread is waiting for them.
+		if (!s_slices.empty())
+		{
+			Slice slice = s_slices.front();
+			s_slices.pop_front();
+
+			lk.unlock();
+			DecodeSlice(slice);
+			lk.lock();
+
+			if (--s_slices_pending == 0)
+				s_work_done.notify_all();
+		}
+		else
+		{
+			PrefetchSlot &slot = s_prefetch[s_prefetch_queue.front()];
+			s_prefetch_queue.pop_front();
+
+			// Taken back by the video thread in the meantime.
+			if (slot.state != PREFETCH_QUEUED)
+				continue;
+
+			slot.state = PREFETCH_DECODING;
+			lk.unlock();
+			DecodePrefetch(slot);
+			lk.lock();
+
+			slot.state = PREFETCH_DONE;
+			s_work_done.notify_all();
+		}
+	}
+}
+
+void Init()
+{
+	if (s_running)
+		return;
+
+	for (unsigned int i = 0; i < NUM_PREFETCH_SLOTS; ++i)
+	{
+		s_prefetch[i].state = PREFETCH_EMPTY;
+		s_prefetch[i].buffer = NULL;
+		s_prefetch[i].buffer_size = 0;
+	}
+	s_slices_pending = 0;
+	s_running = true;
+
+	// Same as the OpenMP decoder: don't take too many cores away from the CPU thread.
+	const unsigned int num_workers = std::max((std::thread::hardware_concurrency() + 2) / 3, 1u);
+	for (unsigned int i = 0; i < num_workers; ++i)
+		s_workers.push_back(std::thread(WorkerThread));
+}
+
+void Shutdown()
+{
+	if (!s_running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_lock);
+		s_running = false;
+	}
+	s_work_available.notify_all();
+	for (std::thread &worker : s_workers)
+		worker.join();
+	s_workers.clear();
+
+	s_slices.clear();
+	s_prefetch_queue.clear();
+	for (unsigned int i = 0; i < NUM_PREFETCH_SLOTS; ++i)
+	{
+		if (s_prefetch[i].buffer)
+			FreeAlignedMemory(s_prefetch[i].buffer);
+		s_prefetch[i].buffer = NULL;
+		s_prefetch[i].buffer_size = 0;
+		s_prefetch[i].state = PREFETCH_EMPTY;
+	}
+}
+
+bool IsRunning()
+{
+	return s_running;
+}
+
+bool IsThreadedFormat(int texformat)
+{
+	return texformat == GX_TF_RGBA8 || texformat == GX_TF_CMPR;
+}
+
+PC_TexFormat Decode(u8 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, int tlutfmt, bool rgbaOnly)
+{
+	// The format overlay would be drawn onto every slice.
+	if (!s_running || !IsThreadedFormat(texformat) || width * height < MIN_THREADED_TEXELS ||
+		g_ActiveConfig.bTexFmtOverlayEnable)
+	{
+		return TexDecoder_Decode(dst, src, width, height, texformat, tlutaddr, tlutfmt, rgbaOnly);
+	}
+
+	// TexDecoder_Decode works block row by block row, so any whole number of
+	// block rows can be decoded on its own.
+	const int block_height = TexDecoder_GetBlockHeightInTexels(texformat);
+	const int num_rows = height / block_height;
+	const int num_slices = std::min((int)s_workers.size() + 1, num_rows);
+	if (num_slices < 2)
+		return TexDecoder_Decode(dst, src, width, height, texformat, tlutaddr, tlutfmt, rgbaOnly);
+	const int slice_height = (num_rows + num_slices - 1) / num_slices * block_height;
+
+	{
+		std::lock_guard<std::mutex> lk(s_lock);
+		for (int y = slice_height; y < height; y += slice_height)
+		{
+			Slice slice;
+			slice.dst = dst + y * width * DECODED_TEXEL_SIZE;
+			slice.src = src + TexDecoder_GetTextureSizeInBytes(width, y, texformat);
+			slice.width = width;
+			slice.height = std::min(slice_height, height - y);
+			slice.texformat = texformat;
+			slice.rgbaOnly = rgbaOnly;
+			s_slices.push_back(slice);
+			s_slices_pending++;
+		}
+	}
+	s_work_available.notify_all();
+
+	PC_TexFormat pcfmt = TexDecoder_Decode(dst, src, width, slice_height, texformat, tlutaddr, tlutfmt, rgbaOnly);
+
+	// Help out with the remaining slices instead of just waiting for them.
+	std::unique_lock<std::mutex> lk(s_lock);
+	while (!s_slices.empty())
+	{
+		Slice slice = s_slices.front();
+		s_slices.pop_front();
+
+		lk.unlock();
+		DecodeSlice(slice);
+		lk.lock();
+
+		s_slices_pending--;
+	}
+	while (s_slices_pending != 0)
+		s_work_done.wait(lk);
+
+	return pcfmt;
+}
+
+void Prefetch(unsigned int stage, const u8 *src, int width, int height, int texformat, bool rgbaOnly, u64 known_hash, u32 hash_samples)
+{
+	if (!s_running || stage >= NUM_PREFETCH_SLOTS || !IsThreadedFormat(texformat) || width * height < MIN_THREADED_TEXELS)
+		return;
+
+	std::lock_guard<std::mutex> lk(s_lock);
+	PrefetchSlot &slot = s_prefetch[stage];
+
+	// Don't wait for the previous texture of this stage, just let it finish.
+	if (slot.state == PREFETCH_DECODING)
+		return;
+
+	const u32 required_size = width * height * DECODED_TEXEL_SIZE;
+	if (slot.buffer_size < required_size)
+	{
+		if (slot.buffer)
+			FreeAlignedMemory(slot.buffer);
+		slot.buffer = (u8*)AllocateAlignedMemory(required_size, 16);
+		slot.buffer_size = required_size;
+	}
+
+	slot.src = src;
+	slot.width = width;
+	slot.height = height;
+	slot.texformat = texformat;
+	slot.rgbaOnly = rgbaOnly;
+	slot.known_hash = known_hash;
+	slot.hash_samples = hash_samples;
+
+	if (slot.state != PREFETCH_QUEUED)
+	{
+		slot.state = PREFETCH_QUEUED;
+		s_prefetch_queue.push_back(stage);
+		s_work_available.notify_one();
+	}
+}
+
+PC_TexFormat GetPrefetched(u8 *dst, unsigned int stage, const u8 *src, int width, int height, int texformat, bool rgbaOnly, u64 hash)
+{
+	if (!s_running || stage >= NUM_PREFETCH_SLOTS)
+		return PC_TEX_FMT_NONE;
+
+	std::unique_lock<std::mutex> lk(s_lock);
+	PrefetchSlot &slot = s_prefetch[stage];
+
+	if (slot.state == PREFETCH_EMPTY || slot.src != src || slot.width != width || slot.height != height ||
+		slot.texformat != texformat || slot.rgbaOnly != rgbaOnly)
+	{
+		return PC_TEX_FMT_NONE;
+	}
+
+	// Not started yet, so decoding it right away is quicker than waiting for a worker.
+	if (slot.state == PREFETCH_QUEUED)
+	{
+		slot.state = PREFETCH_EMPTY;
+		return PC_TEX_FMT_NONE;
+	}
+
+	while (slot.state == PREFETCH_DECODING)
+		s_work_done.wait(lk);
+
+	slot.state = PREFETCH_EMPTY;
+	if (slot.pcfmt == PC_TEX_FMT_NONE || slot.hash != hash)
+		return PC_TEX_FMT_NONE;
+
+	memcpy(dst, slot.buffer, width * height * DECODED_TEXEL_SIZE);
+	return slot.pcfmt;
+}
+
+PC_TexFormat WaitForPrefetch(unsigned int stage)
+{
+	if (!s_running || stage >= NUM_PREFETCH_SLOTS)
+		return PC_TEX_FMT_NONE;
+
+	std::unique_lock<std::mutex> lk(s_lock);
+	PrefetchSlot &slot = s_prefetch[stage];
+	while (slot.state == PREFETCH_QUEUED || slot.state == PREFETCH_DECODING)
+		s_work_done.wait(lk);
+
+	return slot.state == PREFETCH_DONE ? slot.pcfmt : PC_TEX_FMT_NONE;
+}
+
+}
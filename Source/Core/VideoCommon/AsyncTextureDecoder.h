@@ -0,0 +1,48 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "CommonTypes.h"
+#include "TextureDecoder.h"
+
+// Threaded texture decoding (VideoConfig::bThreadedTextureDecoder)
+//
+// Large RGBA8 and CMPR textures are split into slices of whole block rows,
+// which are decoded by a small pool of worker threads while the video thread
+// works on the first slice.
+//
+// Textures can also be decoded speculatively: when a texture address is written
+// to the BP registers, the texture is decoded in the background and handed to
+// TextureCache::Load once a draw call actually uses it. Load only has to wait
+// if the decode is still running by then.
+namespace AsyncTextureDecoder
+{
+
+void Init();
+void Shutdown();
+
+bool IsRunning();
+
+// Formats which are worth decoding on the worker threads.
+bool IsThreadedFormat(int texformat);
+
+// Same as TexDecoder_Decode, but spreads large textures across the worker threads.
+PC_TexFormat Decode(u8 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, int tlutfmt, bool rgbaOnly = false);
+
+// Queues a speculative decode of the texture at src for the given stage.
+// known_hash is the hash of the texture cache entry for that address, if there is one;
+// the texture isn't decoded as long as its data still matches it.
+void Prefetch(unsigned int stage, const u8 *src, int width, int height, int texformat, bool rgbaOnly, u64 known_hash, u32 hash_samples);
+
+// Copies a matching prefetched texture to dst, waiting for it if it's still being decoded.
+// Returns PC_TEX_FMT_NONE if there is none, or if its data was modified since.
+PC_TexFormat GetPrefetched(u8 *dst, unsigned int stage, const u8 *src, int width, int height, int texformat, bool rgbaOnly, u64 hash);
+
+// For tests: waits until the worker threads are done with the prefetch for the stage,
+// and returns the format it was decoded to, PC_TEX_FMT_NONE if it wasn't decoded.
+// The slot is left for GetPrefetched.
+PC_TexFormat WaitForPrefetch(unsigned int stage);
+
+}
@@ -18,6 +18,7 @@
 #include "Thread.h"
 #include "HW/Memmap.h"
 #include "PerfQueryBase.h"
+#include "TextureCacheBase.h"
 
 using namespace BPFunctions;
 
@@ -529,8 +530,10 @@ void BPWritten(const BPCmd& bp)
 		case BPMEM_TX_SETIMAGE1_4:
 		case BPMEM_TX_SETIMAGE2:
 		case BPMEM_TX_SETIMAGE2_4:
+			break;
 		case BPMEM_TX_SETIMAGE3:
 		case BPMEM_TX_SETIMAGE3_4:
+			TextureCache::Prefetch((bp.address & 3) | ((bp.address & 0x20) >> 3));
 			break;
 		// -------------------------------
 		// Set a TLUT
@@ -14,6 +14,8 @@
 #include "Debugger.h"
 #include "ConfigManager.h"
 #include "HW/Memmap.h"
+#include "HW/WriteWatch.h"
+#include "AsyncTextureDecoder.h"
 
 // ugly
 extern int frameCount;
@@ -29,6 +31,7 @@ GC_ALIGNED16(u8 *TextureCache::temp) = NULL;
 unsigned int TextureCache::temp_size;
 
 TextureCache::TexCache TextureCache::textures;
+TextureRangeIndex TextureCache::texture_ranges;
 
 TextureCache::BackupConfig TextureCache::backup_config;
 
@@ -51,6 +54,9 @@ TextureCache::TextureCache()
 
 	SetHash64Function(g_ActiveConfig.bHiresTextures || g_ActiveConfig.bDumpTextures);
 
+	if (g_ActiveConfig.bThreadedTextureDecoder)
+		AsyncTextureDecoder::Init();
+
 	invalidate_texture_cache_requested = false;
 }
 
@@ -68,10 +74,12 @@ void TextureCache::Invalidate()
 		delete iter->second;
 
 	textures.clear();
+	texture_ranges.Clear();
 }
 
 TextureCache::~TextureCache()
 {
+	AsyncTextureDecoder::Shutdown();
 	Invalidate();
 	if (temp)
 	{
@@ -102,6 +110,14 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 			invalidate_texture_cache_requested = false;
 		}
 
+		if (config.bThreadedTextureDecoder != AsyncTextureDecoder::IsRunning())
+		{
+			if (config.bThreadedTextureDecoder)
+				AsyncTextureDecoder::Init();
+			else
+				AsyncTextureDecoder::Shutdown();
+		}
+
 		// TODO: Probably shouldn't clear all render targets here, just mark them dirty or something.
 		if (config.bEFBCopyCacheEnable != backup_config.s_copy_cache_enable || // TODO: not sure if this is needed?
 			config.bCopyEFBToTexture != backup_config.s_copy_efb_to_texture ||
@@ -126,6 +142,8 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 
 void TextureCache::Cleanup()
 {
+	WriteWatch::CoolDown();
+
 	TexCache::iterator iter = textures.begin();
 	TexCache::iterator tcend = textures.end();
 	while (iter != tcend)
@@ -135,6 +153,7 @@ void TextureCache::Cleanup()
 			// EFB copies living on the host GPU are unrecoverable and thus shouldn't be deleted
 			&& ! iter->second->IsEfbCopy() )
 		{
+			texture_ranges.Erase(iter->first);
 			delete iter->second;
 			textures.erase(iter++);
 		}
@@ -147,53 +166,50 @@ void TextureCache::Cleanup()
 
 void TextureCache::InvalidateRange(u32 start_address, u32 size)
 {
-	TexCache::iterator
-		iter = textures.begin(),
-		tcend = textures.end();
-	while (iter != tcend)
+	std::vector<u32> ids;
+	texture_ranges.Find(start_address, size, &ids);
+
+	for (u32 texID : ids)
 	{
-		const int rangePosition = iter->second->IntersectsMemoryRange(start_address, size);
-		if (0 == rangePosition)
-		{
-			delete iter->second;
-			textures.erase(iter++);
-		}
-		else
-		{
-			++iter;
-		}
+		if (0 == textures[texID]->IntersectsMemoryRange(start_address, size))
+			RemoveEntry(texID);
 	}
 }
 
 void TextureCache::MakeRangeDynamic(u32 start_address, u32 size)
 {
-	TexCache::iterator
-		iter = textures.lower_bound(start_address),
-		tcend = textures.upper_bound(start_address + size);
-
-	if (iter != textures.begin())
-		--iter;
+	std::vector<u32> ids;
+	texture_ranges.Find(start_address, size, &ids);
 
-	for (; iter != tcend; ++iter)
+	for (u32 texID : ids)
 	{
-		const int rangePosition = iter->second->IntersectsMemoryRange(start_address, size);
-		if (0 == rangePosition)
+		TCacheEntryBase *entry = textures[texID];
+		if (0 == entry->IntersectsMemoryRange(start_address, size))
 		{
-			iter->second->SetHashes(TEXHASH_INVALID);
+			entry->SetHashes(TEXHASH_INVALID);
 		}
 	}
 }
 
 bool TextureCache::Find(u32 start_address, u64 hash)
 {
-	TexCache::iterator iter = textures.lower_bound(start_address);
+	// EFB copies always use their address as texture ID.
+	TexCache::iterator iter = textures.find(start_address);
 
-	if (iter->second->hash == hash)
+	if (iter != textures.end() && iter->second->hash == hash)
 		return true;
 
 	return false;
 }
 
+void TextureCache::RemoveEntry(u32 texID)
+{
+	TexCache::iterator iter = textures.find(texID);
+	texture_ranges.Erase(texID);
+	delete iter->second;
+	textures.erase(iter);
+}
+
 int TextureCache::TCacheEntryBase::IntersectsMemoryRange(u32 range_address, u32 range_size) const
 {
 	if (addr + size_in_bytes < range_address)
@@ -215,6 +231,7 @@ void TextureCache::ClearRenderTargets()
 	{
 		if (iter->second->type == TCET_EC_VRAM)
 		{
+			texture_ranges.Erase(iter->first);
 			delete iter->second;
 			textures.erase(iter++);
 		}
@@ -354,6 +371,8 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	// Hash assigned to texcache entry (also used to generate filenames used for texture dumping and custom texture lookup)
 	u64 tex_hash = TEXHASH_INVALID;
 	u64 tlut_hash = TEXHASH_INVALID;
+	u64 data_hash = TEXHASH_INVALID;
+	bool watched = false;
 
 	u32 full_format = texformat;
 	PC_TexFormat pcfmt = PC_TEX_FMT_NONE;
@@ -370,8 +389,6 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	else
 		src_data = Memory::GetPointer(address);
 
-	// TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data from the low tmem bank than it should)
-	tex_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
 	if (isPaletteTexture)
 	{
 		const u32 palette_size = TexDecoder_GetPaletteSize(texformat);
@@ -387,9 +404,29 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		//
 		// TODO: Because texID isn't always the same as the address now, CopyRenderTargetToTexture might be broken now
 		texID ^= ((u32)tlut_hash) ^(u32)(tlut_hash >> 32);
-		tex_hash ^= tlut_hash;
 	}
 
+	// If none of the pages of the texture were written since we last hashed it, the old hash is still good.
+	// The pages are write protected before hashing, so writes that happen while we're hashing aren't missed.
+	TexCache::iterator iter = textures.find(texID);
+	TCacheEntryBase *const cached = (iter != textures.end()) ? iter->second : NULL;
+	if (!from_tmem && cached && cached->data_hash != TEXHASH_INVALID && cached->addr == address &&
+		cached->size_in_bytes == texture_size && !WriteWatch::IsWritten(address, texture_size))
+	{
+		data_hash = cached->data_hash;
+		watched = true;
+	}
+	else
+	{
+		watched = !from_tmem && WriteWatch::Watch(address, texture_size);
+		// TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data from the low tmem bank than it should)
+		data_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+	}
+
+	tex_hash = data_hash;
+	if (isPaletteTexture)
+		tex_hash ^= tlut_hash;
+
 	// D3D doesn't like when the specified mipmap count would require more than one 1x1-sized LOD in the mipmap chain
 	// e.g. 64x64 with 7 LODs would have the mipmap chain 64x64,32x32,16x16,8x8,4x4,2x2,1x1,1x1, so we limit the mipmap count to 6 there
 	while (g_ActiveConfig.backend_info.bUseMinimalMipCount && max(expandedWidth, expandedHeight) >> maxlevel == 0)
@@ -468,7 +505,11 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	{
 		if (!(texformat == GX_TF_RGBA8 && from_tmem))
 		{
-			pcfmt = TexDecoder_Decode(temp, src_data, expandedWidth,
+			if (!from_tmem)
+				pcfmt = AsyncTextureDecoder::GetPrefetched(temp, stage, src_data, expandedWidth, expandedHeight,
+						texformat, g_ActiveConfig.backend_info.bUseRGBATextures, tex_hash);
+			if (pcfmt == PC_TEX_FMT_NONE)
+				pcfmt = AsyncTextureDecoder::Decode(temp, src_data, expandedWidth,
 						expandedHeight, texformat, tlutaddr, tlutfmt, g_ActiveConfig.backend_info.bUseRGBATextures);
 		}
 		else
@@ -509,7 +550,9 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 
 	entry->SetGeneralParameters(address, texture_size, full_format, entry->num_mipmaps);
 	entry->SetDimensions(nativeW, nativeH, width, height);
+	texture_ranges.Insert(texID, address, texture_size);
 	entry->hash = tex_hash;
+	entry->data_hash = watched ? data_hash : TEXHASH_INVALID;
 
 	if (entry->IsEfbCopy() && !g_ActiveConfig.bCopyEFBToTexture)
 		entry->type = TCET_EC_DYNAMIC;
@@ -545,7 +588,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 				const u8*& mip_src_data = from_tmem
 					? ((level % 2) ? ptr_odd : ptr_even)
 					: src_data;
-				TexDecoder_Decode(temp, mip_src_data, expanded_mip_width, expanded_mip_height, texformat, tlutaddr, tlutfmt, g_ActiveConfig.backend_info.bUseRGBATextures);
+				AsyncTextureDecoder::Decode(temp, mip_src_data, expanded_mip_width, expanded_mip_height, texformat, tlutaddr, tlutfmt, g_ActiveConfig.backend_info.bUseRGBATextures);
 				mip_src_data += TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
 
 				entry->Load(mip_width, mip_height, expanded_mip_width, level);
@@ -573,6 +616,45 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	return ReturnEntry(stage, entry);
 }
 
+// Called when a texture address gets written to the BP registers, which is usually
+// a while before a draw call uses the texture.
+void TextureCache::Prefetch(unsigned int stage)
+{
+	if (!g_texture_cache || !AsyncTextureDecoder::IsRunning() || g_ActiveConfig.bHiresTextures)
+		return;
+
+	const FourTexUnits &tex = bpmem.tex[stage >> 2];
+	const u32 address = tex.texImage3[stage & 3].image_base << 5;
+	const int texformat = tex.texImage0[stage & 3].format;
+
+	// Preloaded textures may still be in the middle of being copied to TMEM.
+	if (0 == address || tex.texImage1[stage & 3].image_type != 0 || !AsyncTextureDecoder::IsThreadedFormat(texformat))
+		return;
+
+	const unsigned int bsw = TexDecoder_GetBlockWidthInTexels(texformat) - 1;
+	const unsigned int bsh = TexDecoder_GetBlockHeightInTexels(texformat) - 1;
+	const unsigned int expandedWidth = (tex.texImage0[stage & 3].width + 1 + bsw) & (~bsw);
+	const unsigned int expandedHeight = (tex.texImage0[stage & 3].height + 1 + bsh) & (~bsh);
+
+	// Nothing has checked the address yet, and the size and format may still
+	// be those of the previous texture on this stage.
+	const u32 texture_size = TexDecoder_GetTextureSizeInBytes(expandedWidth, expandedHeight, texformat);
+	if (!Memory::IsRAMAddress(address) || !Memory::IsRAMAddress(address + texture_size - 1))
+		return;
+
+	u64 known_hash = TEXHASH_INVALID;
+	TexCache::iterator iter = textures.find(address);
+	if (iter != textures.end())
+	{
+		if (iter->second->IsEfbCopy())
+			return;
+		known_hash = iter->second->hash;
+	}
+
+	AsyncTextureDecoder::Prefetch(stage, Memory::GetPointer(address), expandedWidth, expandedHeight, texformat,
+		g_ActiveConfig.backend_info.bUseRGBATextures, known_hash, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+}
+
 void TextureCache::CopyRenderTargetToTexture(u32 dstAddr, unsigned int dstFormat, unsigned int srcFormat,
 	const EFBRectangle& srcRect, bool isIntensity, bool scaleByHalf)
 {
@@ -879,7 +961,9 @@ void TextureCache::CopyRenderTargetToTexture(u32 dstAddr, unsigned int dstFormat
 		// TODO: Using the wrong dstFormat, dumb...
 		entry->SetGeneralParameters(dstAddr, 0, dstFormat, 1);
 		entry->SetDimensions(tex_w, tex_h, scaled_tex_w, scaled_tex_h);
+		texture_ranges.Insert(dstAddr, dstAddr, 0);
 		entry->SetHashes(TEXHASH_INVALID);
+		entry->data_hash = TEXHASH_INVALID;
 		entry->type = TCET_EC_VRAM;
 	}
 
@@ -4,12 +4,13 @@
 
 #pragma once
 
-#include <map>
+#include <unordered_map>
 
 #include "VideoCommon.h"
 #include "TextureDecoder.h"
 #include "BPMemory.h"
 #include "Thread.h"
+#include "TextureRangeIndex.h"
 
 #include "CommonTypes.h"
 
@@ -34,6 +35,7 @@ public:
 		u32 size_in_bytes;
 		u64 hash;
 		//u32 pal_hash;
+		u64 data_hash; // hash of the RAM data without the TLUT, TEXHASH_INVALID unless its pages are write watched
 		u32 format;
 
 		enum TexCacheEntryType type;
@@ -103,6 +105,7 @@ public:
 
 	static TCacheEntryBase* Load(unsigned int stage, u32 address, unsigned int width, unsigned int height,
 		int format, unsigned int tlutaddr, int tlutfmt, bool use_mipmaps, unsigned int maxlevel, bool from_tmem);
+	static void Prefetch(unsigned int stage);
 	static void CopyRenderTargetToTexture(u32 dstAddr, unsigned int dstFormat, unsigned int srcFormat,
 		const EFBRectangle& srcRect, bool isIntensity, bool scaleByHalf);
 
@@ -119,9 +122,13 @@ private:
 	static PC_TexFormat LoadCustomTexture(u64 tex_hash, int texformat, unsigned int level, unsigned int& width, unsigned int& height);
 	static void DumpTexture(TCacheEntryBase* entry, unsigned int level);
 
-	typedef std::map<u32, TCacheEntryBase*> TexCache;
+	static void RemoveEntry(u32 texID);
+
+	// Keyed by texture ID, see Load
+	typedef std::unordered_map<u32, TCacheEntryBase*> TexCache;
 
 	static TexCache textures;
+	static TextureRangeIndex texture_ranges;
 
 	// Backup configuration values
 	static struct BackupConfig
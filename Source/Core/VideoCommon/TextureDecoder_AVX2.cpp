@@ -0,0 +1,493 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// AVX2 versions of the slowest decoders in TextureDecoder_x64.cpp.
+// The paletted formats look up eight TLUT entries at once with a gather, I4, IA4
+// and RGB5A3 are expanded with 256-bit shuffles, and CMPR picks the colors of two
+// rows of a DXT block with a single permute. TextureDecoder_x64.cpp only calls
+// these when cpu_info.bAVX2 is set, and they have to produce exactly the same
+// output as the decoders they replace.
+
+#include "Common.h"
+#include "LookUpTables.h"
+#include "TextureDecoder.h"
+
+#include <immintrin.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#elif defined __GNUC__
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif
+
+#define AVX2_FUNC ATTRIBUTE_TARGET("avx2")
+
+namespace
+{
+
+enum TLUTDecode
+{
+	TLUT_RAW16,     // Byteswapped TLUT entries, for the PC_TEX_FMT_IA8/RGB565 textures
+	TLUT_5A3_BGRA,
+	TLUT_5A3_RGBA,
+	TLUT_IA8_RGBA,
+	TLUT_565_RGBA,
+};
+
+// Byteswaps the low 16 bits of each 32-bit lane, and clears the high ones.
+AVX2_FUNC inline __m256i Swap16Lanes(__m256i v)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		1, 0, -128, -128, 5, 4, -128, -128, 9, 8, -128, -128, 13, 12, -128, -128,
+		1, 0, -128, -128, 5, 4, -128, -128, 9, 8, -128, -128, 13, 12, -128, -128);
+	return _mm256_shuffle_epi8(v, mask);
+}
+
+// 8 values of up to 16 bits, in 32-bit lanes -> 8 packed u16
+AVX2_FUNC inline __m128i Pack16(__m256i v)
+{
+	const __m256i packed = _mm256_packus_epi32(v, v);
+	return _mm256_castsi256_si128(_mm256_permute4x64_epi64(packed, 0x08));
+}
+
+// Same as Convert4To8 on every byte, as long as the high nibbles are clear.
+AVX2_FUNC inline __m256i Expand4To8(__m256i v)
+{
+	return _mm256_or_si256(_mm256_slli_epi16(v, 4), v);
+}
+
+AVX2_FUNC inline __m256i Expand5To8(__m256i v)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(v, 3), _mm256_srli_epi32(v, 2));
+}
+
+// decode5A3/decode5A3RGBA on the (byteswapped) 16-bit value in each 32-bit lane
+template <bool rgba>
+AVX2_FUNC inline __m256i Decode5A3(__m256i v)
+{
+	const __m256i mask_1f = _mm256_set1_epi32(0x1F);
+	const __m256i mask_0f = _mm256_set1_epi32(0x0F);
+
+	// RGB555, opaque
+	const __m256i r5 = Expand5To8(_mm256_and_si256(_mm256_srli_epi32(v, 10), mask_1f));
+	const __m256i g5 = Expand5To8(_mm256_and_si256(_mm256_srli_epi32(v, 5), mask_1f));
+	const __m256i b5 = Expand5To8(_mm256_and_si256(v, mask_1f));
+
+	// RGB4A3
+	const __m256i a3 = _mm256_and_si256(_mm256_srli_epi32(v, 12), _mm256_set1_epi32(0x7));
+	const __m256i a = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(a3, 5), _mm256_slli_epi32(a3, 2)), _mm256_srli_epi32(a3, 1));
+	const __m256i r4 = Expand4To8(_mm256_and_si256(_mm256_srli_epi32(v, 8), mask_0f));
+	const __m256i g4 = Expand4To8(_mm256_and_si256(_mm256_srli_epi32(v, 4), mask_0f));
+	const __m256i b4 = Expand4To8(_mm256_and_si256(v, mask_0f));
+
+	const __m256i opaque = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 31);
+	const __m256i r = _mm256_blendv_epi8(r4, r5, opaque);
+	const __m256i g = _mm256_blendv_epi8(g4, g5, opaque);
+	const __m256i b = _mm256_blendv_epi8(b4, b5, opaque);
+	const __m256i alpha = _mm256_slli_epi32(_mm256_blendv_epi8(a, _mm256_set1_epi32(0xFF), opaque), 24);
+
+	if (rgba)
+		return _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)), _mm256_or_si256(_mm256_slli_epi32(b, 16), alpha));
+	else
+		return _mm256_or_si256(_mm256_or_si256(b, _mm256_slli_epi32(g, 8)), _mm256_or_si256(_mm256_slli_epi32(r, 16), alpha));
+}
+
+// decode565RGBA on the (byteswapped) 16-bit value in each 32-bit lane
+AVX2_FUNC inline __m256i Decode565RGBA(__m256i v)
+{
+	const __m256i mask_1f = _mm256_set1_epi32(0x1F);
+	const __m256i r = Expand5To8(_mm256_and_si256(_mm256_srli_epi32(v, 11), mask_1f));
+	const __m256i g6 = _mm256_and_si256(_mm256_srli_epi32(v, 5), _mm256_set1_epi32(0x3F));
+	const __m256i g = _mm256_or_si256(_mm256_slli_epi32(g6, 2), _mm256_srli_epi32(g6, 4));
+	const __m256i b = Expand5To8(_mm256_and_si256(v, mask_1f));
+	return _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+		_mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_set1_epi32(0xFF000000)));
+}
+
+// Looks up the TLUT entries for 8 texels. TLUT_RAW16 leaves one 16-bit entry in
+// each 32-bit lane, the others return the decoded colors.
+template <int mode>
+AVX2_FUNC inline __m256i LookupTLUT(const u8 *tlut, __m256i indices)
+{
+	// Reads the following entry into the high half of each lane as well, which is
+	// fine: even a C14X2 TLUT at the highest TLUT address stays within TMEM.
+	const __m256i entries = _mm256_i32gather_epi32((const int*)tlut, indices, 2);
+
+	switch (mode)
+	{
+	case TLUT_RAW16:
+		return Swap16Lanes(entries);
+	case TLUT_5A3_BGRA:
+		return Decode5A3<false>(Swap16Lanes(entries));
+	case TLUT_5A3_RGBA:
+		return Decode5A3<true>(Swap16Lanes(entries));
+	case TLUT_IA8_RGBA:
+	{
+		// decodeIA8Swapped: intensity in the second byte, alpha in the first one
+		const __m256i mask = _mm256_setr_epi8(
+			1, 1, 1, 0, 5, 5, 5, 4, 9, 9, 9, 8, 13, 13, 13, 12,
+			1, 1, 1, 0, 5, 5, 5, 4, 9, 9, 9, 8, 13, 13, 13, 12);
+		return _mm256_shuffle_epi8(entries, mask);
+	}
+	default:
+		return Decode565RGBA(Swap16Lanes(entries));
+	}
+}
+
+// 8 texels of one row
+template <int mode>
+AVX2_FUNC inline void StoreRow(u8 *dst, __m256i texels)
+{
+	if (mode == TLUT_RAW16)
+		_mm_storeu_si128((__m128i*)dst, Pack16(texels));
+	else
+		_mm256_storeu_si256((__m256i*)dst, texels);
+}
+
+// 4 texels of two rows each
+template <int mode>
+AVX2_FUNC inline void StoreRows(u8 *dst0, u8 *dst1, __m256i texels)
+{
+	if (mode == TLUT_RAW16)
+	{
+		const __m128i packed = Pack16(texels);
+		_mm_storel_epi64((__m128i*)dst0, packed);
+		_mm_storel_epi64((__m128i*)dst1, _mm_unpackhi_epi64(packed, packed));
+	}
+	else
+	{
+		_mm_storeu_si128((__m128i*)dst0, _mm256_castsi256_si128(texels));
+		_mm_storeu_si128((__m128i*)dst1, _mm256_extracti128_si256(texels, 1));
+	}
+}
+
+template <int mode>
+AVX2_FUNC void DecodeC4(u8 *dst, const u8 *src, int width, int height, int tlutaddr)
+{
+	const int texel_size = (mode == TLUT_RAW16) ? 2 : 4;
+	const int Wsteps8 = (width + 7) / 8;
+	const u8 *tlut = texMem + tlutaddr;
+	const __m128i mask_0f = _mm_set1_epi8(0x0F);
+
+	#pragma omp parallel for
+	for (int y = 0; y < height; y += 8)
+		for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+			for (int iy = 0, xStep = yStep * 8; iy < 8; iy++, xStep++)
+			{
+				// 4 bytes -> 8 indices, high nibble first
+				const __m128i bytes = _mm_cvtsi32_si128(*(const s32*)(src + 4 * xStep));
+				const __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask_0f);
+				const __m128i lo = _mm_and_si128(bytes, mask_0f);
+				const __m256i indices = _mm256_cvtepu8_epi32(_mm_unpacklo_epi8(hi, lo));
+
+				StoreRow<mode>(dst + ((y + iy) * width + x) * texel_size, LookupTLUT<mode>(tlut, indices));
+			}
+}
+
+template <int mode>
+AVX2_FUNC void DecodeC8(u8 *dst, const u8 *src, int width, int height, int tlutaddr)
+{
+	const int texel_size = (mode == TLUT_RAW16) ? 2 : 4;
+	const int Wsteps8 = (width + 7) / 8;
+	const u8 *tlut = texMem + tlutaddr;
+
+	#pragma omp parallel for
+	for (int y = 0; y < height; y += 4)
+		for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+			for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+			{
+				const __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+				StoreRow<mode>(dst + ((y + iy) * width + x) * texel_size, LookupTLUT<mode>(tlut, indices));
+			}
+}
+
+template <int mode>
+AVX2_FUNC void DecodeC14X2(u8 *dst, const u8 *src, int width, int height, int tlutaddr)
+{
+	const int texel_size = (mode == TLUT_RAW16) ? 2 : 4;
+	const int Wsteps4 = (width + 3) / 4;
+	const u8 *tlut = texMem + tlutaddr;
+	const __m256i mask_index = _mm256_set1_epi32(0x3FFF);
+
+	#pragma omp parallel for
+	for (int y = 0; y < height; y += 4)
+		for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+			for (int iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+			{
+				// Two rows of 4 big endian indices
+				const __m256i raw = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + 8 * xStep)));
+				const __m256i indices = _mm256_and_si256(Swap16Lanes(raw), mask_index);
+				StoreRows<mode>(dst + ((y + iy) * width + x) * texel_size, dst + ((y + iy + 1) * width + x) * texel_size,
+					LookupTLUT<mode>(tlut, indices));
+			}
+}
+
+// Unpacks the nibbles of a whole I4 tile (8x8 texels) or IA4 tile (8x4 texels).
+// Returns Convert4To8 of the low nibbles in lo, and of the high nibbles in hi.
+AVX2_FUNC inline void ExpandNibbles(const u8 *src, __m256i *lo, __m256i *hi)
+{
+	const __m256i mask_0f = _mm256_set1_epi8(0x0F);
+	const __m256i v = _mm256_loadu_si256((const __m256i*)src);
+	*lo = Expand4To8(_mm256_and_si256(v, mask_0f));
+	*hi = Expand4To8(_mm256_and_si256(_mm256_srli_epi16(v, 4), mask_0f));
+}
+
+template <bool rgba>
+AVX2_FUNC void DecodeI4(u8 *dst, const u8 *src, int width, int height)
+{
+	const int Wsteps8 = (width + 7) / 8;
+	const __m256i expand = _mm256_setr_epi8(
+		0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+		4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+
+	#pragma omp parallel for
+	for (int y = 0; y < height; y += 8)
+		for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+		{
+			__m256i lo, hi;
+			ExpandNibbles(src + 32 * yStep, &lo, &hi);
+
+			// Each source row is 4 bytes, high nibble first.
+			// rows01 holds rows 0 and 1 in the low lane, rows 4 and 5 in the high lane.
+			const __m256i rows01 = _mm256_unpacklo_epi8(hi, lo);
+			const __m256i rows23 = _mm256_unpackhi_epi8(hi, lo);
+			const __m128i rows[8] = {
+				_mm256_castsi256_si128(rows01), _mm_unpackhi_epi64(_mm256_castsi256_si128(rows01), _mm256_castsi256_si128(rows01)),
+				_mm256_castsi256_si128(rows23), _mm_unpackhi_epi64(_mm256_castsi256_si128(rows23), _mm256_castsi256_si128(rows23)),
+				_mm256_extracti128_si256(rows01, 1), _mm_unpackhi_epi64(_mm256_extracti128_si256(rows01, 1), _mm256_extracti128_si256(rows01, 1)),
+				_mm256_extracti128_si256(rows23, 1), _mm_unpackhi_epi64(_mm256_extracti128_si256(rows23, 1), _mm256_extracti128_si256(rows23, 1)),
+			};
+
+			for (int iy = 0; iy < 8; iy++)
+			{
+				if (rgba)
+				{
+					const __m256i texels = _mm256_shuffle_epi8(_mm256_broadcastq_epi64(rows[iy]), expand);
+					_mm256_storeu_si256((__m256i*)(dst + ((y + iy) * width + x) * 4), texels);
+				}
+				else
+				{
+					_mm_storel_epi64((__m128i*)(dst + (y + iy) * width + x), rows[iy]);
+				}
+			}
+		}
+}
+
+template <bool rgba>
+AVX2_FUNC void DecodeIA4(u8 *dst, const u8 *src, int width, int height)
+{
+	const int Wsteps8 = (width + 7) / 8;
+	const __m256i expand = _mm256_setr_epi8(
+		0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7,
+		8, 8, 8, 9, 10, 10, 10, 11, 12, 12, 12, 13, 14, 14, 14, 15);
+
+	#pragma omp parallel for
+	for (int y = 0; y < height; y += 4)
+		for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+		{
+			__m256i lo, hi;
+			ExpandNibbles(src + 32 * yStep, &lo, &hi);
+
+			// Intensity in the low nibble, alpha in the high one.
+			// rows02 holds row 0 in the low lane and row 2 in the high lane.
+			const __m256i rows02 = _mm256_unpacklo_epi8(lo, hi);
+			const __m256i rows13 = _mm256_unpackhi_epi8(lo, hi);
+			const __m128i rows[4] = {
+				_mm256_castsi256_si128(rows02), _mm256_castsi256_si128(rows13),
+				_mm256_extracti128_si256(rows02, 1), _mm256_extracti128_si256(rows13, 1),
+			};
+
+			for (int iy = 0; iy < 4; iy++)
+			{
+				if (rgba)
+				{
+					const __m256i texels = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(rows[iy]), expand);
+					_mm256_storeu_si256((__m256i*)(dst + ((y + iy) * width + x) * 4), texels);
+				}
+				else
+				{
+					_mm_storeu_si128((__m128i*)(dst + ((y + iy) * width + x) * 2), rows[iy]);
+				}
+			}
+		}
+}
+
+template <bool rgba>
+AVX2_FUNC void DecodeRGB5A3(u8 *dst, const u8 *src, int width, int height)
+{
+	const int Wsteps4 = (width + 3) / 4;
+
+	#pragma omp parallel for
+	for (int y = 0; y < height; y += 4)
+		for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+			for (int iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+			{
+				const __m256i raw = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + 8 * xStep)));
+				const __m256i texels = Decode5A3<rgba>(Swap16Lanes(raw));
+				_mm_storeu_si128((__m128i*)(dst + ((y + iy) * width + x) * 4), _mm256_castsi256_si128(texels));
+				_mm_storeu_si128((__m128i*)(dst + ((y + iy + 1) * width + x) * 4), _mm256_extracti128_si256(texels, 1));
+			}
+}
+
+// Same as decodeDXTBlock/decodeDXTBlockRGBA
+template <bool rgba>
+AVX2_FUNC inline void DecodeDXTBlock(u32 *dst, const u8 *src, int pitch)
+{
+	const u16 c1 = Common::swap16(*(const u16*)src);
+	const u16 c2 = Common::swap16(*(const u16*)(src + 2));
+	const int blue1 = Convert5To8(c1 & 0x1F);
+	const int blue2 = Convert5To8(c2 & 0x1F);
+	const int green1 = Convert6To8((c1 >> 5) & 0x3F);
+	const int green2 = Convert6To8((c2 >> 5) & 0x3F);
+	const int red1 = Convert5To8((c1 >> 11) & 0x1F);
+	const int red2 = Convert5To8((c2 >> 11) & 0x1F);
+
+	int r[4], g[4], b[4], a[4];
+	r[0] = red1; g[0] = green1; b[0] = blue1; a[0] = 255;
+	r[1] = red2; g[1] = green2; b[1] = blue2; a[1] = 255;
+	if (c1 > c2)
+	{
+		const int blue3 = ((blue2 - blue1) >> 1) - ((blue2 - blue1) >> 3);
+		const int green3 = ((green2 - green1) >> 1) - ((green2 - green1) >> 3);
+		const int red3 = ((red2 - red1) >> 1) - ((red2 - red1) >> 3);
+		r[2] = red1 + red3; g[2] = green1 + green3; b[2] = blue1 + blue3; a[2] = 255;
+		r[3] = red2 - red3; g[3] = green2 - green3; b[3] = blue2 - blue3; a[3] = 255;
+	}
+	else
+	{
+		r[2] = (red1 + red2 + 1) / 2; g[2] = (green1 + green2 + 1) / 2; b[2] = (blue1 + blue2 + 1) / 2; a[2] = 255;
+		r[3] = red2; g[3] = green2; b[3] = blue2; a[3] = 0;
+	}
+
+	int colors[4];
+	for (int i = 0; i < 4; i++)
+		colors[i] = rgba ? ((a[i] << 24) | (b[i] << 16) | (g[i] << 8) | r[i]) : ((a[i] << 24) | (r[i] << 16) | (g[i] << 8) | b[i]);
+	const __m256i palette = _mm256_setr_epi32(colors[0], colors[1], colors[2], colors[3], colors[0], colors[1], colors[2], colors[3]);
+
+	// One byte of 2-bit indices per row, leftmost texel in the top bits.
+	const __m256i lines = _mm256_set1_epi32(*(const s32*)(src + 4));
+	const __m256i mask_3 = _mm256_set1_epi32(3);
+	const __m256i indices01 = _mm256_and_si256(_mm256_srlv_epi32(lines, _mm256_setr_epi32(6, 4, 2, 0, 14, 12, 10, 8)), mask_3);
+	const __m256i indices23 = _mm256_and_si256(_mm256_srlv_epi32(lines, _mm256_setr_epi32(22, 20, 18, 16, 30, 28, 26, 24)), mask_3);
+	const __m256i rows01 = _mm256_permutevar8x32_epi32(palette, indices01);
+	const __m256i rows23 = _mm256_permutevar8x32_epi32(palette, indices23);
+
+	_mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(rows01));
+	_mm_storeu_si128((__m128i*)(dst + pitch), _mm256_extracti128_si256(rows01, 1));
+	_mm_storeu_si128((__m128i*)(dst + pitch * 2), _mm256_castsi256_si128(rows23));
+	_mm_storeu_si128((__m128i*)(dst + pitch * 3), _mm256_extracti128_si256(rows23, 1));
+}
+
+template <bool rgba>
+AVX2_FUNC void DecodeCMPR(u32 *dst, const u8 *src, int width, int height)
+{
+	const int Wsteps8 = (width + 7) / 8;
+
+	#pragma omp parallel for
+	for (int y = 0; y < height; y += 8)
+		for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+		{
+			// 4 DXT blocks of 8 bytes, in Z order
+			const u8 *src2 = src + 32 * yStep;
+			DecodeDXTBlock<rgba>(dst + y * width + x, src2, width);
+			DecodeDXTBlock<rgba>(dst + y * width + x + 4, src2 + 8, width);
+			DecodeDXTBlock<rgba>(dst + (y + 4) * width + x, src2 + 16, width);
+			DecodeDXTBlock<rgba>(dst + (y + 4) * width + x + 4, src2 + 24, width);
+		}
+}
+
+}
+
+// Returns false for formats without an AVX2 decoder.
+bool TexDecoder_Decode_AVX2(u8 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, int tlutfmt, PC_TexFormat *pcfmt)
+{
+	switch (texformat)
+	{
+	case GX_TF_C4:
+		if (tlutfmt == 2)
+			DecodeC4<TLUT_5A3_BGRA>(dst, src, width, height, tlutaddr);
+		else
+			DecodeC4<TLUT_RAW16>(dst, src, width, height, tlutaddr);
+		*pcfmt = GetPC_TexFormat(texformat, tlutfmt);
+		return true;
+	case GX_TF_C8:
+		if (tlutfmt == 2)
+			DecodeC8<TLUT_5A3_BGRA>(dst, src, width, height, tlutaddr);
+		else
+			DecodeC8<TLUT_RAW16>(dst, src, width, height, tlutaddr);
+		*pcfmt = GetPC_TexFormat(texformat, tlutfmt);
+		return true;
+	case GX_TF_C14X2:
+		if (tlutfmt == 2)
+			DecodeC14X2<TLUT_5A3_BGRA>(dst, src, width, height, tlutaddr);
+		else
+			DecodeC14X2<TLUT_RAW16>(dst, src, width, height, tlutaddr);
+		*pcfmt = GetPC_TexFormat(texformat, tlutfmt);
+		return true;
+	case GX_TF_I4:
+		DecodeI4<false>(dst, src, width, height);
+		*pcfmt = PC_TEX_FMT_I4_AS_I8;
+		return true;
+	case GX_TF_IA4:
+		DecodeIA4<false>(dst, src, width, height);
+		*pcfmt = PC_TEX_FMT_IA4_AS_IA8;
+		return true;
+	case GX_TF_RGB5A3:
+		DecodeRGB5A3<false>(dst, src, width, height);
+		*pcfmt = PC_TEX_FMT_BGRA32;
+		return true;
+	case GX_TF_CMPR:
+		DecodeCMPR<false>((u32*)dst, src, width, height);
+		*pcfmt = PC_TEX_FMT_BGRA32;
+		return true;
+	}
+	return false;
+}
+
+// Returns false for formats without an AVX2 decoder, PC_TEX_FMT_RGBA32 is implied otherwise.
+bool TexDecoder_Decode_RGBA_AVX2(u32 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, int tlutfmt)
+{
+	u8 *dst8 = (u8*)dst;
+	switch (texformat)
+	{
+	case GX_TF_C4:
+		if (tlutfmt == 2)
+			DecodeC4<TLUT_5A3_RGBA>(dst8, src, width, height, tlutaddr);
+		else if (tlutfmt == 0)
+			DecodeC4<TLUT_IA8_RGBA>(dst8, src, width, height, tlutaddr);
+		else
+			DecodeC4<TLUT_565_RGBA>(dst8, src, width, height, tlutaddr);
+		return true;
+	case GX_TF_C8:
+		if (tlutfmt == 2)
+			DecodeC8<TLUT_5A3_RGBA>(dst8, src, width, height, tlutaddr);
+		else if (tlutfmt == 0)
+			DecodeC8<TLUT_IA8_RGBA>(dst8, src, width, height, tlutaddr);
+		else
+			DecodeC8<TLUT_565_RGBA>(dst8, src, width, height, tlutaddr);
+		return true;
+	case GX_TF_C14X2:
+		// The other decoders use BGRA order for RGB5A3 TLUTs here as well.
+		if (tlutfmt == 2)
+			DecodeC14X2<TLUT_5A3_BGRA>(dst8, src, width, height, tlutaddr);
+		else if (tlutfmt == 0)
+			DecodeC14X2<TLUT_IA8_RGBA>(dst8, src, width, height, tlutaddr);
+		else
+			DecodeC14X2<TLUT_565_RGBA>(dst8, src, width, height, tlutaddr);
+		return true;
+	case GX_TF_I4:
+		DecodeI4<true>(dst8, src, width, height);
+		return true;
+	case GX_TF_IA4:
+		DecodeIA4<true>(dst8, src, width, height);
+		return true;
+	case GX_TF_RGB5A3:
+		DecodeRGB5A3<true>(dst8, src, width, height);
+		return true;
+	case GX_TF_CMPR:
+		DecodeCMPR<true>(dst, src, width, height);
+		return true;
+	}
+	return false;
+}
@@ -676,6 +676,11 @@ PC_TexFormat GetPC_TexFormat(int texformat, int tlutfmt)
 	return PC_TEX_FMT_NONE;
 }
 
+// TextureDecoder_AVX2.cpp, only valid if cpu_info.bAVX2 is set.
+// Both return false for the formats they don't handle.
+bool TexDecoder_Decode_AVX2(u8 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, int tlutfmt, PC_TexFormat *pcfmt);
+bool TexDecoder_Decode_RGBA_AVX2(u32 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, int tlutfmt);
+
 inline void SetOpenMPThreadCount(int width, int height)
 {
 #ifdef _OPENMP
@@ -700,6 +705,10 @@ PC_TexFormat TexDecoder_Decode_real(u8 *dst, const u8 *src, int width, int heigh
 {
 	SetOpenMPThreadCount(width, height);
 
+	PC_TexFormat pcfmt;
+	if (cpu_info.bAVX2 && TexDecoder_Decode_AVX2(dst, src, width, height, texformat, tlutaddr, tlutfmt, &pcfmt))
+		return pcfmt;
+
 	const int Wsteps4 = (width + 3) / 4;
 	const int Wsteps8 = (width + 7) / 8;
 
@@ -967,6 +976,9 @@ PC_TexFormat TexDecoder_Decode_RGBA(u32 * dst, const u8 * src, int width, int he
 {
 	SetOpenMPThreadCount(width, height);
 
+	if (cpu_info.bAVX2 && TexDecoder_Decode_RGBA_AVX2(dst, src, width, height, texformat, tlutaddr, tlutfmt))
+		return PC_TEX_FMT_RGBA32;
+
 	const int Wsteps4 = (width + 3) / 4;
 	const int Wsteps8 = (width + 7) / 8;
 
@@ -0,0 +1,83 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "TextureRangeIndex.h"
+
+void TextureRangeIndex::Insert(u32 id, u32 addr, u32 size)
+{
+	Range range;
+	range.first_page = addr >> PAGE_SHIFT;
+	range.last_page = (addr + size) >> PAGE_SHIFT;
+
+	auto iter = m_ranges.find(id);
+	if (iter != m_ranges.end())
+	{
+		if (iter->second.first_page == range.first_page && iter->second.last_page == range.last_page)
+			return;
+		Erase(id);
+	}
+
+	m_ranges[id] = range;
+	for (u32 page = range.first_page; page <= range.last_page; ++page)
+		m_pages[page].push_back(id);
+}
+
+void TextureRangeIndex::Erase(u32 id)
+{
+	auto iter = m_ranges.find(id);
+	if (iter == m_ranges.end())
+		return;
+
+	for (u32 page = iter->second.first_page; page <= iter->second.last_page; ++page)
+	{
+		auto bucket = m_pages.find(page);
+		std::vector<u32> &ids = bucket->second;
+		auto pos = std::find(ids.begin(), ids.end(), id);
+		*pos = ids.back();
+		ids.pop_back();
+		if (ids.empty())
+			m_pages.erase(bucket);
+	}
+	m_ranges.erase(iter);
+}
+
+void TextureRangeIndex::Clear()
+{
+	m_ranges.clear();
+	m_pages.clear();
+}
+
+void TextureRangeIndex::Find(u32 start, u32 size, std::vector<u32>* ids) const
+{
+	const u32 first_page = start >> PAGE_SHIFT;
+	const u32 last_page = (start + size) >> PAGE_SHIFT;
+
+	// Invalidating most of RAM, going through the entries is quicker.
+	if (last_page - first_page >= m_ranges.size())
+	{
+		for (const auto &entry : m_ranges)
+		{
+			if (entry.second.first_page <= last_page && entry.second.last_page >= first_page)
+				ids->push_back(entry.first);
+		}
+		return;
+	}
+
+	for (u32 page = first_page; page <= last_page; ++page)
+	{
+		auto bucket = m_pages.find(page);
+		if (bucket == m_pages.end())
+			continue;
+
+		for (u32 id : bucket->second)
+		{
+			// Entries spanning several pages are only reported for the first page both have in common.
+			const Range &range = m_ranges.find(id)->second;
+			if (std::max(range.first_page, first_page) == page)
+				ids->push_back(id);
+		}
+	}
+}
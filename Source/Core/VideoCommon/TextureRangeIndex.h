@@ -0,0 +1,46 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "CommonTypes.h"
+
+// Remembers which pages of guest memory each texture cache entry covers, so
+// the entries overlapping a range of memory can be found without looking at
+// every single entry. Entries are identified by their texture cache key.
+//
+// Like TCacheEntryBase::IntersectsMemoryRange, the ranges include their last
+// byte, i.e. an entry covers [addr, addr + size].
+class TextureRangeIndex
+{
+public:
+	// Replaces the range the entry was inserted with before, if any.
+	void Insert(u32 id, u32 addr, u32 size);
+	void Erase(u32 id);
+	void Clear();
+
+	size_t Size() const { return m_ranges.size(); }
+
+	// Appends each entry whose pages touch [start, start + size] to ids, once.
+	// Callers still have to check whether these really overlap the range.
+	void Find(u32 start, u32 size, std::vector<u32>* ids) const;
+
+private:
+	enum
+	{
+		PAGE_SHIFT = 12,
+	};
+
+	struct Range
+	{
+		u32 first_page;
+		u32 last_page;
+	};
+
+	std::unordered_map<u32, Range> m_ranges;
+	std::unordered_map<u32, std::vector<u32>> m_pages;
+};
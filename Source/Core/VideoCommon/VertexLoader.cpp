@@ -782,6 +782,9 @@ void VertexLoader::CompileVertexTranslator()
 	J_CC(CC_NZ, loop_start, true);
 	ABI_PopAllCalleeSavedRegsAndAdjustStack();
 	RET();
+
+	JitRegister::Register(m_compiledCode, (u32)(GetCodePtr() - m_compiledCode), "JIT_VertexLoader_%08x%08x",
+	                      (u32)(m_VtxDesc.Hex >> 32), (u32)m_VtxDesc.Hex);
 #endif
 	m_NativeFmt = g_vertex_manager->CreateNativeVertexFormat();
 	m_NativeFmt->m_components = components;
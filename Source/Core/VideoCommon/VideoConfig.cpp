@@ -81,6 +81,7 @@ void VideoConfig::Load(const char *ini_file)
 	iniFile.Get("Settings", "DisableFog", &bDisableFog, 0);
 
 	iniFile.Get("Settings", "OMPDecoder", &bOMPDecoder, false);
+	iniFile.Get("Settings", "ThreadedTextureDecoder", &bThreadedTextureDecoder, false);
 
 	iniFile.Get("Settings", "EnableShaderDebugging", &bEnableShaderDebugging, false);
 
@@ -181,6 +182,7 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Settings", "DstAlphaPass", bDstAlphaPass);
 	CHECK_SETTING("Video_Settings", "DisableFog", bDisableFog);
 	CHECK_SETTING("Video_Settings", "OMPDecoder", bOMPDecoder);
+	CHECK_SETTING("Video_Settings", "ThreadedTextureDecoder", bThreadedTextureDecoder);
 
 	CHECK_SETTING("Video_Enhancements", "ForceFiltering", bForceFiltering);
 	CHECK_SETTING("Video_Enhancements", "MaxAnisotropy", iMaxAnisotropy);  // NOTE - this is x in (1 << x)
@@ -257,6 +259,7 @@ void VideoConfig::Save(const char *ini_file)
 	iniFile.Set("Settings", "DisableFog", bDisableFog);
 
 	iniFile.Set("Settings", "OMPDecoder", bOMPDecoder);
+	iniFile.Set("Settings", "ThreadedTextureDecoder", bThreadedTextureDecoder);
 
 	iniFile.Set("Settings", "EnableShaderDebugging", bEnableShaderDebugging);
 
@@ -69,6 +69,7 @@ struct VideoConfig
 
 	// OpenMP
 	bool bOMPDecoder;
+	bool bThreadedTextureDecoder;
 
 	// Enhancements
 	int iMultisampleMode;
@@ -0,0 +1,100 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Runs the same loop through the interpreter and the cached interpreter for
+// the same number of cycles, checks they end up in the same state (before and
+// after patching the loop and invalidating it the way icbi does), and
+// compares how long each of them took.
+
+#include <cstdio>
+
+#include "Common.h"
+#include "Timer.h"
+
+#include "PPCJitTester.h"
+#include "TestEnvironment.h"
+
+extern int fail_count;
+
+namespace
+{
+
+const u32 PATCH_INDEX = 6;
+const int NUM_CYCLES = 30000000;
+
+const u32 LOOP[] =
+{
+	0x3c208000, // lis    r1, 0x8000
+	0x60214000, // ori    r1, r1, 0x4000
+	0x38600000, // li     r3, 0
+	0x38800000, // li     r4, 0
+	0x38c00000, // li     r6, 0
+	0x38630001, // loop: addi r3, r3, 1
+	0x7c841a14, // add    r4, r4, r3
+	0x54851838, // rlwinm r5, r4, 3, 0, 28
+	0x7cc62a78, // xor    r6, r6, r5
+	0x90c10100, // stw    r6, 0x100(r1)
+	0x80e10100, // lwz    r7, 0x100(r1)
+	0x7cc63a14, // add    r6, r6, r7
+	0x2c0303e8, // cmpwi  r3, 1000
+	0x41800008, // blt    +8
+	0x38600000, // li     r3, 0
+	0x4bffffd8, // b      loop
+};
+
+// subf r4, r3, r4
+const u32 PATCH = 0x7c832050;
+
+// The cached interpreter is JitInterface's core 5.
+const int CACHED_INTERPRETER_CORE = 5;
+
+PPCTestState TimeRun(PPCJitTester &tester, bool cached, const std::vector<u32> &code)
+{
+	Common::Timer timer;
+	timer.Start();
+	PPCTestState input = PPCJitTester::ZeroState();
+	PPCTestState state = cached ? tester.RunJit(code, input) : tester.RunInterpreter(code, input);
+	printf("CachedInterpreter: %u cycles through the %s in %u ms\n", NUM_CYCLES,
+	       cached ? "cached interpreter" : "interpreter", (u32)timer.GetTimeElapsed());
+	return state;
+}
+
+void CheckSameState(const PPCJitTester &tester, const PPCTestState &interpreter, const PPCTestState &cached, const char *what)
+{
+	if (PPCJitTester::AreEqual(interpreter, cached))
+		return;
+
+	printf("FAIL (CachedInterpreterTests): %s differs between the interpreter and the cached interpreter:\n", what);
+	tester.DumpDifferences(interpreter, cached);
+	fail_count++;
+}
+
+}
+
+void CachedInterpreterTests()
+{
+	TestEnvironment env;
+	env.InitMemory();
+
+	PPCJitTester tester(CACHED_INTERPRETER_CORE, 0);
+	tester.SetNumCycles(NUM_CYCLES);
+	std::vector<u32> code(LOOP, LOOP + ArraySize(LOOP));
+
+	PPCTestState interpreter = TimeRun(tester, false, code);
+	PPCTestState cached = TimeRun(tester, true, code);
+	CheckSameState(tester, interpreter, cached, "original loop");
+
+	// The harness writes the code again and invalidates all of it, patch the
+	// copy and leave it to that, like icbi.
+	code[PATCH_INDEX] = PATCH;
+
+	PPCTestState patched_interpreter = TimeRun(tester, false, code);
+	PPCTestState patched_cached = TimeRun(tester, true, code);
+	CheckSameState(tester, patched_interpreter, patched_cached, "patched loop");
+	if (PPCJitTester::AreEqual(interpreter, patched_interpreter))
+	{
+		printf("FAIL (CachedInterpreterTests): patching the loop didn't change anything\n");
+		fail_count++;
+	}
+}
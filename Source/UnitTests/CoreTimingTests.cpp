@@ -0,0 +1,227 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Checks the order CoreTiming runs its events in: by time, and events due on
+// the same tick in the order they were scheduled, with enough of them that
+// the heap has to move things around. Also checks that removing events from
+// the middle of the queue leaves the rest in order, and that savestates keep
+// the layout of the old linked list.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ChunkFile.h"
+#include "CoreTiming.h"
+
+extern int fail_count;
+
+namespace
+{
+
+const int NUM_EVENTS = 64;
+
+struct RanEvent
+{
+	int type;
+	u64 userdata;
+
+	bool operator==(const RanEvent &other) const
+	{
+		return type == other.type && userdata == other.userdata;
+	}
+};
+
+std::vector<RanEvent> ran;
+int type_a, type_b;
+
+void EventA(u64 userdata, int cyclesLate)
+{
+	RanEvent ev = {type_a, userdata};
+	ran.push_back(ev);
+}
+
+void EventB(u64 userdata, int cyclesLate)
+{
+	RanEvent ev = {type_b, userdata};
+	ran.push_back(ev);
+}
+
+struct Scheduled
+{
+	int time;
+	RanEvent ev;
+};
+
+void Check(bool condition, const char *what)
+{
+	if (!condition)
+	{
+		printf("FAIL (CoreTimingTests): %s\n", what);
+		fail_count++;
+	}
+}
+
+void Start()
+{
+	CoreTiming::Init();
+	type_a = CoreTiming::RegisterEvent("CoreTimingTestA", EventA);
+	type_b = CoreTiming::RegisterEvent("CoreTimingTestB", EventB);
+	ran.clear();
+}
+
+void RunFor(int cycles)
+{
+	CoreTiming::downcount = CoreTiming::slicelength - cycles;
+	CoreTiming::Advance();
+}
+
+// A few ticks, lots of events on each, alternating between the two types.
+std::vector<Scheduled> MakeEvents()
+{
+	std::vector<Scheduled> events;
+	u32 rng = 0x12345678;
+	for (int i = 0; i < NUM_EVENTS; i++)
+	{
+		rng = rng * 1103515245 + 12345;
+		Scheduled s = {(int)(rng >> 16) % 8 * 100, {i % 2 ? type_b : type_a, (u64)i}};
+		events.push_back(s);
+	}
+	return events;
+}
+
+void Schedule(const std::vector<Scheduled> &events)
+{
+	for (const Scheduled &s : events)
+		CoreTiming::ScheduleEvent(s.time, s.ev.type, s.ev.userdata);
+}
+
+// What should run: the events sorted by time, in scheduling order on a tick.
+std::vector<RanEvent> ExpectedOrder(std::vector<Scheduled> events, int removed_type = -1)
+{
+	std::stable_sort(events.begin(), events.end(),
+		[](const Scheduled &a, const Scheduled &b) { return a.time < b.time; });
+	std::vector<RanEvent> order;
+	for (const Scheduled &s : events)
+	{
+		if (s.ev.type != removed_type)
+			order.push_back(s.ev);
+	}
+	return order;
+}
+
+void TestOrder()
+{
+	Start();
+	std::vector<Scheduled> events = MakeEvents();
+	Schedule(events);
+	RunFor(1000);
+	Check(ran == ExpectedOrder(events), "events didn't run by time and then in scheduling order");
+	CoreTiming::Shutdown();
+}
+
+void TestRemove()
+{
+	Start();
+	std::vector<Scheduled> events = MakeEvents();
+	Schedule(events);
+	CoreTiming::RemoveEvent(type_b);
+	Check(!CoreTiming::IsScheduled(type_b), "RemoveEvent left events of its type");
+	Check(CoreTiming::IsScheduled(type_a), "RemoveEvent took other types with it");
+	RunFor(1000);
+	Check(ran == ExpectedOrder(events, type_b), "events out of order after RemoveEvent");
+	CoreTiming::Shutdown();
+
+	// RemoveAllEvents also takes those still waiting in the thread safe queue.
+	Start();
+	Schedule(events);
+	CoreTiming::ScheduleEvent_Threadsafe(50, type_b, NUM_EVENTS);
+	CoreTiming::RemoveAllEvents(type_b);
+	Check(!CoreTiming::IsScheduled(type_b), "RemoveAllEvents left events of its type");
+	RunFor(1000);
+	Check(ran == ExpectedOrder(events, type_b), "events out of order after RemoveAllEvents");
+	CoreTiming::Shutdown();
+}
+
+// How the linked list saved its events: each one behind a 1, in the order
+// they run, and a 0 at the end.
+void DoLegacyEvents(PointerWrap &p, const std::vector<Scheduled> &events)
+{
+	for (const RanEvent &ev : ExpectedOrder(events))
+	{
+		u8 shouldExist = 1;
+		p.Do(shouldExist);
+		s64 time = 0;
+		for (const Scheduled &s : events)
+		{
+			if (s.ev == ev)
+				time = s.time;
+		}
+		p.Do(time);
+		u64 userdata = ev.userdata;
+		p.Do(userdata);
+		std::string name = ev.type == type_a ? "CoreTimingTestA" : "CoreTimingTestB";
+		p.Do(name);
+	}
+	u8 shouldExist = 0;
+	p.Do(shouldExist);
+}
+
+std::vector<u8> SaveState()
+{
+	u8 *ptr = NULL;
+	PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+	CoreTiming::DoState(measure);
+	std::vector<u8> state((size_t)ptr);
+	ptr = &state[0];
+	PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+	CoreTiming::DoState(p);
+	return state;
+}
+
+void TestDoState()
+{
+	// Everything before the events is CoreTiming's own state, the same size
+	// whatever is scheduled.
+	Start();
+	const size_t header_size = SaveState().size() - sizeof(u8) - sizeof(u32);
+	CoreTiming::Shutdown();
+
+	Start();
+	std::vector<Scheduled> events = MakeEvents();
+	Schedule(events);
+	std::vector<u8> state = SaveState();
+	CoreTiming::Shutdown();
+
+	// With room to spare, in case it turns out longer.
+	std::vector<u8> legacy(state.size() + 0x1000);
+	std::copy(state.begin(), state.begin() + header_size, legacy.begin());
+	u8 *ptr = &legacy[0] + header_size;
+	PointerWrap legacy_p(&ptr, PointerWrap::MODE_WRITE);
+	DoLegacyEvents(legacy_p, events);
+	legacy_p.DoMarker("CoreTimingEvents");
+	legacy.resize(ptr - &legacy[0]);
+	Check(state == legacy, "saved events aren't laid out like the linked list");
+
+	// Loaded into a queue that already has something in it, which has to go.
+	Start();
+	CoreTiming::ScheduleEvent(10, type_a, NUM_EVENTS);
+	ptr = &legacy[0];
+	PointerWrap load(&ptr, PointerWrap::MODE_READ);
+	CoreTiming::DoState(load);
+	Check(load.GetMode() == PointerWrap::MODE_READ, "the saved events didn't load");
+	RunFor(1000);
+	Check(ran == ExpectedOrder(events), "loaded events out of order");
+	CoreTiming::Shutdown();
+}
+
+}
+
+void CoreTimingTests()
+{
+	TestOrder();
+	TestRemove();
+	TestDoState();
+}
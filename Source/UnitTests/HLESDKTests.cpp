@@ -0,0 +1,327 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Runs the native SDK routines against PPC versions of the same routines
+// through HLE_SDK::Validate, which has to find them identical for random
+// arguments, and different when the native routine is the wrong one.
+
+#include <cstdio>
+#include <cstring>
+
+#include "HLE/HLE_SDK.h"
+#include "HW/Memmap.h"
+#include "PowerPC/PowerPC.h"
+#include "PowerPC/PPCTables.h"
+
+#include "TestEnvironment.h"
+
+extern int fail_count;
+
+namespace
+{
+
+const u32 RETURN_ADDRESS = 0x80002000;
+const u32 UNIT01_ADDRESS = 0x80002f00;
+const u32 CODE_ADDRESS = 0x80003000;
+const u32 SYSCALL_VECTOR = 0x80000c00;
+const u32 STACK_ADDRESS = 0x80010000;
+const u32 BUFFER_ADDRESS = 0x80100000;
+const u32 BUFFER_SIZE = 0x1000;
+
+// The routines as a game might have them. PSMTX_CONCAT does the same
+// operations as the SDK's PSMTXConcat.
+const u32 OS_DISABLE_INTERRUPTS[] =
+{
+	0x7c6000a6, // mfmsr  r3
+	0x5464045e, // rlwinm r4, r3, 0, 17, 15
+	0x7c800124, // mtmsr  r4
+	0x54638ffe, // rlwinm r3, r3, 17, 31, 31
+	0x4e800020, // blr
+};
+
+const u32 DC_FLUSH_RANGE[] =
+{
+	0x28040000, // cmplwi r4, 0
+	0x4c810020, // blelr
+	0x546506ff, // clrlwi. r5, r3, 27
+	0x41820008, // beq    +8
+	0x38840020, // addi   r4, r4, 0x20
+	0x3884001f, // addi   r4, r4, 0x1f
+	0x5484d97e, // srwi   r4, r4, 5
+	0x7c8903a6, // mtctr  r4
+	0x7c0018ac, // dcbf   0, r3
+	0x38630020, // addi   r3, r3, 0x20
+	0x4200fff8, // bdnz   -8
+	0x44000002, // sc
+	0x4e800020, // blr
+};
+
+const u32 PSMTX_IDENTITY[] =
+{
+	0x3c803f80, // lis    r4, 0x3f80
+	0x38000000, // li     r0, 0
+	0x90830000, // stw    r4, 0(r3)
+	0x90030004, // stw    r0, 4(r3)
+	0x90030008, // stw    r0, 8(r3)
+	0x9003000c, // stw    r0, 12(r3)
+	0x90030010, // stw    r0, 16(r3)
+	0x90830014, // stw    r4, 20(r3)
+	0x90030018, // stw    r0, 24(r3)
+	0x9003001c, // stw    r0, 28(r3)
+	0x90030020, // stw    r0, 32(r3)
+	0x90030024, // stw    r0, 36(r3)
+	0x90830028, // stw    r4, 40(r3)
+	0x9003002c, // stw    r0, 44(r3)
+	0x4e800020, // blr
+};
+
+const u32 PSMTX_CONCAT[] =
+{
+	0x9421ffc0, // stwu   r1, -64(r1)
+	0xd9c10008, // stfd   f14, 8(r1)
+	0xd9e10010, // stfd   f15, 16(r1)
+	0xdbe10018, // stfd   f31, 24(r1)
+	0x3cc08000, // lis    r6, 0x8000
+	0x60c62f00, // ori    r6, r6, 0x2f00
+	0xe3e60000, // psq_l  f31, 0(r6), 0, 0
+	0xe0030000, // psq_l  f0, 0(r3), 0, 0
+	0xe0230008, // psq_l  f1, 8(r3), 0, 0
+	0xe0430010, // psq_l  f2, 16(r3), 0, 0
+	0xe0630018, // psq_l  f3, 24(r3), 0, 0
+	0xe0830020, // psq_l  f4, 32(r3), 0, 0
+	0xe0a30028, // psq_l  f5, 40(r3), 0, 0
+	0xe0c40000, // psq_l  f6, 0(r4), 0, 0
+	0xe0e40008, // psq_l  f7, 8(r4), 0, 0
+	0xe1040010, // psq_l  f8, 16(r4), 0, 0
+	0xe1240018, // psq_l  f9, 24(r4), 0, 0
+	0xe1440020, // psq_l  f10, 32(r4), 0, 0
+	0xe1640028, // psq_l  f11, 40(r4), 0, 0
+	0x11860018, // ps_muls0  f12, f6, f0
+	0x11a70018, // ps_muls0  f13, f7, f0
+	0x1188601e, // ps_madds1 f12, f8, f0, f12
+	0x11a9681e, // ps_madds1 f13, f9, f0, f13
+	0x118a605c, // ps_madds0 f12, f10, f1, f12
+	0x11ab685c, // ps_madds0 f13, f11, f1, f13
+	0x11bf685e, // ps_madds1 f13, f31, f1, f13
+	0x11c60098, // ps_muls0  f14, f6, f2
+	0x11e70098, // ps_muls0  f15, f7, f2
+	0x11c8709e, // ps_madds1 f14, f8, f2, f14
+	0x11e9789e, // ps_madds1 f15, f9, f2, f15
+	0x11ca70dc, // ps_madds0 f14, f10, f3, f14
+	0x11eb78dc, // ps_madds0 f15, f11, f3, f15
+	0x11ff78de, // ps_madds1 f15, f31, f3, f15
+	0x10060118, // ps_muls0  f0, f6, f4
+	0x10270118, // ps_muls0  f1, f7, f4
+	0x1008011e, // ps_madds1 f0, f8, f4, f0
+	0x1029091e, // ps_madds1 f1, f9, f4, f1
+	0x100a015c, // ps_madds0 f0, f10, f5, f0
+	0x102b095c, // ps_madds0 f1, f11, f5, f1
+	0x103f095e, // ps_madds1 f1, f31, f5, f1
+	0xf1850000, // psq_st f12, 0(r5), 0, 0
+	0xf1a50008, // psq_st f13, 8(r5), 0, 0
+	0xf1c50010, // psq_st f14, 16(r5), 0, 0
+	0xf1e50018, // psq_st f15, 24(r5), 0, 0
+	0xf0050020, // psq_st f0, 32(r5), 0, 0
+	0xf0250028, // psq_st f1, 40(r5), 0, 0
+	0xc9c10008, // lfd    f14, 8(r1)
+	0xc9e10010, // lfd    f15, 16(r1)
+	0xcbe10018, // lfd    f31, 24(r1)
+	0x38210040, // addi   r1, r1, 64
+	0x4e800020, // blr
+};
+
+const u32 MEMCPY[] =
+{
+	0x7c661b78, // mr     r6, r3
+	0x28050000, // cmplwi r5, 0
+	0x4d820020, // beqlr
+	0x7ca903a6, // mtctr  r5
+	0x7c043040, // cmplw  r4, r6
+	0x4180001c, // blt    +28
+	0x3884ffff, // addi   r4, r4, -1
+	0x38c6ffff, // addi   r6, r6, -1
+	0x8c040001, // lbzu   r0, 1(r4)
+	0x9c060001, // stbu   r0, 1(r6)
+	0x4200fff8, // bdnz   -8
+	0x4e800020, // blr
+	0x7c842a14, // add    r4, r4, r5
+	0x7cc62a14, // add    r6, r6, r5
+	0x8c04ffff, // lbzu   r0, -1(r4)
+	0x9c06ffff, // stbu   r0, -1(r6)
+	0x4200fff8, // bdnz   -8
+	0x4e800020, // blr
+};
+
+const u32 FILL_MEM[] =
+{
+	0x28050000, // cmplwi r5, 0
+	0x4d820020, // beqlr
+	0x7ca903a6, // mtctr  r5
+	0x3863ffff, // addi   r3, r3, -1
+	0x9c830001, // stbu   r4, 1(r3)
+	0x4200fffc, // bdnz   -4
+	0x4e800020, // blr
+};
+
+u32 rng = 0x48534448;
+
+u32 Random()
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+// Mostly ordinary numbers, with the values rounding goes wrong on thrown in.
+// No NaNs: which of two NaNs comes out of an operation is up to the host
+// compiler, in the interpreter too. The NaNs infinities make are all the same.
+u32 RandomFloat()
+{
+	static const u32 special[] = {
+		0x00000000, 0x80000000, 0x7f800000, 0xff800000, 0x00800000, 0x00000001, 0x807fffff, 0x7f7fffff,
+	};
+	if (Random() % 8 == 0)
+		return special[Random() % 8];
+	return (Random() & 0x807fffff) | ((0x70 + Random() % 0x20) << 23);
+}
+
+template <size_t N>
+void WriteCode(const u32 (&code)[N])
+{
+	for (size_t i = 0; i < N; i++)
+		Memory::Write_U32(code[i], CODE_ADDRESS + (u32)i * 4);
+}
+
+void Call(u32 r3, u32 r4, u32 r5)
+{
+	memset(PowerPC::ppcState.gpr, 0, sizeof(PowerPC::ppcState.gpr));
+	for (int i = 0; i < 32; i++)
+	{
+		PowerPC::ppcState.ps[i][0] = ((u64)Random() << 32) | Random();
+		PowerPC::ppcState.ps[i][1] = ((u64)Random() << 32) | Random();
+	}
+	for (int i = 13; i < 32; i++)
+		GPR(i) = Random();
+	GPR(1) = STACK_ADDRESS;
+	GPR(3) = r3;
+	GPR(4) = r4;
+	GPR(5) = r5;
+	LR = RETURN_ADDRESS;
+	PC = CODE_ADDRESS;
+}
+
+void Check(void (*function)(), const char *name, bool should_match = true)
+{
+	bool match = HLE_SDK::Validate(function, name);
+	if (match != should_match || NPC != RETURN_ADDRESS)
+	{
+		printf("FAIL (HLESDKTests): %s %s the game's code\n", name, match ? "matches" : "doesn't match");
+		fail_count++;
+	}
+}
+
+void FillBuffer()
+{
+	for (u32 i = 0; i < BUFFER_SIZE; i += 4)
+		Memory::Write_U32(Random(), BUFFER_ADDRESS + i);
+}
+
+void TestMemory()
+{
+	WriteCode(MEMCPY);
+	for (int i = 0; i < 100; i++)
+	{
+		FillBuffer();
+		// Small distances, so that the ranges often overlap either way.
+		u32 src = BUFFER_ADDRESS + 0x400 + Random() % 0x100;
+		u32 dst = src + Random() % 0x40 - 0x20;
+		Call(dst, src, Random() % 0x200);
+		Check(HLE_SDK::Memcpy, "memcpy");
+	}
+
+	WriteCode(FILL_MEM);
+	for (int i = 0; i < 100; i++)
+	{
+		FillBuffer();
+		Call(BUFFER_ADDRESS + Random() % 0x800, Random(), Random() % 0x200);
+		Check(HLE_SDK::FillMem, "__fill_mem");
+	}
+
+	// Validation has to notice when the native routine doesn't do the same.
+	FillBuffer();
+	Call(BUFFER_ADDRESS, BUFFER_ADDRESS + 0x800, 0x40);
+	Check(HLE_SDK::Memcpy, "memcpy run against __fill_mem", false);
+}
+
+void TestCache()
+{
+	// The SDK's syscall handler only flushes the CPU's buffers.
+	Memory::Write_U32(0x4c000064, SYSCALL_VECTOR); // rfi
+	WriteCode(DC_FLUSH_RANGE);
+	for (int i = 0; i < 20; i++)
+	{
+		Call(BUFFER_ADDRESS + Random() % 0x800, i == 0 ? 0 : Random() % 0x400, 0);
+		MSR = Random() & 0x8000;
+		Check(HLE_SDK::DCFlushRange, "DCFlushRange");
+	}
+}
+
+void TestInterrupts()
+{
+	WriteCode(OS_DISABLE_INTERRUPTS);
+	for (int i = 0; i < 2; i++)
+	{
+		Call(0, 0, 0);
+		MSR = i ? 0x8032 : 0x0032;
+		Check(HLE_SDK::OSDisableInterrupts, "OSDisableInterrupts");
+		if (MSR != 0x0032 || GPR(3) != (u32)i)
+		{
+			printf("FAIL (HLESDKTests): OSDisableInterrupts left MSR %08x and returned %u\n", MSR, GPR(3));
+			fail_count++;
+		}
+	}
+}
+
+void TestMatrices()
+{
+	Memory::Write_U32(0x00000000, UNIT01_ADDRESS);
+	Memory::Write_U32(0x3f800000, UNIT01_ADDRESS + 4);
+
+	WriteCode(PSMTX_IDENTITY);
+	FillBuffer();
+	Call(BUFFER_ADDRESS + 0x100, 0, 0);
+	Check(HLE_SDK::PSMTXIdentity, "PSMTXIdentity");
+
+	WriteCode(PSMTX_CONCAT);
+	for (int i = 0; i < 100; i++)
+	{
+		for (u32 j = 0; j < BUFFER_SIZE; j += 4)
+			Memory::Write_U32(RandomFloat(), BUFFER_ADDRESS + j);
+		u32 a = BUFFER_ADDRESS;
+		u32 b = BUFFER_ADDRESS + 0x40;
+		// Also concatenate in place.
+		u32 ab = i % 4 == 0 ? a : i % 4 == 1 ? b : BUFFER_ADDRESS + 0x80;
+		Call(a, b, ab);
+		Check(HLE_SDK::PSMTXConcat, "PSMTXConcat");
+	}
+}
+
+}
+
+void HLESDKTests()
+{
+	TestEnvironment env;
+	env.InitMemory();
+	// Checking for exceptions, after sc or mtmsr, looks at the EXI devices.
+	env.InitEXI();
+	PPCTables::InitTables(0);
+	memset(PowerPC::ppcState.spr, 0, sizeof(PowerPC::ppcState.spr));
+	PowerPC::ppcState.fpscr = 0;
+
+	TestMemory();
+	TestCache();
+	TestInterrupts();
+	TestMatrices();
+}
@@ -0,0 +1,133 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Runs small loops through PPCAnalyst::Flatten and checks which of them it
+// takes for busy-waits the JIT can idle: the ones that only poll RAM, and not
+// the ones that poll hardware registers, count, store, or step through memory.
+
+#include <cstdio>
+#include <string>
+
+#include "FileUtil.h"
+#include "HW/Memmap.h"
+#include "PowerPC/PPCAnalyst.h"
+#include "PowerPC/PPCTables.h"
+
+#include "TestEnvironment.h"
+
+extern int fail_count;
+
+namespace
+{
+
+const u32 CODE_ADDRESS = 0x80003000;
+
+struct Loop
+{
+	const char *name;
+	bool idle;
+	u32 code[4];
+	int size;
+};
+
+const Loop LOOPS[] =
+{
+	{"poll a global", true, {
+		0x800d9000, // lwz    r0, -0x7000(r13)
+		0x28000000, // cmplwi r0, 0
+		0x4182fff8, // beq    -8
+	}, 3},
+	{"poll a constant address", true, {
+		0x3c608000, // lis    r3, 0x8000
+		0x80033100, // lwz    r0, 0x3100(r3)
+		0x2c000000, // cmpwi  r0, 0
+		0x4182fff4, // beq    -12
+	}, 4},
+	{"poll a hardware register", false, {
+		0x3c60cc00, // lis    r3, 0xcc00
+		0xa0032000, // lhz    r0, 0x2000(r3)
+		0x70000001, // andi.  r0, r0, 1
+		0x4182fff4, // beq    -12
+	}, 4},
+	{"poll through a pointer", false, {
+		0x80040000, // lwz    r0, 0(r4)
+		0x2c000000, // cmpwi  r0, 0
+		0x4182fff8, // beq    -8
+	}, 3},
+	{"wait for an interrupt", true, {
+		0x48000000, // b      0
+	}, 1},
+	{"count", false, {
+		0x38630001, // addi   r3, r3, 1
+		0x2c030064, // cmpwi  r3, 100
+		0x4180fff8, // blt    -8
+	}, 3},
+	{"store", false, {
+		0x80030000, // lwz    r0, 0(r3)
+		0x90030004, // stw    r0, 4(r3)
+		0x4bfffff8, // b      -8
+	}, 3},
+	{"step through memory", false, {
+		0x84030004, // lwzu   r0, 4(r3)
+		0x2c000000, // cmpwi  r0, 0
+		0x4182fff8, // beq    -8
+	}, 3},
+	{"count down CTR", false, {
+		0x80030000, // lwz    r0, 0(r3)
+		0x4200fffc, // bdnz   -4
+	}, 2},
+};
+
+bool FlattenLoop(const Loop &loop)
+{
+	for (int i = 0; i < loop.size; i++)
+		Memory::Write_U32(loop.code[i], CODE_ADDRESS + i * 4);
+	// Whatever follows shouldn't end up in the block.
+	Memory::Write_U32(0x4e800020, CODE_ADDRESS + loop.size * 4);
+
+	PPCAnalyst::CodeBuffer buffer(32);
+	PPCAnalyst::BlockStats st;
+	PPCAnalyst::BlockRegStats gpa, fpa;
+	bool broken_block;
+	u32 merged_addresses[32];
+	int size_of_merged_addresses;
+	int size;
+	PPCAnalyst::Flatten(CODE_ADDRESS, &size, &st, &gpa, &fpa, broken_block, &buffer, 32,
+		merged_addresses, 32, size_of_merged_addresses);
+	return st.isIdleLoop;
+}
+
+}
+
+void IdleLoopTests()
+{
+	TestEnvironment env;
+	env.InitMemory();
+	PPCTables::InitTables(0);
+
+	for (const Loop &loop : LOOPS)
+	{
+		bool idle = FlattenLoop(loop);
+		if (idle != loop.idle)
+		{
+			printf("FAIL (IdleLoopTests): %s: %s\n", loop.name,
+			       idle ? "taken for a busy-wait" : "not taken for a busy-wait");
+			fail_count++;
+		}
+	}
+
+	const std::string report = File::GetUserPath(D_LOGS_IDX) + "IdleLoopTests.txt";
+	File::CreateFullPath(report);
+	PPCAnalyst::WriteIdleLoopReport(report);
+	std::string text;
+	// All of them start at the same address.
+	if (!File::ReadFileToString(report.c_str(), text) || text.find("Busy-wait loops: 1") != 0 ||
+	    text.find("\t80003000\t") == std::string::npos)
+	{
+		printf("FAIL (IdleLoopTests): the report doesn't list the loop\n");
+		fail_count++;
+	}
+	File::Delete(report);
+	PPCAnalyst::ClearIdleLoops();
+}
@@ -0,0 +1,284 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Replays a stream of block compiles and icache invalidations against the
+// JIT block cache, to measure and sanity check its block index.
+// Streams can be recorded by building with JIT_RECORD_BLOCK_EVENTS (see
+// JitCache.h); without one, a synthetic icbi-heavy stream is generated.
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "FileUtil.h"
+#include "Timer.h"
+#include "PowerPC/JitCommon/JitCache.h"
+
+extern int fail_count;
+
+namespace
+{
+
+class ReplayBlockCache : public JitBaseBlockCache
+{
+private:
+	void WriteLinkBlock(u8* location, const u8* address) override {}
+	void WriteDestroyBlock(const u8* location, u32 address) override {}
+};
+
+struct BlockEvent
+{
+	bool compile;
+	u32 address;
+	u32 size; // instructions when compiling, bytes when invalidating
+	std::vector<u32> exits;
+};
+
+bool LoadEvents(const char *filename, std::vector<BlockEvent> &events)
+{
+	File::IOFile f(filename, "r");
+	if (!f)
+		return false;
+
+	char line[512];
+	while (fgets(line, sizeof(line), f.GetHandle()))
+	{
+		BlockEvent e;
+		char *p = line + 1;
+		e.compile = line[0] == 'c';
+		e.address = strtoul(p, &p, 16);
+		e.size = strtoul(p, &p, 10);
+		while (*p && *p != '\n')
+		{
+			char *end;
+			u32 exit = strtoul(p, &end, 16);
+			if (end == p)
+				break;
+			e.exits.push_back(exit);
+			p = end;
+		}
+		events.push_back(e);
+	}
+	return true;
+}
+
+// Roughly what a game that reloads code and flushes lines with icbi looks like:
+// a couple of MB of code, lots of 32 byte invalidations, the odd overlay load.
+void GenerateEvents(std::vector<BlockEvent> &events)
+{
+	const u32 code_base = 0x80003100;
+	const u32 code_size = 0x200000;
+	srand(1234);
+
+	std::vector<u32> starts;
+	for (u32 address = code_base; address < code_base + code_size; )
+	{
+		starts.push_back(address);
+		address += 4 * (4 + rand() % 40);
+	}
+
+	for (int round = 0; round < 8; round++)
+	{
+		for (size_t i = 0; i < starts.size(); i++)
+		{
+			BlockEvent e;
+			e.compile = true;
+			e.address = starts[i];
+			e.size = i + 1 < starts.size() ? (starts[i + 1] - starts[i]) / 4 : 4;
+			e.exits.push_back(i + 1 < starts.size() ? starts[i + 1] : code_base);
+			e.exits.push_back(starts[rand() % starts.size()]);
+			events.push_back(e);
+		}
+
+		for (int i = 0; i < 200000; i++)
+		{
+			BlockEvent e;
+			e.compile = false;
+			e.address = (code_base + (rand() % code_size)) & ~0x1f;
+			e.size = (i % 1000) ? 32 : 0x10000;
+			events.push_back(e);
+		}
+	}
+}
+
+}
+
+void JitCacheTests(const char *stream_file)
+{
+	std::vector<BlockEvent> events;
+	if (!stream_file || !LoadEvents(stream_file, events))
+		GenerateEvents(events);
+
+	ReplayBlockCache cache;
+	cache.Init();
+
+	static const u8 dummy_code[64] = {};
+	int num_compiles = 0;
+	int num_invalidations = 0;
+
+	Common::Timer timer;
+	timer.Start();
+	for (const BlockEvent &e : events)
+	{
+		if (e.compile)
+		{
+			if (cache.IsFull())
+				cache.Clear();
+
+			int block_num = cache.AllocateBlock(e.address);
+			JitBlock *b = cache.GetBlock(block_num);
+			b->checkedEntry = b->normalEntry = dummy_code;
+			b->originalSize = e.size;
+			b->codeSize = sizeof(dummy_code);
+			for (u32 exit : e.exits)
+			{
+				JitBlock::LinkData link;
+				link.exitAddress = exit;
+				link.exitPtrs = (u8*)dummy_code;
+				link.linkStatus = false;
+				b->linkData.push_back(link);
+			}
+			cache.FinalizeBlock(block_num, true, dummy_code);
+			num_compiles++;
+		}
+		else
+		{
+			cache.InvalidateICache(e.address, e.size);
+			num_invalidations++;
+		}
+	}
+	u64 elapsed = timer.GetTimeElapsed();
+
+	printf("JitCache: replayed %d compiles and %d invalidations in %u ms\n",
+	       num_compiles, num_invalidations, (u32)elapsed);
+
+	// Every block that overlaps an invalidated range must be gone, nothing else.
+	cache.Clear();
+	const u32 addresses[] = {0x80001000, 0x80001040, 0x80001080, 0x80002000};
+	for (u32 address : addresses)
+	{
+		int block_num = cache.AllocateBlock(address);
+		JitBlock *b = cache.GetBlock(block_num);
+		b->checkedEntry = b->normalEntry = dummy_code;
+		b->originalSize = 16;
+		cache.FinalizeBlock(block_num, false, dummy_code);
+	}
+	cache.InvalidateICache(0x80001060, 32);
+	const bool expected_invalid[] = {false, true, false, false};
+	for (int i = 0; i < 4; i++)
+	{
+		if (cache.GetBlock(i)->invalid != expected_invalid[i])
+		{
+			printf("FAIL (JitCacheTests): block %08x invalid=%d, expected %d\n",
+			       addresses[i], cache.GetBlock(i)->invalid, expected_invalid[i]);
+			fail_count++;
+		}
+	}
+
+	// A length that runs past the end of the address space still takes out
+	// everything from the start address on.
+	cache.Clear();
+	int top_block = cache.AllocateBlock(0x817FFFC0);
+	cache.GetBlock(top_block)->checkedEntry = cache.GetBlock(top_block)->normalEntry = dummy_code;
+	cache.GetBlock(top_block)->originalSize = 8;
+	cache.FinalizeBlock(top_block, false, dummy_code);
+	cache.InvalidateICache(0x817FFFC0, 0xFFFFFFF0);
+	if (!cache.GetBlock(top_block)->invalid)
+	{
+		printf("FAIL (JitCacheTests): invalidating a range that wraps around kept its blocks\n");
+		fail_count++;
+	}
+
+	// Evicting a range of code frees the slots of the blocks in there, keeps
+	// the addresses of the hot ones, and unlinks the exits that jumped in.
+	cache.Clear();
+	static const u8 code_space[4][64] = {};
+	const u32 run_counts[] = {0, 500, 20, 300};
+	for (int i = 0; i < 4; i++)
+	{
+		int block_num = cache.AllocateBlock(addresses[i]);
+		JitBlock *b = cache.GetBlock(block_num);
+		b->checkedEntry = b->normalEntry = code_space[i];
+		b->originalSize = 16;
+		b->runCount = run_counts[i];
+		JitBlock::LinkData link;
+		link.exitAddress = addresses[(i + 1) % 4];
+		link.exitPtrs = (u8*)code_space[i] + 32;
+		link.linkStatus = false;
+		b->linkData.push_back(link);
+		cache.FinalizeBlock(block_num, true, code_space[i]);
+	}
+	std::vector<u32> hot;
+	cache.EvictCode(code_space[1], code_space[3] + sizeof(code_space[3]), 100, hot);
+	if (hot.size() != 2 || hot[0] != addresses[1] || hot[1] != addresses[3])
+	{
+		printf("FAIL (JitCacheTests): eviction kept %d hot blocks\n", (int)hot.size());
+		fail_count++;
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		const bool evicted = i != 0;
+		if ((cache.GetBlockNumberFromStartAddress(addresses[i]) < 0) != evicted)
+		{
+			printf("FAIL (JitCacheTests): block %08x evicted=%d, expected %d\n",
+			       addresses[i], !evicted, evicted);
+			fail_count++;
+		}
+	}
+	if (cache.GetBlock(0)->linkData[0].linkStatus || cache.GetBlock(0)->runCount != 0)
+	{
+		printf("FAIL (JitCacheTests): exit into evicted code still linked\n");
+		fail_count++;
+	}
+	if (cache.AllocateBlock(0x80003000) >= 4 || cache.GetNumEvictedBlocks() != 3)
+	{
+		printf("FAIL (JitCacheTests): evicted block slots aren't reused\n");
+		fail_count++;
+	}
+
+	// A block destroyed and compiled again, like one tiering up, gets the
+	// exits that jumped into the old one linked to it.
+	cache.Clear();
+	int caller = cache.AllocateBlock(addresses[0]);
+	JitBlock *caller_block = cache.GetBlock(caller);
+	caller_block->checkedEntry = caller_block->normalEntry = code_space[0];
+	caller_block->originalSize = 16;
+	JitBlock::LinkData link;
+	link.exitAddress = addresses[3];
+	link.exitPtrs = (u8*)code_space[0] + 32;
+	link.linkStatus = false;
+	caller_block->linkData.push_back(link);
+	cache.FinalizeBlock(caller, true, code_space[0]);
+	for (int version = 0; version < 2; version++)
+	{
+		int block_num = cache.AllocateBlock(addresses[3]);
+		JitBlock *b = cache.GetBlock(block_num);
+		b->checkedEntry = b->normalEntry = code_space[1 + version];
+		b->originalSize = 16;
+		cache.FinalizeBlock(block_num, true, code_space[1 + version]);
+		if (!cache.GetBlock(caller)->linkData[0].linkStatus)
+		{
+			printf("FAIL (JitCacheTests): caller not linked to version %d of a block\n", version);
+			fail_count++;
+		}
+		cache.DestroyBlock(block_num, true);
+		if (cache.GetBlock(caller)->linkData[0].linkStatus)
+		{
+			printf("FAIL (JitCacheTests): caller still linked to a destroyed block\n");
+			fail_count++;
+		}
+	}
+
+	// A background compile that gets dropped hands its slot back.
+	const int num_blocks = cache.GetNumBlocks();
+	int dropped = cache.AllocateBlock(addresses[2]);
+	cache.ReleaseBlock(dropped);
+	if (cache.AllocateBlock(addresses[2]) != dropped || cache.GetNumBlocks() != num_blocks + 1)
+	{
+		printf("FAIL (JitCacheTests): released block slot isn't reused\n");
+		fail_count++;
+	}
+
+	cache.Shutdown();
+}
@@ -0,0 +1,131 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Stores a few blocks in a JIT disk cache, reads them back like the next boot
+// would and checks which ones an invalidated range hands out again, including
+// ranges at the very top of the address space. Also checks that the code
+// fetches warm-up uses leave the emulated instruction cache alone.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "FileUtil.h"
+#include "HW/Memmap.h"
+#include "PowerPC/JitInterface.h"
+#include "PowerPC/PowerPC.h"
+#include "PowerPC/JitCommon/JitDiskCache.h"
+
+#include "TestEnvironment.h"
+
+extern int fail_count;
+
+namespace
+{
+
+const char *const TEST_GAME_ID = "UNITTEST";
+
+JitDiskCacheKey MakeKey(u32 address, u64 hash)
+{
+	JitDiskCacheKey key;
+	key.address = address;
+	key.numInstructions = 4;
+	key.hash = hash;
+	return key;
+}
+
+std::vector<u32> TakeAddresses(JitDiskCache &cache)
+{
+	std::vector<JitDiskCacheKey> keys;
+	cache.TakeBlocksToWarm(keys);
+	std::vector<u32> addresses;
+	for (const JitDiskCacheKey &key : keys)
+		addresses.push_back(key.address);
+	std::sort(addresses.begin(), addresses.end());
+	return addresses;
+}
+
+void CheckTaken(JitDiskCache &cache, const std::vector<u32> &expected, const char *what)
+{
+	if (TakeAddresses(cache) != expected)
+	{
+		printf("FAIL (JitDiskCacheTests): wrong blocks to warm up %s\n", what);
+		fail_count++;
+	}
+}
+
+void TestInvalidateRange()
+{
+	const std::string filename = File::GetUserPath(D_CACHE_IDX) + "jit-" + TEST_GAME_ID + ".cache";
+	File::Delete(filename);
+
+	const u32 addresses[] = {0x80003100, 0x80004000, 0xFFFFFF00, 0xFFFFFFF0};
+	JitDiskCache cache;
+	cache.Init(TEST_GAME_ID);
+	for (u32 address : addresses)
+		cache.RecordBlock(MakeKey(address, address * 3));
+	cache.Shutdown();
+
+	// Everything that was stored gets tried once on the next boot.
+	cache.Init(TEST_GAME_ID);
+	CheckTaken(cache, std::vector<u32>(addresses, addresses + 4), "after loading");
+	CheckTaken(cache, std::vector<u32>(), "twice");
+
+	cache.InvalidateRange(0x80003000, 0x1000);
+	CheckTaken(cache, std::vector<u32>(1, 0x80003100), "after invalidating one block");
+
+	cache.InvalidateRange(0x80004000, 0);
+	CheckTaken(cache, std::vector<u32>(), "after an empty invalidation");
+
+	// address + length is 0 here.
+	cache.InvalidateRange(0xFFFFFF00, 0x100);
+	CheckTaken(cache, std::vector<u32>(addresses + 2, addresses + 4), "at the end of the address space");
+
+	cache.MarkWarmed(0xFFFFFFF0);
+	cache.InvalidateRange(0xFFFFFFE0, 0x20);
+	CheckTaken(cache, std::vector<u32>(), "after the block was compiled");
+
+	cache.Shutdown();
+	File::Delete(filename);
+}
+
+void TestPeekOpcode()
+{
+	TestEnvironment env;
+	env.InitMemory();
+
+	const u32 address = 0x80003104;
+	const u32 set = (address >> 5) & 0x7f;
+	PowerPC::ppcState.iCache.Reset();
+	HID0.ICE = 1;
+	HID0.ILOCK = 0;
+
+	Memory::Write_U32(0x38600001, address);
+	if (JitInterface::Peek_Opcode_JIT(address) != 0x38600001 || PowerPC::ppcState.iCache.valid[set] != 0)
+	{
+		printf("FAIL (JitDiskCacheTests): peeking at code loaded it into the instruction cache\n");
+		fail_count++;
+	}
+
+	// Once the line is cached, peeking has to see the cached copy, like the CPU would.
+	JitInterface::Read_Opcode_JIT(address);
+	const u32 plru = PowerPC::ppcState.iCache.plru[set];
+	Memory::Write_U32(0x38600002, address);
+	if (JitInterface::Peek_Opcode_JIT(address) != 0x38600001 || PowerPC::ppcState.iCache.plru[set] != plru)
+	{
+		printf("FAIL (JitDiskCacheTests): peeking at cached code doesn't match the instruction cache\n");
+		fail_count++;
+	}
+
+	PowerPC::ppcState.iCache.Reset();
+	HID0.ICE = 0;
+}
+
+}
+
+void JitDiskCacheTests()
+{
+	TestInvalidateRange();
+	TestPeekOpcode();
+}
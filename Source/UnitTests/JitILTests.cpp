@@ -0,0 +1,212 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Builds small pieces of JitIL IR and checks what the builder makes of them:
+// repeated operations and loads from RAM reuse the first one, and register
+// stores are only dropped when nothing can leave the block before they are
+// replaced.
+//
+// Then runs a couple of loops through Jit64 and JitIL for the same number of
+// cycles, and prints the best time of a few runs on each, to see whether the
+// optimizations pay off against Jit64.
+
+#include <cstdio>
+
+#include "Common.h"
+#include "Timer.h"
+#include "PowerPC/JitILCommon/IR.h"
+
+#include "PPCJitTester.h"
+#include "TestEnvironment.h"
+
+using namespace IREmitter;
+
+extern int fail_count;
+
+namespace
+{
+
+const u32 DATA_ADDRESS = 0x80004000;
+const u32 HARDWARE_ADDRESS = 0xCC006800;
+
+// JitInterface::InitJitCore numbers
+const int JIT64_CORE = 1;
+const int JITIL_CORE = 2;
+
+const int TIMING_CYCLES = 200000000;
+const int TIMING_RUNS = 3;
+
+// Both loops run CTR times, the count is set by code[COUNT_INDEX]. With a
+// count of 0, they go round 2^32 times, longer than any timing run.
+const size_t COUNT_INDEX = 2;
+const u32 LI_R7 = 0x38e00000;
+const u32 CHECK_COUNT = 50;
+
+const u32 INTEGER_LOOP[] =
+{
+	0x3c208000, // lis    r1, 0x8000
+	0x60214000, // ori    r1, r1, 0x4000
+	0x38e00000, // li     r7, count
+	0x7ce903a6, // mtctr  r7
+	0x80610000, // loop: lwz r3, 0(r1)
+	0x38630001, // addi   r3, r3, 1
+	0x90610000, // stw    r3, 0(r1)
+	0x5464103a, // rlwinm r4, r3, 2, 0, 29
+	0x7ca52214, // add    r5, r5, r4
+	0x706600ff, // andi.  r6, r3, 0xff
+	0x40820008, // bne    +8
+	0x38a50001, // addi   r5, r5, 1
+	0x4200ffe0, // bdnz   loop
+};
+
+const u32 FLOAT_LOOP[] =
+{
+	0x3c208000, // lis    r1, 0x8000
+	0x60214000, // ori    r1, r1, 0x4000
+	0x38e00000, // li     r7, count
+	0x7ce903a6, // mtctr  r7
+	0x3c603f80, // lis    r3, 0x3f80
+	0x90610000, // stw    r3, 0(r1)
+	0xc0410000, // lfs    f2, 0(r1)
+	0xfc21102a, // loop: fadd f1, f1, f2
+	0xfc610072, // fmul   f3, f1, f1
+	0xfc830828, // fsub   f4, f3, f1
+	0xd8810008, // stfd   f4, 8(r1)
+	0xc8a10008, // lfd    f5, 8(r1)
+	0xfcc6282a, // fadd   f6, f6, f5
+	0x4200ffe8, // bdnz   loop
+};
+
+int CountOps(IRBuilder &ibuild, unsigned opcode)
+{
+	int count = 0;
+	InstLoc I = ibuild.getFirstInst();
+	for (unsigned i = 0; i < ibuild.getNumInsts(); i++, I++)
+	{
+		if (getOpcode(ibuild.ReadInst(I)) == opcode)
+			count++;
+	}
+	return count;
+}
+
+void Check(bool condition, const char *what)
+{
+	if (!condition)
+	{
+		printf("FAIL (JitILTests): %s\n", what);
+		fail_count++;
+	}
+}
+
+void TestValueNumbering()
+{
+	IRBuilder ibuild;
+	InstLoc r3 = ibuild.EmitLoadGReg(3);
+	InstLoc r4 = ibuild.EmitLoadGReg(4);
+	InstLoc sum = ibuild.EmitAdd(r3, r4);
+	Check(ibuild.EmitAdd(r3, r4) == sum, "add done twice");
+	Check(ibuild.EmitAdd(r4, r3) == sum, "commuted add done twice");
+	InstLoc shifted = ibuild.EmitShl(r3, ibuild.EmitIntConst(2));
+	Check(ibuild.EmitShl(r3, ibuild.EmitIntConst(2)) == shifted, "shift by the same constant done twice");
+	Check(ibuild.EmitShl(r3, ibuild.EmitIntConst(3)) != shifted, "shifts by different constants merged");
+	Check(ibuild.EmitSub(r3, r4) != ibuild.EmitSub(r4, r3), "subtractions the other way around merged");
+}
+
+void TestStores()
+{
+	IRBuilder ibuild;
+	InstLoc r3 = ibuild.EmitLoadGReg(3);
+	ibuild.EmitStoreGReg(r3, 3);
+	Check(CountOps(ibuild, StoreGReg) == 0, "stored a register back unchanged");
+
+	InstLoc r4 = ibuild.EmitLoadGReg(4);
+	ibuild.EmitStoreGReg(r4, 3);
+	ibuild.EmitStoreGReg(r4, 3);
+	Check(CountOps(ibuild, StoreGReg) == 1, "stored the same value twice");
+
+	ibuild.EmitStoreGReg(ibuild.EmitAdd(r3, r4), 3);
+	Check(CountOps(ibuild, StoreGReg) == 1, "kept a store that was replaced");
+
+	ibuild.EmitDSIExceptionCheck(ibuild.EmitIntConst(0x80003000));
+	ibuild.EmitStoreGReg(ibuild.EmitSub(r3, r4), 3);
+	Check(CountOps(ibuild, StoreGReg) == 2, "dropped a store before an exception check");
+
+	ibuild.EmitStoreCarry(ibuild.EmitICmpUlt(r3, r4));
+	ibuild.EmitStoreCarry(ibuild.EmitICmpUgt(r3, r4));
+	Check(CountOps(ibuild, StoreCarry) == 1, "kept a carry store that was replaced");
+}
+
+void TestLoads()
+{
+	IRBuilder ibuild;
+	InstLoc address = ibuild.EmitIntConst(DATA_ADDRESS);
+	InstLoc value = ibuild.EmitLoad32(address);
+	Check(ibuild.EmitLoad32(ibuild.EmitIntConst(DATA_ADDRESS)) == value, "loaded the same word twice");
+	Check(ibuild.EmitLoad16(address) != value, "forwarded a load of a different size");
+
+	InstLoc r13 = ibuild.EmitLoadGReg(13);
+	InstLoc global = ibuild.EmitLoad8(ibuild.EmitAdd(r13, ibuild.EmitIntConst(-0x7000)));
+	Check(ibuild.EmitLoad8(ibuild.EmitAdd(r13, ibuild.EmitIntConst(-0x7000))) == global, "loaded the same byte twice");
+
+	// r3 could point at a hardware register.
+	InstLoc r3 = ibuild.EmitLoadGReg(3);
+	InstLoc indexed = ibuild.EmitLoad8(ibuild.EmitAdd(r3, ibuild.EmitIntConst(8)));
+	Check(ibuild.EmitLoad8(ibuild.EmitAdd(r3, ibuild.EmitIntConst(8))) != indexed, "forwarded a load through a pointer");
+
+	ibuild.EmitStore8(r3, ibuild.EmitIntConst(DATA_ADDRESS + 0x100));
+	Check(ibuild.EmitLoad32(address) != value, "forwarded a load across a store");
+
+	InstLoc hardware = ibuild.EmitLoad16(ibuild.EmitIntConst(HARDWARE_ADDRESS));
+	Check(ibuild.EmitLoad16(ibuild.EmitIntConst(HARDWARE_ADDRESS)) != hardware, "forwarded a hardware register read");
+}
+
+// Best of TIMING_RUNS, in ms. The first run compiles the loop. It's checked
+// against the interpreter first, on a short count.
+u32 TimeCore(int core, const char *name, std::vector<u32> code)
+{
+	PPCJitTester tester(core, 0);
+	code[COUNT_INDEX] = LI_R7 | CHECK_COUNT;
+	if (!tester.Test(code, PPCJitTester::ZeroState()))
+	{
+		printf("FAIL (JitILTests): the %s loop ends up differently in core %i and the interpreter\n", name, core);
+		fail_count++;
+	}
+
+	code[COUNT_INDEX] = LI_R7;
+	tester.SetNumCycles(TIMING_CYCLES);
+	u32 best = 0;
+	for (int i = 0; i < TIMING_RUNS; i++)
+	{
+		Common::Timer timer;
+		timer.Start();
+		tester.RunJit(code, PPCJitTester::ZeroState());
+		u32 elapsed = (u32)timer.GetTimeElapsed();
+		if (i == 0 || elapsed < best)
+			best = elapsed;
+	}
+	return best;
+}
+
+void TimeAgainstJit64(const char *name, const u32 *loop, size_t size)
+{
+	std::vector<u32> code(loop, loop + size);
+	u32 jit64_ms = TimeCore(JIT64_CORE, name, code);
+	u32 jitil_ms = TimeCore(JITIL_CORE, name, code);
+	printf("JitILTests: %s loop, %u cycles: Jit64 %u ms, JitIL %u ms\n", name, TIMING_CYCLES, jit64_ms, jitil_ms);
+}
+
+}
+
+void JitILTests()
+{
+	TestValueNumbering();
+	TestStores();
+	TestLoads();
+
+	TestEnvironment env;
+	env.InitMemory();
+	env.InitEXI();
+	TimeAgainstJit64("integer", INTEGER_LOOP, ArraySize(INTEGER_LOOP));
+	TimeAgainstJit64("floating point", FLOAT_LOOP, ArraySize(FLOAT_LOOP));
+}
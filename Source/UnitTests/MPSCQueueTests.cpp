@@ -0,0 +1,100 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Hammers the queue behind CoreTiming::ScheduleEvent_Threadsafe the way dual
+// core mode does: a GPU thread and a second helper thread schedule events
+// while the CPU thread schedules its own and moves everything over, as
+// MoveEvents does on every Advance.
+
+#include <cstdio>
+#include <vector>
+
+#include "MPSCQueue.h"
+#include "StdThread.h"
+#include "Timer.h"
+
+extern int fail_count;
+
+namespace
+{
+
+struct TestEvent
+{
+	u32 producer;
+	u32 sequence;
+};
+
+const u32 NUM_PRODUCERS = 3; // GPU thread, helper thread, CPU thread
+const u32 EVENTS_PER_PRODUCER = 1000000;
+
+template <u32 Capacity>
+void RunStressTest(const char *name)
+{
+	Common::MPSCQueue<TestEvent, Capacity> queue;
+
+	auto produce = [&queue](u32 producer)
+	{
+		for (u32 i = 0; i < EVENTS_PER_PRODUCER; i++)
+		{
+			TestEvent e = {producer, i};
+			queue.Push(e);
+		}
+	};
+
+	Common::Timer timer;
+	timer.Start();
+
+	std::thread gpu_thread(produce, 0);
+	std::thread helper_thread(produce, 1);
+
+	// CPU thread: schedule one event per slice and drain the queue.
+	std::vector<u32> next(NUM_PRODUCERS, 0);
+	u32 received = 0;
+	u32 cpu_sent = 0;
+	bool in_order = true;
+	while (received < NUM_PRODUCERS * EVENTS_PER_PRODUCER)
+	{
+		if (cpu_sent < EVENTS_PER_PRODUCER)
+		{
+			TestEvent e = {2, cpu_sent++};
+			queue.Push(e);
+		}
+
+		TestEvent e;
+		while (queue.Pop(e))
+		{
+			if (e.producer >= NUM_PRODUCERS || e.sequence != next[e.producer])
+				in_order = false;
+			else
+				next[e.producer]++;
+			received++;
+		}
+	}
+
+	gpu_thread.join();
+	helper_thread.join();
+	u64 elapsed = timer.GetTimeElapsed();
+
+	printf("MPSCQueue<%s>: moved %u events in %u ms\n", name, received, (u32)elapsed);
+
+	if (!in_order)
+	{
+		printf("FAIL (MPSCQueueTests): events from one thread came out of order (capacity %s)\n", name);
+		fail_count++;
+	}
+	if (!queue.Empty())
+	{
+		printf("FAIL (MPSCQueueTests): queue not empty after receiving everything (capacity %s)\n", name);
+		fail_count++;
+	}
+}
+
+}
+
+void MPSCQueueTests()
+{
+	RunStressTest<1024>("1024");
+	// Small enough that the writers keep spilling into the overflow list.
+	RunStressTest<16>("16");
+}
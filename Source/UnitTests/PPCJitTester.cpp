@@ -0,0 +1,720 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <cstring>
+
+#include "CoreTiming.h"
+#include "PowerPCDisasm.h"
+#include "HW/Memmap.h"
+#include "PowerPC/JitInterface.h"
+#include "PowerPC/Gekko.h"
+#include "PowerPC/PowerPC.h"
+#include "PowerPC/PPCTables.h"
+#include "PowerPC/Interpreter/Interpreter.h"
+
+#include "PPCJitTester.h"
+
+namespace
+{
+
+const u32 CODE_ADDRESS = PPCJitTester::CODE_ADDRESS;
+const u32 DATA_ADDRESS = PPCJitTester::DATA_ADDRESS;
+const int MAX_BLOCK_SIZE = 24;
+const int NUM_CYCLES = 2000;
+const int JITIL_CORE = 2;
+
+// Generated code only writes r0-r7 and f0-f7, so that instructions tend to
+// use each other's results. r30 and r31 hold the data address for the loads
+// and stores and are never written.
+const int NUM_REGS = 8;
+const int INDEX_REG = 30;
+const int BASE_REG = 31;
+const u32 INDEX_OFFSET = 0x40;
+
+// The JITs don't keep the FPSCR status bits up to date, so only RN, NI and
+// the exception enables are compared.
+const u32 FPSCR_CONTROL_MASK = 0xff;
+
+// Float, u8, s8, u16 and s16 with a few scales, like games set them up.
+const u32 GQRS[8] = {0, 0x00040004, 0x03060306, 0x00050005, 0x02070207, 0x3e073e07, 0x0c060c06, 0x04050405};
+
+u32 D(u32 op, int rt, int ra, u32 imm)             { return (op << 26) | (rt << 21) | (ra << 16) | (imm & 0xffff); }
+u32 X(u32 op, int rt, int ra, int rb, u32 xo)      { return (op << 26) | (rt << 21) | (ra << 16) | (rb << 11) | (xo << 1); }
+u32 A(u32 op, int d, int a, int b, int c, u32 xo)  { return (op << 26) | (d << 21) | (a << 16) | (b << 11) | (c << 6) | (xo << 1); }
+u32 M(u32 op, int rs, int ra, int sh, int mb, int me) { return (op << 26) | (rs << 21) | (ra << 16) | (sh << 11) | (mb << 6) | (me << 1); }
+
+// Which of the register fields an instruction reads. The others have to be 0.
+enum
+{
+	USES_A = 1,
+	USES_B = 2,
+	USES_C = 4,
+	USES_AB = USES_A | USES_B,
+	USES_AC = USES_A | USES_C,
+	USES_ABC = USES_A | USES_B | USES_C,
+};
+
+struct Form
+{
+	u32 xo;
+	u32 operands;
+};
+
+// addi, addis, addic, addic., subfic, mulli
+const u32 D_ARITHMETIC[] = {14, 15, 12, 13, 8, 7};
+// ori, oris, xori, xoris, andi., andis.
+const u32 D_LOGICAL[] = {24, 25, 26, 27, 28, 29};
+// add, addc, adde, addze, addme, subf, subfc, subfe, subfze, subfme, neg, mullw, mulhw,
+// mulhwu, divw, divwu. Never with OE, the interpreter doesn't do overflow.
+const Form XO_ARITHMETIC[] =
+{
+	{266, USES_AB}, {10, USES_AB}, {138, USES_AB}, {202, USES_A}, {234, USES_A}, {40, USES_AB},
+	{8, USES_AB}, {136, USES_AB}, {200, USES_A}, {232, USES_A}, {104, USES_A}, {235, USES_AB},
+	{75, USES_AB}, {11, USES_AB}, {491, USES_AB}, {459, USES_AB},
+};
+// and, andc, or, orc, xor, nor, nand, eqv, slw, srw, sraw
+const u32 X_LOGICAL[] = {28, 60, 444, 412, 316, 124, 476, 284, 24, 536, 792};
+// cntlzw, extsb, extsh
+const u32 X_UNARY[] = {26, 954, 922};
+// crand, crandc, creqv, crnand, crnor, cror, crorc, crxor
+const u32 XL_CR[] = {257, 129, 289, 225, 33, 449, 417, 193};
+// fdiv(s), fsub(s), fadd(s), fmul(s), fmsub(s), fmadd(s), fnmsub(s), fnmadd(s), and fsel,
+// which has no single form
+const Form A_FLOAT[] =
+{
+	{18, USES_AB}, {20, USES_AB}, {21, USES_AB}, {25, USES_AC}, {28, USES_ABC}, {29, USES_ABC},
+	{30, USES_ABC}, {31, USES_ABC}, {23, USES_ABC},
+};
+// fneg, fmr, fnabs, fabs, frsp, fctiw, fctiwz
+const u32 X_FLOAT_UNARY[] = {40, 72, 136, 264, 12, 14, 15};
+// ps_sum0, ps_sum1, ps_muls0, ps_muls1, ps_madds0, ps_madds1, ps_div, ps_sub,
+// ps_add, ps_sel, ps_mul, ps_msub, ps_madd, ps_nmsub, ps_nmadd
+const Form A_PAIRED[] =
+{
+	{10, USES_ABC}, {11, USES_ABC}, {12, USES_AC}, {13, USES_AC}, {14, USES_ABC}, {15, USES_ABC},
+	{18, USES_AB}, {20, USES_AB}, {21, USES_AB}, {23, USES_ABC}, {25, USES_AC}, {28, USES_ABC},
+	{29, USES_ABC}, {30, USES_ABC}, {31, USES_ABC},
+};
+// ps_neg, ps_mr, ps_nabs, ps_abs, ps_merge00, ps_merge01, ps_merge10, ps_merge11
+const Form X_PAIRED[] =
+{
+	{40, USES_B}, {72, USES_B}, {136, USES_B}, {264, USES_B},
+	{528, USES_AB}, {560, USES_AB}, {592, USES_AB}, {624, USES_AB},
+};
+// ps_cmpu0, ps_cmpo0, ps_cmpu1, ps_cmpo1
+const u32 X_PAIRED_COMPARE[] = {0, 32, 64, 96};
+
+struct MemoryForm
+{
+	u32 op;
+	int size;
+};
+
+// lwz, lbz, stw, stb, lhz, lha, sth, lfs, lfd, stfs, stfd
+const MemoryForm D_MEMORY[] =
+{
+	{32, 4}, {34, 1}, {36, 4}, {38, 1}, {40, 2},
+	{42, 2}, {44, 2}, {48, 4}, {50, 8}, {52, 4}, {54, 8},
+};
+// lwzx, lbzx, lhzx, lhax, stwx, stbx, sthx, lwbrx, lhbrx, stwbrx, sthbrx,
+// lfsx, lfdx, stfsx, stfdx, stfiwx
+const u32 X_MEMORY[] = {23, 87, 279, 343, 151, 215, 407, 534, 790, 662, 918, 535, 599, 663, 727, 983};
+
+int Operand(const Form *form, u32 field, int reg)
+{
+	return (form->operands & field) ? reg : 0;
+}
+
+u32 ToSingle(u64 hex)
+{
+	double value;
+	memcpy(&value, &hex, sizeof(value));
+	float single = (float)value;
+	u32 single_hex;
+	memcpy(&single_hex, &single, sizeof(single_hex));
+	return single_hex;
+}
+
+// What a paired single slot holds, as far as the generated code goes. Doubles
+// that aren't representable as singles get rounded by the JITs and truncated by
+// the interpreter when stored as singles, and the interpreter and the JITs give
+// NaNs different payloads, so only singles are stored as singles, and fctiw
+// results (NaNs, as doubles) are only moved around and stored as they are.
+// JitIL packs paired singles into two floats, so there they only ever get
+// singles, and no multiply-adds.
+enum FPRContents
+{
+	FPR_DOUBLE,
+	FPR_SINGLE,
+	FPR_INTEGER,
+};
+
+typedef FPRContents FPRState[32][2];
+
+FPRContents Combine(FPRContents a, FPRContents b)
+{
+	return (a == FPR_SINGLE && b == FPR_SINGLE) ? FPR_SINGLE : FPR_DOUBLE;
+}
+
+bool IsNumber(const FPRState fprs, int reg)
+{
+	return fprs[reg][0] != FPR_INTEGER && fprs[reg][1] != FPR_INTEGER;
+}
+
+bool IsPairedInput(const FPRState fprs, int reg, bool packed_singles)
+{
+	if (packed_singles)
+		return fprs[reg][0] == FPR_SINGLE && fprs[reg][1] == FPR_SINGLE;
+	return IsNumber(fprs, reg);
+}
+
+void SetBoth(FPRState fprs, int reg, FPRContents contents)
+{
+	fprs[reg][0] = fprs[reg][1] = contents;
+}
+
+// Checks that an instruction only does the above with what the registers hold
+// at that point, and updates them. Returns false if the block can't use it.
+bool ApplyFPRContents(u32 hex, FPRState fprs, bool packed_singles)
+{
+	UGeckoInstruction inst(hex);
+	int d = inst.FD, a = inst.FA, b = inst.FB, c = inst.FC;
+
+	switch (inst.OPCD)
+	{
+	case 48: // lfs
+		SetBoth(fprs, d, FPR_SINGLE);
+		return true;
+	case 50: // lfd
+		fprs[d][0] = FPR_DOUBLE;
+		return true;
+	case 52: // stfs
+		return fprs[d][0] == FPR_SINGLE;
+	case 56: // psq_l
+		SetBoth(fprs, d, FPR_SINGLE);
+		return true;
+	case 60: // psq_st
+		return fprs[d][0] == FPR_SINGLE && (inst.hex & 0x8000 || fprs[d][1] == FPR_SINGLE);
+	case 31:
+		switch (inst.SUBOP10)
+		{
+		case 535: // lfsx
+			SetBoth(fprs, d, FPR_SINGLE);
+			return true;
+		case 599: // lfdx
+			fprs[d][0] = FPR_DOUBLE;
+			return true;
+		case 663: // stfsx
+			return fprs[d][0] == FPR_SINGLE;
+		}
+		return true;
+	case 59:
+		if (!IsNumber(fprs, a) || !IsNumber(fprs, b) || !IsNumber(fprs, c))
+			return false;
+		SetBoth(fprs, d, FPR_SINGLE);
+		return true;
+	case 63:
+		if (inst.SUBOP5 >= 18)
+		{
+			if (!IsNumber(fprs, a) || !IsNumber(fprs, b) || !IsNumber(fprs, c))
+				return false;
+			// fsel picks one of them
+			fprs[d][0] = inst.SUBOP5 == 23 ? Combine(fprs[b][0], fprs[c][0]) : FPR_DOUBLE;
+			return true;
+		}
+		switch (inst.SUBOP10)
+		{
+		case 0: case 32: // fcmpu, fcmpo
+			return IsNumber(fprs, a) && IsNumber(fprs, b);
+		case 12: // frsp
+			if (!IsNumber(fprs, b))
+				return false;
+			SetBoth(fprs, d, FPR_SINGLE);
+			return true;
+		case 14: case 15: // fctiw, fctiwz
+			if (!IsNumber(fprs, b))
+				return false;
+			fprs[d][0] = FPR_INTEGER;
+			return true;
+		default: // fneg, fmr, fnabs, fabs only touch the sign
+			fprs[d][0] = fprs[b][0];
+			return true;
+		}
+	case 4:
+		switch (inst.SUBOP10)
+		{
+		case 0: case 32: case 64: case 96: // ps_cmp*
+			return IsNumber(fprs, a) && IsNumber(fprs, b);
+		case 528: case 560: case 592: case 624: // ps_merge*
+			{
+				if (!IsPairedInput(fprs, a, packed_singles) || !IsPairedInput(fprs, b, packed_singles))
+					return false;
+				FPRContents ps0 = fprs[a][(inst.SUBOP10 >> 6) & 1];
+				FPRContents ps1 = fprs[b][(inst.SUBOP10 >> 5) & 1];
+				fprs[d][0] = ps0;
+				fprs[d][1] = ps1;
+				return true;
+			}
+		case 40: case 72: case 136: case 264: // ps_neg, ps_mr, ps_nabs, ps_abs
+			fprs[d][0] = fprs[b][0];
+			fprs[d][1] = fprs[b][1];
+			return true;
+		}
+		if (!IsPairedInput(fprs, a, packed_singles) || !IsPairedInput(fprs, b, packed_singles) ||
+		    !IsPairedInput(fprs, c, packed_singles))
+			return false;
+		// JitIL also rounds the product to a single before adding.
+		if (packed_singles && (inst.SUBOP5 == 14 || inst.SUBOP5 == 15 || inst.SUBOP5 >= 28))
+			return false;
+		if (inst.SUBOP5 == 23)
+		{
+			// ps_sel
+			FPRContents ps0 = Combine(fprs[b][0], fprs[c][0]);
+			FPRContents ps1 = Combine(fprs[b][1], fprs[c][1]);
+			fprs[d][0] = ps0;
+			fprs[d][1] = ps1;
+		}
+		else
+		{
+			SetBoth(fprs, d, FPR_SINGLE);
+		}
+		return true;
+	default:
+		return true;
+	}
+}
+
+bool IsValidBlock(const std::vector<u32> &code, bool packed_singles)
+{
+	// Nothing is known about the random values the block starts with.
+	FPRState fprs;
+	for (int i = 0; i < 32; i++)
+		SetBoth(fprs, i, FPR_DOUBLE);
+	for (u32 inst : code)
+	{
+		if (!ApplyFPRContents(inst, fprs, packed_singles))
+			return false;
+	}
+	return true;
+}
+
+void StopCPU(u64 userdata, int cyclesLate)
+{
+	PowerPC::Pause();
+}
+
+}
+
+PPCJitTester::PPCJitTester(int _jit_core, u32 seed, bool verbose)
+	: jit_core(_jit_core), rng(seed ? seed : 1), be_verbose(verbose), num_cycles(NUM_CYCLES), run_count(0), fail_count(0)
+{
+	// Just the cores, PowerPC::Init would want the system timers.
+	PPCTables::InitTables(jit_core);
+	Interpreter::getInstance()->Init();
+	jit = JitInterface::InitJitCore(jit_core);
+}
+
+PPCJitTester::~PPCJitTester()
+{
+	JitInterface::Shutdown();
+	Interpreter::getInstance()->Shutdown();
+}
+
+u32 PPCJitTester::Random()
+{
+	// xorshift32, so that a seed means the same blocks everywhere
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return rng;
+}
+
+u64 PPCJitTester::RandomDouble()
+{
+	u64 sign = (u64)Random(2) << 63;
+	switch (Random(4))
+	{
+	case 0:
+		// a small integer. Never zero, x86 makes 0/0 a NaN with the sign set
+		// and the PowerPC one without.
+		{
+			double value = (double)(int)(1 + Random(8));
+			u64 hex;
+			memcpy(&hex, &value, sizeof(hex));
+			return hex | sign;
+		}
+	case 1:
+	case 2:
+		// representable as a single
+		{
+			u64 exponent = 1023 - 30 + Random(60);
+			u64 mantissa = (u64)(Random() & 0x7fffff) << 29;
+			return sign | (exponent << 52) | mantissa;
+		}
+	default:
+		{
+			u64 exponent = 1023 - 30 + Random(60);
+			u64 mantissa = (((u64)Random() << 32) | Random()) & 0xfffffffffffffULL;
+			return sign | (exponent << 52) | mantissa;
+		}
+	}
+}
+
+u32 PPCJitTester::RandomInstruction()
+{
+	int rd = Random(NUM_REGS);
+	int ra = Random(NUM_REGS);
+	int rb = Random(NUM_REGS);
+	int rc = Random(NUM_REGS);
+	u32 record = Random(2);
+	const Form *form;
+
+	switch (Random(20))
+	{
+	case 0:
+		{
+			u32 op = D_ARITHMETIC[Random(ArraySize(D_ARITHMETIC))];
+			u32 imm = Random(4) ? Random(0x200) - 0x100 : Random();
+			return D(op, rd, ra, imm);
+		}
+	case 1:
+		return D(D_LOGICAL[Random(ArraySize(D_LOGICAL))], rd, ra, Random());
+	case 2:
+		{
+			// cmpi, cmpli
+			u32 imm = Random(2) ? Random(0x20) - 0x10 : Random();
+			return D(Random(2) ? 11 : 10, Random(8) << 2, ra, imm);
+		}
+	case 3:
+	case 4:
+	case 5:
+		form = &XO_ARITHMETIC[Random(ArraySize(XO_ARITHMETIC))];
+		return X(31, rd, ra, Operand(form, USES_B, rb), form->xo) | record;
+	case 6:
+	case 7:
+		return X(31, rd, ra, rb, X_LOGICAL[Random(ArraySize(X_LOGICAL))]) | record;
+	case 8:
+		if (Random(2))
+			return X(31, rd, ra, 0, X_UNARY[Random(ArraySize(X_UNARY))]) | record;
+		// srawi
+		return X(31, rd, ra, Random(32), 824) | record;
+	case 9:
+		// cmp, cmpl
+		return X(31, Random(8) << 2, ra, rb, Random(2) ? 0 : 32);
+	case 10:
+		// rlwinm, rlwnm, rlwimi
+		{
+			static const u32 ops[] = {21, 23, 20};
+			return M(ops[Random(3)], rd, ra, Random(32), Random(32), Random(32)) | record;
+		}
+	case 11:
+		switch (Random(6))
+		{
+		case 0:
+			// mcrf
+			return X(19, Random(8) << 2, Random(8) << 2, 0, 0);
+		case 1:
+			// mfcr
+			return X(31, rd, 0, 0, 19);
+		case 2:
+			// mtcrf
+			return X(31, ra, 0, 0, 144) | (Random(256) << 12);
+		case 3:
+			// mcrxr
+			return X(31, Random(8) << 2, 0, 0, 512);
+		case 4:
+			// mfxer. No mtxer, see RandomState.
+			return X(31, rd, 1, 0, 339);
+		default:
+			return X(19, Random(32), Random(32), Random(32), XL_CR[Random(ArraySize(XL_CR))]);
+		}
+	case 12:
+	case 13:
+		{
+			const MemoryForm &memory_form = D_MEMORY[Random(ArraySize(D_MEMORY))];
+			u32 offset = Random(256 / memory_form.size) * memory_form.size;
+			return D(memory_form.op, rd, BASE_REG, offset);
+		}
+	case 14:
+		return X(31, rd, BASE_REG, INDEX_REG, X_MEMORY[Random(ArraySize(X_MEMORY))]);
+	case 15:
+		{
+			// psq_l, psq_st
+			u32 w = Random(2);
+			u32 offset = Random(0xf0 / 8) * 8;
+			return D(Random(2) ? 56 : 60, rd, BASE_REG, (w << 15) | (Random(8) << 12) | offset);
+		}
+	case 16:
+		{
+			u32 op = Random(2) ? 63 : 59;
+			form = &A_FLOAT[Random(ArraySize(A_FLOAT) - (op == 59))];
+			return A(op, rd, ra, Operand(form, USES_B, rb), Operand(form, USES_C, rc), form->xo);
+		}
+	case 17:
+		if (Random(4) == 0)
+		{
+			// fcmpu, fcmpo
+			return X(63, Random(8) << 2, ra, rb, Random(2) ? 0 : 32);
+		}
+		return X(63, rd, 0, rb, X_FLOAT_UNARY[Random(ArraySize(X_FLOAT_UNARY))]);
+	case 18:
+		form = &A_PAIRED[Random(ArraySize(A_PAIRED))];
+		return A(4, rd, ra, Operand(form, USES_B, rb), Operand(form, USES_C, rc), form->xo);
+	default:
+		if (Random(4) == 0)
+			return X(4, Random(8) << 2, ra, rb, X_PAIRED_COMPARE[Random(ArraySize(X_PAIRED_COMPARE))]);
+		form = &X_PAIRED[Random(ArraySize(X_PAIRED))];
+		return X(4, rd, Operand(form, USES_A, ra), rb, form->xo);
+	}
+}
+
+std::vector<u32> PPCJitTester::RandomBlock()
+{
+	std::vector<u32> code(1 + Random(MAX_BLOCK_SIZE));
+	FPRState fprs;
+	for (int i = 0; i < 32; i++)
+		SetBoth(fprs, i, FPR_DOUBLE);
+	for (u32 &inst : code)
+	{
+		do
+		{
+			inst = RandomInstruction();
+		} while (!ApplyFPRContents(inst, fprs, jit_core == JITIL_CORE));
+	}
+	return code;
+}
+
+PPCTestState PPCJitTester::ZeroState()
+{
+	PPCTestState state;
+	memset(&state, 0, sizeof(state));
+	state.pc = CODE_ADDRESS;
+	memcpy(state.gqr, GQRS, sizeof(state.gqr));
+	return state;
+}
+
+PPCTestState PPCJitTester::RandomState()
+{
+	static const u32 interesting[] = {0, 1, 0x7fffffff, 0x80000000, 0xffffffff, 0x8000, 0xffff};
+
+	PPCTestState state = ZeroState();
+	for (int i = 0; i < 32; i++)
+	{
+		switch (Random(3))
+		{
+		case 0:
+			state.gpr[i] = interesting[Random(ArraySize(interesting))];
+			break;
+		case 1:
+			state.gpr[i] = Random(0x200) - 0x100;
+			break;
+		default:
+			state.gpr[i] = Random();
+			break;
+		}
+		state.ps[i][0] = RandomDouble();
+		state.ps[i][1] = RandomDouble();
+	}
+	state.gpr[INDEX_REG] = INDEX_OFFSET;
+	state.gpr[BASE_REG] = DATA_ADDRESS;
+	state.cr = Random();
+	// OV, CA and the string byte count. The JITs don't copy SO into the CR
+	// fields the way the interpreter does, and without OE nothing sets it.
+	state.xer = (Random() & 0x60000000) | Random(128);
+	state.fpscr = 0;
+	// Doubles and pairs of singles to load. Random bytes would be denormals
+	// or NaNs as often as not.
+	for (u32 i = 0; i < sizeof(state.data); i += 8)
+	{
+		u64 hex;
+		if (Random(2))
+			hex = RandomDouble();
+		else
+			hex = ((u64)ToSingle(RandomDouble()) << 32) | ToSingle(RandomDouble());
+		hex = Common::swap64(hex);
+		memcpy(&state.data[i], &hex, sizeof(hex));
+	}
+	return state;
+}
+
+PPCTestState PPCJitTester::Run(CPUCoreBase *core, const std::vector<u32> &code, const PPCTestState &input)
+{
+	for (u32 i = 0; i < code.size(); i++)
+		Memory::Write_U32(code[i], CODE_ADDRESS + i * 4);
+	// b .
+	Memory::Write_U32(0x48000000, CODE_ADDRESS + (u32)code.size() * 4);
+	JitInterface::InvalidateICache(CODE_ADDRESS, ((u32)code.size() + 1) * 4);
+
+	memcpy(PowerPC::ppcState.gpr, input.gpr, sizeof(input.gpr));
+	memcpy(PowerPC::ppcState.ps, input.ps, sizeof(input.ps));
+	SetCR(input.cr);
+	PowerPC::ppcState.spr[SPR_XER] = input.xer;
+	PowerPC::ppcState.fpscr = input.fpscr;
+	for (int i = 0; i < 8; i++)
+		PowerPC::ppcState.spr[SPR_GQR0 + i] = input.gqr[i];
+	// Floating point available
+	MSR = 0x2000;
+	PC = input.pc;
+	for (u32 i = 0; i < sizeof(input.data); i++)
+		Memory::Write_U8(input.data[i], DATA_ADDRESS + i);
+
+	CoreTiming::Init();
+	int stop_event = CoreTiming::RegisterEvent("StopCPU", StopCPU);
+	CoreTiming::ScheduleEvent(num_cycles, stop_event);
+	PowerPC::Start();
+	core->Run();
+	CoreTiming::Shutdown();
+
+	PPCTestState state;
+	state.pc = PC;
+	memcpy(state.gpr, PowerPC::ppcState.gpr, sizeof(state.gpr));
+	memcpy(state.ps, PowerPC::ppcState.ps, sizeof(state.ps));
+	state.cr = GetCR();
+	state.xer = PowerPC::ppcState.spr[SPR_XER];
+	state.fpscr = PowerPC::ppcState.fpscr;
+	memcpy(state.gqr, input.gqr, sizeof(state.gqr));
+	for (u32 i = 0; i < sizeof(state.data); i++)
+		state.data[i] = Memory::Read_U8(DATA_ADDRESS + i);
+	return state;
+}
+
+PPCTestState PPCJitTester::RunInterpreter(const std::vector<u32> &code, const PPCTestState &input)
+{
+	return Run(Interpreter::getInstance(), code, input);
+}
+
+PPCTestState PPCJitTester::RunJit(const std::vector<u32> &code, const PPCTestState &input)
+{
+	return Run(jit, code, input);
+}
+
+bool PPCJitTester::AreEqual(const PPCTestState &a, const PPCTestState &b)
+{
+	return a.pc == b.pc && a.cr == b.cr && a.xer == b.xer &&
+	       (a.fpscr & FPSCR_CONTROL_MASK) == (b.fpscr & FPSCR_CONTROL_MASK) &&
+	       !memcmp(a.gpr, b.gpr, sizeof(a.gpr)) && !memcmp(a.ps, b.ps, sizeof(a.ps)) &&
+	       !memcmp(a.data, b.data, sizeof(a.data));
+}
+
+bool PPCJitTester::Diverges(const std::vector<u32> &code, const PPCTestState &input)
+{
+	return !AreEqual(RunInterpreter(code, input), RunJit(code, input));
+}
+
+bool PPCJitTester::Test(const std::vector<u32> &code, const PPCTestState &input)
+{
+	if (be_verbose)
+		DumpBlock(code);
+
+	run_count++;
+	if (!Diverges(code, input))
+		return true;
+
+	fail_count++;
+	return false;
+}
+
+std::vector<u32> PPCJitTester::Minimize(const std::vector<u32> &code, const PPCTestState &input)
+{
+	// Drop instructions one at a time, for as long as the rest still diverges.
+	std::vector<u32> minimized = code;
+	bool progress = true;
+	while (progress && minimized.size() > 1)
+	{
+		progress = false;
+		for (size_t i = minimized.size(); i-- > 0 && minimized.size() > 1;)
+		{
+			std::vector<u32> candidate = minimized;
+			candidate.erase(candidate.begin() + i);
+			if (IsValidBlock(candidate, jit_core == JITIL_CORE) && Diverges(candidate, input))
+			{
+				minimized = candidate;
+				progress = true;
+			}
+		}
+	}
+	return minimized;
+}
+
+int PPCJitTester::TestRandom(int count)
+{
+	int failed = 0;
+	for (int i = 0; i < count; i++)
+	{
+		std::vector<u32> code = RandomBlock();
+		PPCTestState input = RandomState();
+		if (Test(code, input))
+			continue;
+
+		failed++;
+		std::vector<u32> minimized = Minimize(code, input);
+		printf("FAIL (PPCJitTester): block %d diverges, cut down from %u to %u instructions:\n",
+		       i, (u32)code.size(), (u32)minimized.size());
+		DumpBlock(minimized);
+		DumpInput(input);
+		DumpDifferences(RunInterpreter(minimized, input), RunJit(minimized, input));
+	}
+	return failed;
+}
+
+void PPCJitTester::DumpBlock(const std::vector<u32> &code) const
+{
+	for (u32 i = 0; i < code.size(); i++)
+	{
+		char disasm[256];
+		DisassembleGekko(code[i], CODE_ADDRESS + i * 4, disasm, sizeof(disasm));
+		printf("  %08x  %08x  %s\n", CODE_ADDRESS + i * 4, code[i], disasm);
+	}
+}
+
+void PPCJitTester::DumpInput(const PPCTestState &input) const
+{
+	// Only the registers the generated code writes, the others keep their values.
+	for (int i = 0; i < NUM_REGS; i++)
+	{
+		printf("  in r%d: %08x  f%d: %016llx %016llx\n", i, input.gpr[i], i,
+		       (unsigned long long)input.ps[i][0], (unsigned long long)input.ps[i][1]);
+	}
+	printf("  in cr: %08x  xer: %08x\n", input.cr, input.xer);
+}
+
+void PPCJitTester::DumpDifferences(const PPCTestState &interpreter, const PPCTestState &jit_state) const
+{
+	if (interpreter.pc != jit_state.pc)
+		printf("  pc: %08x vs %08x\n", interpreter.pc, jit_state.pc);
+	for (int i = 0; i < 32; i++)
+	{
+		if (interpreter.gpr[i] != jit_state.gpr[i])
+			printf("  r%d: %08x vs %08x\n", i, interpreter.gpr[i], jit_state.gpr[i]);
+	}
+	for (int i = 0; i < 32; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			if (interpreter.ps[i][j] != jit_state.ps[i][j])
+			{
+				printf("  f%d ps%d: %016llx vs %016llx\n", i, j,
+				       (unsigned long long)interpreter.ps[i][j], (unsigned long long)jit_state.ps[i][j]);
+			}
+		}
+	}
+	if (interpreter.cr != jit_state.cr)
+		printf("  cr: %08x vs %08x\n", interpreter.cr, jit_state.cr);
+	if (interpreter.xer != jit_state.xer)
+		printf("  xer: %08x vs %08x\n", interpreter.xer, jit_state.xer);
+	if ((interpreter.fpscr & FPSCR_CONTROL_MASK) != (jit_state.fpscr & FPSCR_CONTROL_MASK))
+		printf("  fpscr: %08x vs %08x\n", interpreter.fpscr, jit_state.fpscr);
+	for (u32 i = 0; i < sizeof(interpreter.data); i++)
+	{
+		if (interpreter.data[i] != jit_state.data[i])
+			printf("  %08x: %02x vs %02x\n", DATA_ADDRESS + i, interpreter.data[i], jit_state.data[i]);
+	}
+}
+
+void PPCJitTester::Report() const
+{
+	printf("PPCJitTester (core %d): ran %d blocks, %d diverged from the interpreter\n",
+	       jit_core, run_count, fail_count);
+}
@@ -0,0 +1,124 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// How to use the PPCJitTester:
+//
+// == Before running ==
+// Memory has to be up, see TestEnvironment.h. JitIL's dispatcher goes through
+// PowerPC::CheckExceptions, which wants EXI as well:
+// TestEnvironment env;
+// env.InitMemory();
+// env.InitEXI();
+//
+// The tester sets up the opcode tables for the JIT it tests, and starts the
+// interpreter and the JIT itself.
+// == Creation of a tester ==
+// Test Jit64 (the cpu_core numbers JitInterface::InitJitCore takes) with a
+// fixed seed, so that failures can be reproduced:
+// PPCJitTester tester(1, 0x1234);
+//
+// To print every block that is run, set verbose to true:
+// PPCJitTester tester(1, 0x1234, true);
+//
+// == Running the tests ==
+// int failed = tester.TestRandom(1000); // run 1000 random blocks through both cores
+//
+// Or run a block of your own:
+// std::vector<u32> code = ...;
+// PPCTestState input = tester.RandomState();
+// bool success = tester.Test(code, input);
+//
+// Blocks can be as long as they like, and don't have to be random. To start
+// from nothing but zeroes, and look at the results yourself:
+// PPCTestState input = PPCJitTester::ZeroState();
+// PPCTestState interpreter = tester.RunInterpreter(code, input);
+// PPCTestState jit = tester.RunJit(code, input);
+// if (!PPCJitTester::AreEqual(interpreter, jit))
+//     tester.DumpDifferences(interpreter, jit);
+//
+// == Examining results ==
+// Blocks that end up in a different state in the interpreter and in the JIT are
+// cut down to the fewest instructions that still show the difference, and
+// printed along with the registers they start with and the ones that differ.
+//
+// tester.Report(); // display a small report afterwards
+//
+// The interpreter is the reference. Only the FPSCR control bits are compared,
+// the JITs don't keep the status bits up to date, and nothing that changes the
+// rounding mode or reads FPSCR back is generated for the same reason.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "CommonTypes.h"
+
+class CPUCoreBase;
+
+struct PPCTestState
+{
+	u32 pc;
+	u32 gpr[32];
+	u64 ps[32][2];
+	u32 cr;
+	u32 xer;
+	u32 fpscr;
+	u32 gqr[8];
+	// At PPCJitTester::DATA_ADDRESS
+	u8 data[0x200];
+};
+
+class PPCJitTester
+{
+public:
+	// Where blocks are run from, and where their data goes
+	static const u32 CODE_ADDRESS = 0x80003000;
+	static const u32 DATA_ADDRESS = 0x80004000;
+
+	PPCJitTester(int jit_core, u32 seed, bool verbose = false);
+	~PPCJitTester();
+
+	int TestRandom(int count);
+	bool Test(const std::vector<u32> &code, const PPCTestState &input);
+	std::vector<u32> Minimize(const std::vector<u32> &code, const PPCTestState &input);
+
+	std::vector<u32> RandomBlock();
+	PPCTestState RandomState();
+	// Everything 0 but the PC, and the GQRs the random states use
+	static PPCTestState ZeroState();
+
+	PPCTestState RunInterpreter(const std::vector<u32> &code, const PPCTestState &input);
+	PPCTestState RunJit(const std::vector<u32> &code, const PPCTestState &input);
+
+	// How long a block runs, 2000 cycles unless set. Enough to spin at the
+	// end a little, loops that have to get hot need more.
+	void SetNumCycles(int cycles) { num_cycles = cycles; }
+
+	int GetRunCount() const { return run_count; }
+	int GetFailCount() const { return fail_count; }
+	void Report() const;
+
+	void DumpDifferences(const PPCTestState &interpreter, const PPCTestState &jit_state) const;
+	static bool AreEqual(const PPCTestState &a, const PPCTestState &b);
+
+private:
+	CPUCoreBase *jit;
+	int jit_core;
+	u32 rng;
+	bool be_verbose;
+	int num_cycles;
+	int run_count;
+	int fail_count;
+
+	u32 Random();
+	u32 Random(u32 range) { return Random() % range; }
+	u32 RandomInstruction();
+	u64 RandomDouble();
+
+	PPCTestState Run(CPUCoreBase *core, const std::vector<u32> &code, const PPCTestState &input);
+	bool Diverges(const std::vector<u32> &code, const PPCTestState &input);
+	void DumpBlock(const std::vector<u32> &code) const;
+	void DumpInput(const PPCTestState &input) const;
+};
@@ -0,0 +1,161 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Runs random blocks through the interpreter and through Jit64 and JitIL, and
+// cuts down the ones that end up in a different state to the instructions
+// that make the difference. See PPCJitTester.h.
+//
+// Jit64 runs a second time with fastmem, along with a block whose loads and
+// stores hit hardware registers and have to be backpatched, and a third time
+// with a loop that gets hot enough to be compiled as a trace. Last, loads and
+// stores through addresses built from constants, which Jit64 works out at
+// compile time.
+
+#include <cstdio>
+
+#include "Core.h"
+#include "MemTools.h"
+
+#include "PPCJitTester.h"
+#include "TestEnvironment.h"
+
+extern int fail_count;
+
+namespace
+{
+
+const int NUM_BLOCKS = 500;
+
+// The EXI channel 0 registers, which Read_U32 and Write_U32 get to in both
+// cores, and fastmem only through a fault.
+const u32 EXI_ADDRESS = 0xCC006800;
+
+const u32 HARDWARE_BLOCK[] =
+{
+	0x80830000, // lwz    r4, 0(r3)
+	0xc0230000, // lfs    f1, 0(r3)
+	0x7c401c2e, // lfsx   f2, 0, r3
+	0xe0638000, // psq_l  f3, 0(r3), 1, 0
+	0xd0830004, // stfs   f4, 4(r3)
+	0x80a30004, // lwz    r5, 4(r3)
+	0xf0a38004, // psq_st f5, 4(r3), 1, 0
+	0x80c30004, // lwz    r6, 4(r3)
+};
+
+// Counts to 2000. Both conditional branches in the loop mostly go one way,
+// so the trace follows them and leaves through the side exits now and then.
+const u32 TRACE_LOOP[] =
+{
+	0x38600000, // li     r3, 0
+	0x38800000, // li     r4, 0
+	0x38a00000, // li     r5, 0
+	0x38630001, // addi   r3, r3, 1
+	0x7066003f, // andi.  r6, r3, 63
+	0x40820008, // bne    +8
+	0x38840064, // addi   r4, r4, 100
+	0x7c841a14, // add    r4, r4, r3
+	0x2c8305dc, // cmpwi  cr1, r3, 1500
+	0x41860008, // beq    cr1, +8
+	0x38a50001, // addi   r5, r5, 1
+	0x2c0307d0, // cmpwi  r3, 2000
+	0x4180ffdc, // blt    -36
+};
+
+// The fadd flushes the registers, the constants have to survive that. The
+// last four go to the EXI and memory interface handlers.
+const u32 CONSTANT_ADDRESS_BLOCK[] =
+{
+	0x3c608000, // lis    r3, 0x8000
+	0x60634000, // ori    r3, r3, 0x4000
+	0xfc20102a, // fadd   f1, f1, f2
+	0x80830008, // lwz    r4, 8(r3)
+	0x90830010, // stw    r4, 16(r3)
+	0xc8630018, // lfd    f3, 24(r3)
+	0xd8630020, // stfd   f3, 32(r3)
+	0x38a00028, // li     r5, 40
+	0x7c83292e, // stwx   r4, r3, r5
+	0x7cc3282e, // lwzx   r6, r3, r5
+	0x8ce30001, // lbzu   r7, 1(r3)
+	0x3d00cc00, // lis    r8, 0xcc00
+	0x61086800, // ori    r8, r8, 0x6800
+	0x81280000, // lwz    r9, 0(r8)
+	0x91280004, // stw    r9, 4(r8)
+	0x81480004, // lwz    r10, 4(r8)
+	0xa168d800, // lhz    r11, -0x2800(r8)
+};
+
+void TestCore(int core, u32 seed)
+{
+	PPCJitTester tester(core, seed);
+	fail_count += tester.TestRandom(NUM_BLOCKS);
+	tester.Report();
+}
+
+void TestBackpatch(int core, u32 seed)
+{
+	PPCJitTester tester(core, seed);
+	std::vector<u32> code(HARDWARE_BLOCK, HARDWARE_BLOCK + ArraySize(HARDWARE_BLOCK));
+	PPCTestState input = tester.RandomState();
+	// In a register, so that the JIT can't tell it isn't RAM.
+	input.gpr[3] = EXI_ADDRESS;
+	// Ordinary singles: what the registers read back as are denormals, and the
+	// interpreter and the JIT don't agree on storing those with psq_st.
+	input.ps[4][0] = 0x3ff8000000000000ULL; // 1.5
+	input.ps[5][0] = 0x4004000000000000ULL; // 2.5
+	if (!tester.Test(code, input))
+	{
+		printf("FAIL (PPCJitTests): backpatched hardware accesses differ from the interpreter's\n");
+		fail_count++;
+	}
+}
+
+void TestTraces(int core, u32 seed)
+{
+	PPCJitTester tester(core, seed);
+	tester.SetNumCycles(100000);
+	std::vector<u32> code(TRACE_LOOP, TRACE_LOOP + ArraySize(TRACE_LOOP));
+	if (!tester.Test(code, tester.RandomState()))
+	{
+		printf("FAIL (PPCJitTests): a loop compiled as a trace differs from the interpreter\n");
+		fail_count++;
+	}
+}
+
+void TestConstantAddresses(int core, u32 seed)
+{
+	PPCJitTester tester(core, seed);
+	std::vector<u32> code(CONSTANT_ADDRESS_BLOCK, CONSTANT_ADDRESS_BLOCK + ArraySize(CONSTANT_ADDRESS_BLOCK));
+	if (!tester.Test(code, tester.RandomState()))
+	{
+		printf("FAIL (PPCJitTests): accesses through constant addresses differ from the interpreter\n");
+		fail_count++;
+	}
+}
+
+}
+
+void PPCJitTests()
+{
+	TestEnvironment env;
+	env.InitMemory();
+	env.InitEXI();
+
+	TestCore(1, 0x50504331);
+	TestCore(2, 0x50504332);
+#ifdef _M_X64
+	EMM::InstallExceptionHandler();
+	Core::g_CoreStartupParameter.bFastmem = true;
+	TestCore(1, 0x50504333);
+	TestBackpatch(1, 0x50504334);
+	Core::g_CoreStartupParameter.bFastmem = false;
+#endif
+	Core::g_CoreStartupParameter.bJITTiered = true;
+	Core::g_CoreStartupParameter.bJITTraceFormation = true;
+	TestTraces(1, 0x50504335);
+	Core::g_CoreStartupParameter.bJITTiered = false;
+	Core::g_CoreStartupParameter.bJITTraceFormation = false;
+	Core::g_CoreStartupParameter.bJITConstantAddresses = true;
+	TestConstantAddresses(1, 0x50504336);
+	Core::g_CoreStartupParameter.bJITConstantAddresses = false;
+}
@@ -0,0 +1,213 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Runs paired single arithmetic, merges and quantized loads and stores through
+// the interpreter and through Jit64, once with the host's SSE4.1/AVX code
+// paths turned off and once for each level the host has, and checks that the
+// registers and the stored values come out bit for bit the same.
+
+#include <cstdio>
+#include <cstring>
+
+#include "Common.h"
+#include "CPUDetect.h"
+
+#include "PPCJitTester.h"
+#include "TestEnvironment.h"
+
+extern int fail_count;
+
+namespace
+{
+
+// Where the inputs and outputs go in PPCTestState::data
+const u32 QUANTIZED_OFFSET = 64;
+const u32 OUTPUT_OFFSET = 0x100;
+const u32 OUTPUT_SIZE = 0x100;
+const int NUM_CYCLES = 100000;
+
+// GQR load and store types
+enum
+{
+	QUANTIZE_FLOAT = 0,
+	QUANTIZE_U8 = 4,
+	QUANTIZE_U16 = 5,
+	QUANTIZE_S8 = 6,
+	QUANTIZE_S16 = 7,
+};
+
+u32 MakeGQR(u32 type, u32 scale)
+{
+	return (scale << 24) | (type << 16) | (scale << 8) | type;
+}
+
+const u32 GQRS[8] =
+{
+	0,
+	MakeGQR(QUANTIZE_U8, 3),
+	MakeGQR(QUANTIZE_S8, 0),
+	MakeGQR(QUANTIZE_U16, 4),
+	MakeGQR(QUANTIZE_S16, 1),
+	MakeGQR(QUANTIZE_S16, 62), // negative scale
+	0,
+	0,
+};
+
+const float INPUTS[16] =
+{
+	1.5f, -2.25f,
+	3.0e10f, 0.1f,
+	-0.0f, 7.0f,
+	-3.5f, 1.0e-3f,
+	0.33333f, -12.0f,
+	2.0f, -0.75f,
+	65536.5f, -0.001f,
+	5.0f, 123.456f,
+};
+
+// u8 {200, 17}, s8 {-100, 127}, u16 {0xfedc, 0x0123}, s16 {-32767, 32766}, big endian
+const u8 QUANTIZED_INPUTS[] = {200, 17, 0x9c, 0x7f, 0xfe, 0xdc, 0x01, 0x23, 0x80, 0x01, 0x7f, 0xfe};
+
+u32 PsqL(int frd, int ra, int offset, int w, int i)   { return (56 << 26) | (frd << 21) | (ra << 16) | (w << 15) | (i << 12) | (offset & 0xfff); }
+u32 PsqSt(int frs, int ra, int offset, int w, int i)  { return (60 << 26) | (frs << 21) | (ra << 16) | (w << 15) | (i << 12) | (offset & 0xfff); }
+u32 PsA(int xo, int d, int a, int b, int c)           { return (4 << 26) | (d << 21) | (a << 16) | (b << 11) | (c << 6) | (xo << 1); }
+u32 PsX(int xo, int d, int a, int b)                  { return (4 << 26) | (d << 21) | (a << 16) | (b << 11) | (xo << 1); }
+
+u32 ps_div(int d, int a, int b)           { return PsA(18, d, a, b, 0); }
+u32 ps_sub(int d, int a, int b)           { return PsA(20, d, a, b, 0); }
+u32 ps_add(int d, int a, int b)           { return PsA(21, d, a, b, 0); }
+u32 ps_sel(int d, int a, int c, int b)    { return PsA(23, d, a, b, c); }
+u32 ps_mul(int d, int a, int c)           { return PsA(25, d, a, 0, c); }
+u32 ps_sum1(int d, int a, int c, int b)   { return PsA(11, d, a, b, c); }
+u32 ps_muls0(int d, int a, int c)         { return PsA(12, d, a, 0, c); }
+u32 ps_muls1(int d, int a, int c)         { return PsA(13, d, a, 0, c); }
+u32 ps_madds0(int d, int a, int c, int b) { return PsA(14, d, a, b, c); }
+u32 ps_madds1(int d, int a, int c, int b) { return PsA(15, d, a, b, c); }
+u32 ps_msub(int d, int a, int c, int b)   { return PsA(28, d, a, b, c); }
+u32 ps_madd(int d, int a, int c, int b)   { return PsA(29, d, a, b, c); }
+u32 ps_nmsub(int d, int a, int c, int b)  { return PsA(30, d, a, b, c); }
+u32 ps_nmadd(int d, int a, int c, int b)  { return PsA(31, d, a, b, c); }
+u32 ps_neg(int d, int b)                  { return PsX(40, d, 0, b); }
+u32 ps_mr(int d, int b)                   { return PsX(72, d, 0, b); }
+u32 ps_nabs(int d, int b)                 { return PsX(136, d, 0, b); }
+u32 ps_abs(int d, int b)                  { return PsX(264, d, 0, b); }
+u32 ps_merge00(int d, int a, int b)       { return PsX(528, d, a, b); }
+u32 ps_merge01(int d, int a, int b)       { return PsX(560, d, a, b); }
+u32 ps_merge10(int d, int a, int b)       { return PsX(592, d, a, b); }
+u32 ps_merge11(int d, int a, int b)       { return PsX(624, d, a, b); }
+
+const u32 r3 = 3;
+
+const u32 PROGRAM[] =
+{
+	0x3c608000, // lis r3, 0x8000
+	0x60634000, // ori r3, r3, 0x4000
+
+	PsqL(1, r3, 0, 0, 0), PsqL(2, r3, 8, 0, 0), PsqL(3, r3, 16, 0, 0), PsqL(4, r3, 24, 0, 0),
+	PsqL(5, r3, 32, 0, 0), PsqL(6, r3, 40, 0, 0), PsqL(7, r3, 48, 0, 0), PsqL(8, r3, 56, 0, 0),
+	PsqL(20, r3, 64, 0, 1), PsqL(21, r3, 65, 1, 1),
+	PsqL(22, r3, 66, 0, 2), PsqL(23, r3, 68, 0, 3),
+	PsqL(24, r3, 72, 0, 4), PsqL(25, r3, 74, 1, 4),
+	PsqL(19, r3, 68, 0, 5),
+
+	// Every combination of d, a and b aliasing
+	ps_add(9, 1, 2), ps_sub(10, 1, 2),
+	ps_mr(11, 4), ps_sub(11, 3, 11),
+	ps_mr(12, 5), ps_add(12, 12, 6),
+	ps_mul(13, 1, 5), ps_div(14, 2, 6),
+	ps_mr(15, 7), ps_div(15, 8, 15),
+	ps_mr(16, 1), ps_mul(16, 16, 16),
+	ps_merge00(17, 1, 2), ps_merge01(18, 1, 2),
+	PsqSt(9, r3, 0x100, 0, 0), PsqSt(10, r3, 0x108, 0, 0), PsqSt(11, r3, 0x110, 0, 0),
+	PsqSt(12, r3, 0x118, 0, 0), PsqSt(13, r3, 0x120, 0, 0), PsqSt(14, r3, 0x128, 0, 0),
+	PsqSt(15, r3, 0x130, 0, 0), PsqSt(16, r3, 0x138, 0, 0), PsqSt(17, r3, 0x140, 0, 0),
+	PsqSt(18, r3, 0x148, 0, 0),
+
+	ps_merge10(9, 1, 2), ps_merge11(10, 1, 2),
+	ps_mr(11, 3), ps_merge01(11, 11, 4),
+	ps_mr(12, 4), ps_merge01(12, 3, 12),
+	ps_mr(13, 3), ps_merge10(13, 13, 4),
+	ps_sum1(14, 1, 6, 5),
+	ps_muls0(15, 2, 7), ps_muls1(16, 3, 8),
+	ps_mr(17, 8), ps_muls1(17, 17, 4),
+	ps_madd(18, 1, 2, 3),
+	PsqSt(9, r3, 0x150, 0, 0), PsqSt(10, r3, 0x158, 0, 0), PsqSt(11, r3, 0x160, 0, 0),
+	PsqSt(12, r3, 0x168, 0, 0), PsqSt(13, r3, 0x170, 0, 0), PsqSt(14, r3, 0x178, 0, 0),
+	PsqSt(15, r3, 0x180, 0, 0), PsqSt(16, r3, 0x188, 0, 0), PsqSt(17, r3, 0x190, 0, 0),
+	PsqSt(18, r3, 0x198, 0, 0),
+
+	ps_msub(9, 4, 5, 6), ps_nmadd(10, 1, 7, 8), ps_nmsub(11, 2, 3, 4),
+	ps_madds0(12, 5, 6, 7), ps_madds1(13, 8, 1, 2),
+	ps_mr(14, 3), ps_madd(14, 1, 14, 2),
+	ps_sel(15, 3, 1, 2), ps_sel(16, 4, 5, 6),
+	ps_neg(17, 3), ps_abs(26, 4), ps_nabs(27, 3),
+
+	// Quantized stores, pairs and singles, clamping included
+	PsqSt(20, r3, 0x1a0, 0, 1), PsqSt(22, r3, 0x1a2, 0, 2),
+	PsqSt(23, r3, 0x1a4, 0, 3), PsqSt(24, r3, 0x1a8, 0, 4),
+	PsqSt(19, r3, 0x1ac, 0, 5),
+	PsqSt(7, r3, 0x1b0, 0, 3), PsqSt(8, r3, 0x1b4, 0, 4), PsqSt(8, r3, 0x1b8, 0, 1),
+	PsqSt(21, r3, 0x1c0, 1, 1), PsqSt(25, r3, 0x1c2, 1, 4),
+};
+
+PPCTestState InputState()
+{
+	PPCTestState state = PPCJitTester::ZeroState();
+	memcpy(state.gqr, GQRS, sizeof(state.gqr));
+	for (int i = 0; i < 16; i++)
+	{
+		u32 hex;
+		memcpy(&hex, &INPUTS[i], sizeof(hex));
+		hex = Common::swap32(hex);
+		memcpy(&state.data[i * 4], &hex, sizeof(hex));
+	}
+	memcpy(&state.data[QUANTIZED_OFFSET], QUANTIZED_INPUTS, sizeof(QUANTIZED_INPUTS));
+	memset(&state.data[OUTPUT_OFFSET], 0xcc, OUTPUT_SIZE);
+	return state;
+}
+
+}
+
+void PairedSingleTests()
+{
+	TestEnvironment env;
+	env.InitMemory();
+
+	std::vector<u32> code(PROGRAM, PROGRAM + ArraySize(PROGRAM));
+	PPCTestState input = InputState();
+
+	// The JIT picks its code paths when it starts, from what the host has.
+	const CPUInfo host = cpu_info;
+	struct
+	{
+		const char *name;
+		bool ssse3, sse4_1, avx;
+	} levels[] =
+	{
+		{"SSE2", false, false, false},
+		{"SSSE3", true, false, false},
+		{"SSE4.1", true, true, false},
+		{"AVX", true, true, true},
+	};
+	for (const auto &level : levels)
+	{
+		if ((level.ssse3 && !host.bSSSE3) || (level.sse4_1 && !host.bSSE4_1) || (level.avx && !host.bAVX))
+			continue;
+		cpu_info.bSSSE3 = level.ssse3;
+		cpu_info.bSSE4_1 = level.sse4_1;
+		cpu_info.bAVX = level.avx;
+
+		PPCJitTester tester(1, 0);
+		tester.SetNumCycles(NUM_CYCLES);
+		PPCTestState interpreter = tester.RunInterpreter(code, input);
+		PPCTestState jit = tester.RunJit(code, input);
+		if (!PPCJitTester::AreEqual(interpreter, jit))
+		{
+			printf("FAIL (PairedSingleTests): %s: Jit64 differs from the interpreter:\n", level.name);
+			tester.DumpDifferences(interpreter, jit);
+			fail_count++;
+		}
+	}
+	cpu_info = host;
+}
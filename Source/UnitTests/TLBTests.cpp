@@ -0,0 +1,149 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Maps a range of effective addresses through the page table the way MMU
+// games do, checks that Memory's fast TLB tables pick the translations up
+// (and drop them on tlbie and segment register changes), and compares the
+// cost of an access through Memory::Read_U32, which is what the JIT called
+// for every MMU access, with the table lookup its inline fast path does
+// instead.
+
+#include <cstdio>
+
+#include "Timer.h"
+#include "HW/Memmap.h"
+#include "PowerPC/PowerPC.h"
+#include "PowerPC/Interpreter/Interpreter.h"
+
+#include "TestEnvironment.h"
+
+extern int fail_count;
+
+namespace
+{
+
+const u32 PAGE_TABLE_BASE = 0x00300000;
+const u32 VIRTUAL_BASE = 0x7E000000;
+const u32 PHYSICAL_BASE = 0x00100000;
+const u32 VSID = 0x123;
+const u32 NUM_PAGES = 256;
+const u32 NUM_ACCESSES = 10000000;
+
+// Physical page for a virtual one; backwards, so that an identity mapping bug shows.
+u32 PhysicalPage(u32 i)
+{
+	return PHYSICAL_BASE + (NUM_PAGES - 1 - i) * 0x1000;
+}
+
+void MapPages()
+{
+	// 64KB page table, hash mask 0x3ff.
+	PowerPC::ppcState.spr[SPR_SDR] = PAGE_TABLE_BASE;
+	Memory::SDRUpdated();
+	PowerPC::ppcState.sr[VIRTUAL_BASE >> 28] = VSID;
+
+	for (u32 i = 0; i < NUM_PAGES; i++)
+	{
+		u32 address = VIRTUAL_BASE + i * 0x1000;
+		u32 page_index = (address >> 12) & 0xffff;
+		u32 api = (address >> 22) & 0x3f;
+		u32 pteg_addr = (((VSID ^ page_index) & 0x3ff) << 6) | PAGE_TABLE_BASE;
+
+		// First free slot in the primary group.
+		while (Memory::Read_U32(0x80000000 | pteg_addr) & 0x80000000)
+			pteg_addr += 8;
+		Memory::Write_U32(0x80000000 | (VSID << 7) | api, 0x80000000 | pteg_addr);
+		Memory::Write_U32(PhysicalPage(i), 0x80000000 | (pteg_addr + 4));
+
+		// Each word holds its own effective address.
+		for (u32 offset = 0; offset < 0x1000; offset += 4)
+			Memory::Write_U32(address + offset, 0x80000000 | (PhysicalPage(i) + offset));
+	}
+}
+
+void CheckTranslations()
+{
+	for (u32 i = 0; i < NUM_PAGES; i++)
+	{
+		u32 address = VIRTUAL_BASE + i * 0x1000 + 0x124;
+		u32 value = Memory::Read_U32(address);
+		u32 entry = Memory::fast_tlb_read[address >> Memory::FAST_TLB_PAGE_SHIFT];
+		if (value != address || entry != (0x80000000 | PhysicalPage(i)))
+		{
+			printf("FAIL (TLBTests): %08x read %08x, fast TLB entry %08x, expected %08x\n",
+			       address, value, entry, 0x80000000 | PhysicalPage(i));
+			fail_count++;
+			return;
+		}
+	}
+
+	Memory::Write_U32(0x11223344, VIRTUAL_BASE + 8);
+	if (Memory::fast_tlb_write[VIRTUAL_BASE >> Memory::FAST_TLB_PAGE_SHIFT] != (0x80000000 | PhysicalPage(0)) ||
+	    Memory::Read_U32(0x80000000 | (PhysicalPage(0) + 8)) != 0x11223344)
+	{
+		printf("FAIL (TLBTests): write through the MMU didn't land in the fast TLB\n");
+		fail_count++;
+	}
+
+	Memory::InvalidateTLBEntry(VIRTUAL_BASE);
+	if (Memory::fast_tlb_read[VIRTUAL_BASE >> Memory::FAST_TLB_PAGE_SHIFT] ||
+	    Memory::fast_tlb_write[VIRTUAL_BASE >> Memory::FAST_TLB_PAGE_SHIFT])
+	{
+		printf("FAIL (TLBTests): tlbie left the page in the fast TLB\n");
+		fail_count++;
+	}
+
+	// mtsrin r3, r4: moving the segment to another VSID makes its translations stale.
+	Memory::Read_U32(VIRTUAL_BASE);
+	PowerPC::ppcState.gpr[3] = VSID + 1;
+	PowerPC::ppcState.gpr[4] = VIRTUAL_BASE;
+	Interpreter::mtsrin(UGeckoInstruction((31 << 26) | (3 << 21) | (4 << 11) | (242 << 1)));
+	if (Memory::fast_tlb_read[VIRTUAL_BASE >> Memory::FAST_TLB_PAGE_SHIFT])
+	{
+		printf("FAIL (TLBTests): segment register change left the page in the fast TLB\n");
+		fail_count++;
+	}
+	PowerPC::ppcState.sr[VIRTUAL_BASE >> 28] = VSID;
+}
+
+}
+
+void TLBTests()
+{
+	TestEnvironment env;
+	env.params.bMMU = true;
+	env.InitMemory();
+
+	MapPages();
+	CheckTranslations();
+
+	// Warm everything up again after the tlbie above.
+	for (u32 i = 0; i < NUM_PAGES; i++)
+		Memory::Read_U32(VIRTUAL_BASE + i * 0x1000);
+
+	Common::Timer timer;
+	u32 sum_slow = 0;
+	timer.Start();
+	for (u32 i = 0; i < NUM_ACCESSES; i++)
+		sum_slow += Memory::Read_U32(VIRTUAL_BASE + ((i * 0x1004) & (NUM_PAGES * 0x1000 - 4)));
+	u64 slow_ms = timer.GetTimeElapsed();
+
+	u32 sum_fast = 0;
+	timer.Start();
+	for (u32 i = 0; i < NUM_ACCESSES; i++)
+	{
+		u32 address = VIRTUAL_BASE + ((i * 0x1004) & (NUM_PAGES * 0x1000 - 4));
+		u32 page = Memory::fast_tlb_read[address >> Memory::FAST_TLB_PAGE_SHIFT];
+		sum_fast += Common::swap32(*(u32 *)(Memory::base + (page | (address & 0xfff))));
+	}
+	u64 fast_ms = timer.GetTimeElapsed();
+
+	printf("TLB: %u MMU reads through Memory::Read_U32 in %u ms, through the fast TLB in %u ms\n",
+	       NUM_ACCESSES, (u32)slow_ms, (u32)fast_ms);
+	if (sum_slow != sum_fast)
+	{
+		printf("FAIL (TLBTests): fast TLB reads disagree with Memory::Read_U32\n");
+		fail_count++;
+	}
+}
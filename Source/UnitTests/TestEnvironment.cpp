@@ -0,0 +1,74 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "ConfigManager.h"
+#include "Core.h"
+#include "LogManager.h"
+#include "VideoBackendBase.h"
+#include "HW/EXI.h"
+#include "HW/Memmap.h"
+
+#include "TestEnvironment.h"
+
+SCoreStartupParameter &TestEnvironment::InitConfig()
+{
+	LogManager::Init();
+	SConfig::Init();
+	return SConfig::GetInstance().m_LocalCoreStartupParameter;
+}
+
+TestEnvironment::TestEnvironment()
+	: params(InitConfig())
+	, saved_params(params)
+	, memory_running(false)
+	, exi_running(false)
+{
+	VideoBackend::PopulateList();
+	VideoBackend::ActivateBackend("");
+
+	params.bMMU = false;
+	params.bTLBHack = false;
+	params.bEnableDebugging = false;
+	params.bWii = false;
+	params.bFastmem = false;
+	params.bSkipIdle = false;
+	params.bEnableFPRF = false;
+	params.bJITTiered = false;
+	params.bJITBackgroundCompile = false;
+	params.bJITTraceFormation = false;
+	params.bJITConstantAddresses = false;
+
+	for (int i = 0; i < 3; i++)
+		saved_exi_devices[i] = SConfig::GetInstance().m_EXIDevice[i];
+}
+
+TestEnvironment::~TestEnvironment()
+{
+	if (exi_running)
+		ExpansionInterface::Shutdown();
+	if (memory_running)
+		Memory::Shutdown();
+	VideoBackend::ClearList();
+
+	for (int i = 0; i < 3; i++)
+		SConfig::GetInstance().m_EXIDevice[i] = saved_exi_devices[i];
+	params = saved_params;
+	SConfig::Shutdown();
+	LogManager::Shutdown();
+}
+
+void TestEnvironment::InitMemory()
+{
+	Core::g_CoreStartupParameter = params;
+	Memory::Init();
+	memory_running = true;
+}
+
+void TestEnvironment::InitEXI()
+{
+	for (int i = 0; i < 3; i++)
+		SConfig::GetInstance().m_EXIDevice[i] = EXIDEVICE_NONE;
+	ExpansionInterface::Init();
+	exi_running = true;
+}
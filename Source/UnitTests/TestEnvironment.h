@@ -0,0 +1,46 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Brings up what the core tests need around them, and takes it down again:
+//
+// TestEnvironment env;
+// env.params.bMMU = true; // anything the test wants different
+// env.InitMemory();
+// ... // Memory, and EXI after InitEXI, are up until env goes out of scope
+//
+// The local startup parameters start out as a GameCube with no MMU, fastmem,
+// idle skipping, debugging or FPRF, and a JIT that compiles every block on
+// the spot, whatever the user's ini says. They, and the EXI devices, are put
+// back before SConfig::Shutdown writes the settings out.
+
+#pragma once
+
+#include "CoreParameter.h"
+#include "HW/EXI_Device.h"
+
+class TestEnvironment
+{
+public:
+	TestEnvironment();
+	~TestEnvironment();
+
+	// Copies params to Core::g_CoreStartupParameter and starts Memory.
+	// Memory::Init wants the video backend's CP and PE handlers, which the
+	// constructor sets up.
+	void InitMemory();
+
+	// Starts EXI with nothing plugged in. Anything that goes through
+	// PowerPC::CheckExceptions asks EXI about its interrupts.
+	void InitEXI();
+
+	SCoreStartupParameter &params;
+
+private:
+	SCoreStartupParameter saved_params;
+	TEXIDevices saved_exi_devices[3];
+	bool memory_running;
+	bool exi_running;
+
+	static SCoreStartupParameter &InitConfig();
+};
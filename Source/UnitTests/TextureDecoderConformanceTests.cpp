@@ -0,0 +1,322 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Decodes deterministic random data in every texture format, TLUT format and a
+// range of sizes with the generic C decoder and the x64 decoder (with and
+// without AVX2), and requires all of them to produce the same output.
+//
+// Define TEXTURE_DECODER_BENCHMARK to also measure the throughput of each
+// decoder, to check whether a decoder optimization actually pays off. That
+// takes about 20 seconds.
+//
+// TextureDecoder_Generic.cpp defines the same functions as TextureDecoder_x64.cpp,
+// so it's built into its own namespace here. Everything it includes has to be
+// included before that, it also gets its own copy of texMem.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Common.h"
+#include "CPUDetect.h"
+#include "LookUpTables.h"
+#include "TextureDecoder.h"
+#include "Timer.h"
+#include "VideoConfig.h"
+
+// #define TEXTURE_DECODER_BENCHMARK
+
+namespace GenericTextureDecoder
+{
+#include "TextureDecoder_Generic.cpp"
+}
+
+extern int fail_count;
+
+namespace
+{
+
+enum Implementation
+{
+	IMPL_GENERIC,
+	IMPL_X64,
+	IMPL_X64_AVX2,
+	NUM_IMPLEMENTATIONS
+};
+
+const char *const impl_names[NUM_IMPLEMENTATIONS] = { "Generic", "x64", "AVX2" };
+
+struct TexFormatInfo
+{
+	int texformat;
+	const char *name;
+	bool paletted;
+};
+
+// The formats TexDecoder_Decode can decode
+const TexFormatInfo tex_formats[] = {
+	{ GX_TF_I4, "I4", false },
+	{ GX_TF_I8, "I8", false },
+	{ GX_TF_IA4, "IA4", false },
+	{ GX_TF_IA8, "IA8", false },
+	{ GX_TF_RGB565, "RGB565", false },
+	{ GX_TF_RGB5A3, "RGB5A3", false },
+	{ GX_TF_RGBA8, "RGBA8", false },
+	{ GX_TF_C4, "C4", true },
+	{ GX_TF_C8, "C8", true },
+	{ GX_TF_C14X2, "C14X2", true },
+	{ GX_TF_CMPR, "CMPR", false },
+};
+
+// Copy and Z texture formats, which only exist in EFB copies. The decoders
+// don't handle them, but have to agree on their sizes.
+const TexFormatInfo copy_formats[] = {
+	{ GX_CTF_R4, "CTF_R4", false },
+	{ GX_CTF_RA4, "CTF_RA4", false },
+	{ GX_CTF_RA8, "CTF_RA8", false },
+	{ GX_CTF_YUVA8, "CTF_YUVA8", false },
+	{ GX_CTF_A8, "CTF_A8", false },
+	{ GX_CTF_R8, "CTF_R8", false },
+	{ GX_CTF_G8, "CTF_G8", false },
+	{ GX_CTF_B8, "CTF_B8", false },
+	{ GX_CTF_RG8, "CTF_RG8", false },
+	{ GX_CTF_GB8, "CTF_GB8", false },
+	{ GX_TF_Z8, "Z8", false },
+	{ GX_TF_Z16, "Z16", false },
+	{ GX_TF_Z24X8, "Z24X8", false },
+	{ GX_CTF_Z4, "CTF_Z4", false },
+	{ GX_CTF_Z8M, "CTF_Z8M", false },
+	{ GX_CTF_Z8L, "CTF_Z8L", false },
+	{ GX_CTF_Z16L, "CTF_Z16L", false },
+};
+
+const char *const tlut_names[] = { "IA8", "RGB565", "RGB5A3", "3" };
+
+// Somewhere in the middle of TMEM, large enough for a C14X2 TLUT.
+const int test_tlutaddr = 0x80000;
+const int tlut_size = 0x8000;
+
+// Bytes after the end of each decoded texture which no decoder may touch.
+const int guard_size = 64;
+const u8 guard_value = 0xCD;
+
+// Same data on every run, unlike rand().
+class TestRandom
+{
+public:
+	TestRandom(u32 seed) : m_state(seed * 2654435761u + 1) {}
+
+	u8 Next()
+	{
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 17;
+		m_state ^= m_state << 5;
+		return (u8)(m_state >> 8);
+	}
+
+	void Fill(u8 *data, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+			data[i] = Next();
+	}
+
+private:
+	u32 m_state;
+};
+
+void SetTLUT(u32 seed)
+{
+	TestRandom random(seed);
+	random.Fill(texMem + test_tlutaddr, tlut_size);
+	memcpy(GenericTextureDecoder::texMem + test_tlutaddr, texMem + test_tlutaddr, tlut_size);
+}
+
+PC_TexFormat Decode(Implementation impl, u8 *dst, const u8 *src, int width, int height, int texformat, int tlutfmt, bool rgba_only)
+{
+	if (impl == IMPL_GENERIC)
+		return GenericTextureDecoder::TexDecoder_Decode(dst, src, width, height, texformat, test_tlutaddr, tlutfmt, rgba_only);
+
+	const bool has_avx2 = cpu_info.bAVX2;
+	cpu_info.bAVX2 = (impl == IMPL_X64_AVX2);
+	PC_TexFormat pcfmt = TexDecoder_Decode(dst, src, width, height, texformat, test_tlutaddr, tlutfmt, rgba_only);
+	cpu_info.bAVX2 = has_avx2;
+	return pcfmt;
+}
+
+int NumImplementations()
+{
+	return cpu_info.bAVX2 ? NUM_IMPLEMENTATIONS : IMPL_X64_AVX2;
+}
+
+void TestDecode(const TexFormatInfo &format, int tlutfmt, int width, int height, bool rgba_only)
+{
+	TestRandom random((format.texformat << 24) ^ (tlutfmt << 20) ^ (width << 10) ^ height ^ (rgba_only << 30));
+	std::vector<u8> src(TexDecoder_GetTextureSizeInBytes(width, height, format.texformat));
+	random.Fill(&src[0], src.size());
+
+	const size_t dst_size = width * height * 4;
+	std::vector<u8> expected(dst_size + guard_size, guard_value);
+	PC_TexFormat expected_fmt = Decode(IMPL_GENERIC, &expected[0], &src[0], width, height, format.texformat, tlutfmt, rgba_only);
+
+	for (int impl = IMPL_GENERIC; impl < NumImplementations(); impl++)
+	{
+		std::vector<u8> actual(dst_size + guard_size, guard_value);
+		PC_TexFormat actual_fmt = Decode((Implementation)impl, &actual[0], &src[0], width, height, format.texformat, tlutfmt, rgba_only);
+
+		for (int i = 0; i < guard_size; i++)
+		{
+			if (actual[dst_size + i] != guard_value)
+			{
+				printf("FAIL (TextureDecoderConformanceTests): %s %s decoder wrote past a %dx%d%s texture\n",
+					impl_names[impl], format.name, width, height, rgba_only ? " (RGBA)" : "");
+				fail_count++;
+				break;
+			}
+		}
+
+		if (actual_fmt != expected_fmt)
+		{
+			printf("FAIL (TextureDecoderConformanceTests): %s %s (TLUT %s) %dx%d%s: format %d, generic %d\n",
+				impl_names[impl], format.name, tlut_names[tlutfmt], width, height, rgba_only ? " (RGBA)" : "",
+				actual_fmt, expected_fmt);
+			fail_count++;
+		}
+		else if (memcmp(&actual[0], &expected[0], dst_size) != 0)
+		{
+			size_t first = 0;
+			while (actual[first] == expected[first])
+				first++;
+			printf("FAIL (TextureDecoderConformanceTests): %s %s (TLUT %s) %dx%d%s: differs from generic at byte %u\n",
+				impl_names[impl], format.name, tlut_names[tlutfmt], width, height, rgba_only ? " (RGBA)" : "",
+				(u32)first);
+			fail_count++;
+		}
+	}
+}
+
+void TestFormatInfo(const TexFormatInfo &format)
+{
+	const u32 fmt = format.texformat;
+	if (TexDecoder_GetTexelSizeInNibbles(fmt) != GenericTextureDecoder::TexDecoder_GetTexelSizeInNibbles(fmt) ||
+		TexDecoder_GetBlockWidthInTexels(fmt) != GenericTextureDecoder::TexDecoder_GetBlockWidthInTexels(fmt) ||
+		TexDecoder_GetBlockHeightInTexels(fmt) != GenericTextureDecoder::TexDecoder_GetBlockHeightInTexels(fmt) ||
+		TexDecoder_GetTextureSizeInBytes(64, 32, fmt) != GenericTextureDecoder::TexDecoder_GetTextureSizeInBytes(64, 32, fmt) ||
+		TexDecoder_GetPaletteSize(fmt) != GenericTextureDecoder::TexDecoder_GetPaletteSize(fmt))
+	{
+		printf("FAIL (TextureDecoderConformanceTests): decoders disagree on the size of %s textures\n", format.name);
+		fail_count++;
+	}
+
+	for (int tlutfmt = 0; tlutfmt < 4; tlutfmt++)
+	{
+		if (GetPC_TexFormat(fmt, tlutfmt) != GenericTextureDecoder::GetPC_TexFormat(fmt, tlutfmt))
+		{
+			printf("FAIL (TextureDecoderConformanceTests): decoders disagree on the PC format of %s (TLUT %s)\n",
+				format.name, tlut_names[tlutfmt]);
+			fail_count++;
+		}
+	}
+}
+
+// The copy formats are never decoded, but the decoders still have to agree on
+// what they return for them, and leave the destination alone.
+void TestCopyFormat(const TexFormatInfo &format)
+{
+	TestFormatInfo(format);
+
+	std::vector<u8> src(TexDecoder_GetTextureSizeInBytes(32, 32, format.texformat), 0);
+	for (int rgba_only = 0; rgba_only < 2; rgba_only++)
+	{
+		std::vector<u8> dst(32 * 32 * 4, guard_value);
+		PC_TexFormat expected_fmt = Decode(IMPL_GENERIC, &dst[0], &src[0], 32, 32, format.texformat, 0, rgba_only != 0);
+		for (int impl = IMPL_GENERIC; impl < NumImplementations(); impl++)
+		{
+			PC_TexFormat actual_fmt = Decode((Implementation)impl, &dst[0], &src[0], 32, 32, format.texformat, 0, rgba_only != 0);
+			if (actual_fmt != expected_fmt ||
+				std::count(dst.begin(), dst.end(), guard_value) != (ptrdiff_t)dst.size())
+			{
+				printf("FAIL (TextureDecoderConformanceTests): %s decoder handles copy format %s%s differently\n",
+					impl_names[impl], format.name, rgba_only ? " (RGBA)" : "");
+				fail_count++;
+			}
+		}
+	}
+}
+
+#ifdef TEXTURE_DECODER_BENCHMARK
+// Decodes the same texture for about 200 ms and returns the source throughput in MB/s.
+double MeasureDecode(Implementation impl, const TexFormatInfo &format, int tlutfmt, bool rgba_only,
+	const std::vector<u8> &src, std::vector<u8> &dst, int width, int height)
+{
+	Common::Timer timer;
+	timer.Start();
+	u64 elapsed = 0;
+	int iterations = 0;
+	do
+	{
+		Decode(impl, &dst[0], &src[0], width, height, format.texformat, tlutfmt, rgba_only);
+		iterations++;
+		elapsed = timer.GetTimeElapsed();
+	} while (elapsed < 200);
+
+	return (double)src.size() * iterations / (1024.0 * 1024.0) / (elapsed / 1000.0);
+}
+
+void BenchmarkFormat(const TexFormatInfo &format, int tlutfmt, bool rgba_only)
+{
+	const int width = 1024;
+	const int height = 1024;
+	TestRandom random(format.texformat);
+	std::vector<u8> src(TexDecoder_GetTextureSizeInBytes(width, height, format.texformat));
+	std::vector<u8> dst(width * height * 4);
+	random.Fill(&src[0], src.size());
+
+	char name[32];
+	if (format.paletted)
+		sprintf(name, "%s/%s", format.name, tlut_names[tlutfmt]);
+	else
+		sprintf(name, "%s", format.name);
+
+	printf("TextureDecoder %-12s%s", name, rgba_only ? " RGBA:  " : " native:");
+	for (int impl = IMPL_GENERIC; impl < NumImplementations(); impl++)
+		printf(" %s %8.1f MB/s", impl_names[impl], MeasureDecode((Implementation)impl, format, tlutfmt, rgba_only, src, dst, width, height));
+	printf("\n");
+}
+#endif
+
+}
+
+void TextureDecoderConformanceTests()
+{
+	// Block sizes are at most 8x8, TextureCache always decodes whole blocks.
+	const int sizes[][2] = {
+		{ 8, 8 }, { 16, 8 }, { 8, 32 }, { 24, 40 }, { 64, 64 }, { 128, 32 },
+		{ 32, 256 }, { 200, 120 }, { 256, 256 }, { 1024, 512 },
+	};
+
+	if (!cpu_info.bAVX2)
+		printf("TextureDecoderConformanceTests: no AVX2, only comparing the generic and x64 decoders\n");
+
+	SetTLUT(1);
+	for (const TexFormatInfo &format : tex_formats)
+	{
+		TestFormatInfo(format);
+		for (const auto &size : sizes)
+			for (int rgba_only = 0; rgba_only < 2; rgba_only++)
+				for (int tlutfmt = 0; tlutfmt < (format.paletted ? 4 : 1); tlutfmt++)
+					TestDecode(format, tlutfmt, size[0], size[1], rgba_only != 0);
+	}
+
+	for (const TexFormatInfo &copy_format : copy_formats)
+		TestCopyFormat(copy_format);
+
+#ifdef TEXTURE_DECODER_BENCHMARK
+	for (const TexFormatInfo &format : tex_formats)
+		for (int rgba_only = 0; rgba_only < 2; rgba_only++)
+			for (int tlutfmt = 0; tlutfmt < (format.paletted ? 3 : 1); tlutfmt++)
+				BenchmarkFormat(format, tlutfmt, rgba_only != 0);
+#endif
+}
@@ -0,0 +1,127 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Decodes random RGBA8 and CMPR textures with TexDecoder_Decode and with the
+// threaded decoder, which splits them into slices, and checks that the results
+// are identical. Also checks that a prefetched texture is only handed out if
+// its data still matches.
+//
+// The decoders themselves are compared in TextureDecoderConformanceTests.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Hash.h"
+#include "AsyncTextureDecoder.h"
+#include "TextureDecoder.h"
+
+extern int fail_count;
+
+namespace
+{
+
+void FillRandom(std::vector<u8> &data)
+{
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = rand() & 0xFF;
+}
+
+void TestSlicedDecode(int texformat, const char *name, int width, int height, bool rgba_only)
+{
+	std::vector<u8> src(TexDecoder_GetTextureSizeInBytes(width, height, texformat));
+	FillRandom(src);
+
+	std::vector<u8> expected(width * height * 4, 0);
+	std::vector<u8> actual(width * height * 4, 0xCD);
+
+	PC_TexFormat expected_fmt = TexDecoder_Decode(&expected[0], &src[0], width, height, texformat, 0, 0, rgba_only);
+	PC_TexFormat actual_fmt = AsyncTextureDecoder::Decode(&actual[0], &src[0], width, height, texformat, 0, 0, rgba_only);
+
+	if (actual_fmt != expected_fmt || memcmp(&actual[0], &expected[0], actual.size()) != 0)
+	{
+		printf("FAIL (TextureDecoderTests): threaded %s decode of %dx%d%s differs\n",
+			name, width, height, rgba_only ? " (RGBA)" : "");
+		fail_count++;
+	}
+}
+
+void TestPrefetch()
+{
+	const int width = 256;
+	const int height = 256;
+	std::vector<u8> src(TexDecoder_GetTextureSizeInBytes(width, height, GX_TF_CMPR));
+	FillRandom(src);
+
+	std::vector<u8> expected(width * height * 4);
+	std::vector<u8> actual(width * height * 4, 0xCD);
+	PC_TexFormat expected_fmt = TexDecoder_Decode(&expected[0], &src[0], width, height, GX_TF_CMPR, 0, 0, false);
+	const u64 hash = GetHash64(&src[0], (int)src.size(), 0);
+
+	AsyncTextureDecoder::Prefetch(0, &src[0], width, height, GX_TF_CMPR, false, 0, 0);
+	if (AsyncTextureDecoder::WaitForPrefetch(0) != expected_fmt)
+	{
+		printf("FAIL (TextureDecoderTests): prefetched texture wasn't decoded\n");
+		fail_count++;
+	}
+	PC_TexFormat actual_fmt = AsyncTextureDecoder::GetPrefetched(&actual[0], 0, &src[0], width, height, GX_TF_CMPR, false, hash);
+	if (actual_fmt != expected_fmt || memcmp(&actual[0], &expected[0], actual.size()) != 0)
+	{
+		printf("FAIL (TextureDecoderTests): prefetched texture wasn't decoded correctly\n");
+		fail_count++;
+	}
+
+	// Each result is only handed out once.
+	if (AsyncTextureDecoder::GetPrefetched(&actual[0], 0, &src[0], width, height, GX_TF_CMPR, false, hash) != PC_TEX_FMT_NONE)
+	{
+		printf("FAIL (TextureDecoderTests): prefetched texture was handed out twice\n");
+		fail_count++;
+	}
+
+	// The texture changed between the prefetch and the draw call.
+	AsyncTextureDecoder::Prefetch(1, &src[0], width, height, GX_TF_CMPR, false, 0, 0);
+	if (AsyncTextureDecoder::WaitForPrefetch(1) != expected_fmt)
+	{
+		printf("FAIL (TextureDecoderTests): texture to be modified wasn't prefetched\n");
+		fail_count++;
+	}
+	src[0] ^= 0xFF;
+	const u64 new_hash = GetHash64(&src[0], (int)src.size(), 0);
+	if (AsyncTextureDecoder::GetPrefetched(&actual[0], 1, &src[0], width, height, GX_TF_CMPR, false, new_hash) != PC_TEX_FMT_NONE)
+	{
+		printf("FAIL (TextureDecoderTests): outdated prefetched texture was used\n");
+		fail_count++;
+	}
+
+	// Already in the texture cache.
+	AsyncTextureDecoder::Prefetch(2, &src[0], width, height, GX_TF_CMPR, false, new_hash, 0);
+	if (AsyncTextureDecoder::WaitForPrefetch(2) != PC_TEX_FMT_NONE)
+	{
+		printf("FAIL (TextureDecoderTests): texture matching the cache entry was decoded\n");
+		fail_count++;
+	}
+	if (AsyncTextureDecoder::GetPrefetched(&actual[0], 2, &src[0], width, height, GX_TF_CMPR, false, new_hash) != PC_TEX_FMT_NONE)
+	{
+		printf("FAIL (TextureDecoderTests): texture matching the cache entry was handed out\n");
+		fail_count++;
+	}
+}
+
+}
+
+void TextureDecoderTests()
+{
+	AsyncTextureDecoder::Init();
+
+	TestSlicedDecode(GX_TF_RGBA8, "RGBA8", 256, 256, false);
+	TestSlicedDecode(GX_TF_RGBA8, "RGBA8", 640, 476, false);
+	TestSlicedDecode(GX_TF_RGBA8, "RGBA8", 1024, 1024, true);
+	TestSlicedDecode(GX_TF_CMPR, "CMPR", 256, 256, false);
+	TestSlicedDecode(GX_TF_CMPR, "CMPR", 512, 264, false);
+	TestSlicedDecode(GX_TF_CMPR, "CMPR", 1024, 1024, true);
+	TestPrefetch();
+
+	AsyncTextureDecoder::Shutdown();
+}
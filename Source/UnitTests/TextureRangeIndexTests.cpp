@@ -0,0 +1,199 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Checks TextureRangeIndex against a plain scan over all ranges, with lots of
+// small textures and a few large ones being added, moved and removed. Then
+// compares how long it takes to find the textures overlapping EFB copies with
+// the index and by going through a std::map of all textures, which is what
+// TextureCache used to do.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "Timer.h"
+#include "TextureRangeIndex.h"
+
+extern int fail_count;
+
+namespace
+{
+
+struct TestRange
+{
+	u32 addr;
+	u32 size;
+};
+
+typedef std::map<u32, TestRange> RangeMap;
+
+// Same test as TCacheEntryBase::IntersectsMemoryRange
+bool Overlaps(const TestRange &range, u32 start, u32 size)
+{
+	return range.addr + range.size >= start && range.addr < start + size;
+}
+
+TestRange RandomRange()
+{
+	TestRange range;
+	range.addr = (rand() % 0x1800000) & ~31;
+	// Mostly small textures, like fonts and UI elements
+	if (rand() % 16)
+		range.size = 32 << (rand() % 8);
+	else
+		range.size = 0x10000 << (rand() % 6);
+	return range;
+}
+
+void CheckFind(const TextureRangeIndex &index, const RangeMap &ranges, u32 start, u32 size)
+{
+	std::vector<u32> found;
+	index.Find(start, size, &found);
+
+	std::vector<u32> sorted(found);
+	std::sort(sorted.begin(), sorted.end());
+	if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+	{
+		printf("FAIL (TextureRangeIndexTests): entry reported twice for %08x+%x\n", start, size);
+		fail_count++;
+	}
+
+	for (RangeMap::const_iterator iter = ranges.begin(); iter != ranges.end(); ++iter)
+	{
+		if (Overlaps(iter->second, start, size) && !std::binary_search(sorted.begin(), sorted.end(), iter->first))
+		{
+			printf("FAIL (TextureRangeIndexTests): %08x+%x not found for %08x+%x\n",
+				iter->second.addr, iter->second.size, start, size);
+			fail_count++;
+			return;
+		}
+	}
+}
+
+void TestRandomRanges()
+{
+	TextureRangeIndex index;
+	RangeMap ranges;
+
+	for (u32 id = 0; id < 4000; id++)
+	{
+		TestRange range = RandomRange();
+		ranges[id] = range;
+		index.Insert(id, range.addr, range.size);
+	}
+
+	for (int i = 0; i < 2000; i++)
+	{
+		const u32 id = rand() % 4000;
+		switch (rand() % 3)
+		{
+		case 0:
+			ranges.erase(id);
+			index.Erase(id);
+			break;
+		case 1:
+		{
+			// Reused entry, or a new one with this id
+			TestRange range = RandomRange();
+			ranges[id] = range;
+			index.Insert(id, range.addr, range.size);
+			break;
+		}
+		default:
+		{
+			TestRange range = RandomRange();
+			CheckFind(index, ranges, range.addr, range.size);
+			break;
+		}
+		}
+	}
+
+	if (index.Size() != ranges.size())
+	{
+		printf("FAIL (TextureRangeIndexTests): index has %u entries, expected %u\n", (u32)index.Size(), (u32)ranges.size());
+		fail_count++;
+	}
+
+	// Whole RAM, and empty ranges, which still touch the entries ending right there.
+	CheckFind(index, ranges, 0, 0x1800000);
+	for (RangeMap::const_iterator iter = ranges.begin(); iter != ranges.end(); ++iter)
+	{
+		CheckFind(index, ranges, iter->second.addr + iter->second.size, 0);
+		if (iter->first > 100)
+			break;
+	}
+
+	index.Clear();
+	std::vector<u32> found;
+	index.Find(0, 0x1800000, &found);
+	if (!found.empty() || index.Size() != 0)
+	{
+		printf("FAIL (TextureRangeIndexTests): entries left after Clear\n");
+		fail_count++;
+	}
+}
+
+void TimeFind()
+{
+	const int num_textures = 5000;
+	const int num_copies = 20000;
+
+	TextureRangeIndex index;
+	RangeMap ranges;
+	for (u32 id = 0; id < num_textures; id++)
+	{
+		TestRange range = RandomRange();
+		ranges[id] = range;
+		index.Insert(id, range.addr, range.size);
+	}
+
+	std::vector<TestRange> copies(num_copies);
+	for (int i = 0; i < num_copies; i++)
+	{
+		copies[i].addr = (rand() % 0x1800000) & ~31;
+		copies[i].size = 640 * 16 * 2;
+	}
+
+	Common::Timer timer;
+	timer.Start();
+	u32 scan_hits = 0;
+	for (int i = 0; i < num_copies; i++)
+	{
+		for (RangeMap::const_iterator iter = ranges.begin(); iter != ranges.end(); ++iter)
+			scan_hits += Overlaps(iter->second, copies[i].addr, copies[i].size);
+	}
+	u64 scan_time = timer.GetTimeElapsed();
+
+	timer.Start();
+	u32 index_hits = 0;
+	std::vector<u32> found;
+	for (int i = 0; i < num_copies; i++)
+	{
+		found.clear();
+		index.Find(copies[i].addr, copies[i].size, &found);
+		for (u32 id : found)
+			index_hits += Overlaps(ranges[id], copies[i].addr, copies[i].size);
+	}
+	u64 index_time = timer.GetTimeElapsed();
+
+	if (scan_hits != index_hits)
+	{
+		printf("FAIL (TextureRangeIndexTests): index found %u overlaps, scan %u\n", index_hits, scan_hits);
+		fail_count++;
+	}
+
+	printf("TextureRangeIndex: %d range lookups among %d textures: %u ms scanning, %u ms with the index\n",
+		num_copies, num_textures, (u32)scan_time, (u32)index_time);
+}
+
+}
+
+void TextureRangeIndexTests()
+{
+	srand(0);
+	TestRandomRanges();
+	TimeFind();
+}
@@ -24,6 +24,21 @@
 #include "HW/SI_DeviceGCController.h"
 
 void AudioJitTests();
+void JitCacheTests(const char *stream_file);
+void JitDiskCacheTests();
+void MPSCQueueTests();
+void CoreTimingTests();
+void TLBTests();
+void CachedInterpreterTests();
+void IdleLoopTests();
+void PairedSingleTests();
+void PPCJitTests();
+void JitILTests();
+void HLESDKTests();
+void TextureDecoderTests();
+void TextureDecoderConformanceTests();
+void TextureRangeIndexTests();
+void WriteWatchTests();
 
 using namespace std;
 int fail_count = 0;
@@ -137,6 +152,21 @@ int main(int argc, char* argv[])
 	CoreTests();
 	MathTests();
 	StringTests();
+	JitCacheTests(argc > 1 ? argv[1] : NULL);
+	JitDiskCacheTests();
+	MPSCQueueTests();
+	CoreTimingTests();
+	TLBTests();
+	CachedInterpreterTests();
+	IdleLoopTests();
+	PairedSingleTests();
+	PPCJitTests();
+	JitILTests();
+	HLESDKTests();
+	TextureDecoderTests();
+	TextureDecoderConformanceTests();
+	TextureRangeIndexTests();
+	WriteWatchTests();
 	if (fail_count == 0)
 	{
 		printf("All tests passed.\n");
@@ -0,0 +1,183 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Watches ranges of MEM1 and writes to them through every way guest memory
+// gets written: a plain host pointer, Memory::Write_U32, the view the JIT
+// uses and another thread. Each one has to mark the range as written. Also checks that reads by
+// the OS work after PrepareHostWrite, that pages which keep getting written
+// stop being watched until they cool down, and compares the cost of hashing a
+// texture with that of asking whether it was written.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Hash.h"
+#include "MemTools.h"
+#include "Thread.h"
+#include "Timer.h"
+#include "HW/Memmap.h"
+#include "HW/WriteWatch.h"
+
+#include "TestEnvironment.h"
+
+extern int fail_count;
+
+namespace
+{
+
+const u32 WATCH_BASE = 0x00400000;
+const u32 TEXTURE_SIZE = 512 * 512 * 4;
+const int NUM_LOOKUPS = 200;
+
+void Check(bool condition, const char *what)
+{
+	if (!condition)
+	{
+		printf("FAIL (WriteWatchTests): %s\n", what);
+		fail_count++;
+	}
+}
+
+void TestWrites()
+{
+	const u32 address = WATCH_BASE + 0x1230;
+
+	Check(WriteWatch::Watch(address, 0x100), "couldn't watch a range of MEM1");
+	Check(!WriteWatch::IsWritten(address, 0x100), "range written right after watching it");
+	Check(WriteWatch::IsWritten(address + 0x10000, 0x100), "range which isn't watched counts as unwritten");
+	Check(!WriteWatch::Watch(Memory::RAM_SIZE - 0x10, 0x20), "watched a range past the end of MEM1");
+
+	memset(Memory::GetPointer(address + 0x80), 0xab, 4);
+	Check(WriteWatch::IsWritten(address, 0x100), "write through Memory::GetPointer missed");
+	Check(Memory::Read_U32(0x80000000 | (address + 0x80)) == 0xabababab, "write through Memory::GetPointer lost");
+
+	WriteWatch::Watch(address, 0x100);
+	Memory::Write_U32(0x11223344, 0x80000000 | address);
+	Check(WriteWatch::IsWritten(address, 0x100), "write through Memory::Write_U32 missed");
+	Check(Memory::Read_U32(0x80000000 | address) == 0x11223344, "write through Memory::Write_U32 lost");
+
+	// Same view the JIT's fastmem stores go through.
+	WriteWatch::Watch(address, 0x100);
+	*(u32 *)(Memory::base + (0x80000000 | (address + 0xfc))) = 0x55667788;
+	Check(WriteWatch::IsWritten(address, 0x100), "write through the fastmem view missed");
+	Check(*(u32 *)Memory::GetPointer(address + 0xfc) == 0x55667788, "write through the fastmem view lost");
+
+	// Writing one page leaves the others alone. Different pages, the one above is hot by now.
+	const u32 range = WATCH_BASE + 0x10000;
+	Check(WriteWatch::Watch(range, 0x4000), "couldn't watch four pages");
+	Memory::Write_U32(0, 0x80000000 | (range + 0x2000));
+	Check(WriteWatch::IsWritten(range, 0x4000), "write to the third page of a range missed");
+	Check(!WriteWatch::IsWritten(range, 0x2000) && !WriteWatch::IsWritten(range + 0x3000, 0x1000),
+		"write to one page marked its neighbours as written");
+}
+
+void TestOtherThread()
+{
+	// The GPU thread and DVD reads write guest memory too.
+	const u32 address = WATCH_BASE + 0x30000;
+	WriteWatch::Watch(address, 0x100);
+	std::thread writer([address] { Memory::Write_U32(0x99aabbcc, 0x80000000 | address); });
+	writer.join();
+	Check(WriteWatch::IsWritten(address, 0x100), "write from another thread missed");
+	Check(Memory::Read_U32(0x80000000 | address) == 0x99aabbcc, "write from another thread lost");
+}
+
+void TestHostWrite()
+{
+	// Large enough that fread hands the buffer to the OS instead of copying from its own.
+	const u32 size = 0x10000;
+	const u32 address = WATCH_BASE + 0x20000;
+
+	FILE *file = tmpfile();
+	if (!file)
+	{
+		printf("WriteWatch: no temporary file, skipping the host write test\n");
+		return;
+	}
+	std::vector<u8> data(size);
+	for (u32 i = 0; i < size; i++)
+		data[i] = (u8)(i * 7);
+	fwrite(&data[0], 1, size, file);
+	rewind(file);
+
+	WriteWatch::Watch(address, size);
+	WriteWatch::PrepareHostWrite(Memory::GetPointer(address), size);
+	const size_t read = fread(Memory::GetPointer(address), 1, size, file);
+	fclose(file);
+
+	Check(read == size && memcmp(Memory::GetPointer(address), &data[0], size) == 0, "read into a watched range failed");
+	Check(WriteWatch::IsWritten(address, size), "PrepareHostWrite didn't mark the range as written");
+}
+
+void TestHotPages()
+{
+	const u32 address = WATCH_BASE + 0x40000;
+
+	// A few writes in a row make the page too hot to watch.
+	int watches = 0;
+	while (WriteWatch::Watch(address, 4) && watches < 10)
+	{
+		Memory::Write_U32(watches, 0x80000000 | address);
+		watches++;
+	}
+	Check(watches > 0 && watches < 10, "page which keeps getting written is still watched");
+	Check(WriteWatch::IsWritten(address, 4), "hot page counts as unwritten");
+
+	bool cooled = false;
+	for (int frame = 0; frame < 64 && !cooled; frame++)
+	{
+		WriteWatch::CoolDown();
+		cooled = WriteWatch::Watch(address, 4);
+	}
+	Check(cooled, "hot page never cooled down");
+	Check(!WriteWatch::IsWritten(address, 4), "cooled down page counts as written");
+}
+
+void TimeLookup()
+{
+	const u32 address = WATCH_BASE + 0x100000;
+	u8 *const ptr = Memory::GetPointer(address);
+	for (u32 i = 0; i < TEXTURE_SIZE; i++)
+		ptr[i] = (u8)(i * 13);
+
+	WriteWatch::Watch(address, TEXTURE_SIZE);
+
+	Common::Timer timer;
+	timer.Start();
+	u64 hash = 0;
+	for (int i = 0; i < NUM_LOOKUPS; i++)
+		hash += GetHash64(ptr, TEXTURE_SIZE, 0);
+	const u64 hash_ms = timer.GetTimeElapsed();
+
+	timer.Start();
+	int written = 0;
+	for (int i = 0; i < NUM_LOOKUPS; i++)
+		written += WriteWatch::IsWritten(address, TEXTURE_SIZE);
+	const u64 watch_ms = timer.GetTimeElapsed();
+
+	Check(written == 0, "reading a watched texture marked it as written");
+	printf("WriteWatch: %d checks of a %u KB texture: %u ms hashing, %u ms asking the write watch (hash %08x)\n",
+		NUM_LOOKUPS, TEXTURE_SIZE / 1024, (u32)hash_ms, (u32)watch_ms, (u32)hash);
+}
+
+}
+
+void WriteWatchTests()
+{
+	TestEnvironment env;
+	env.InitMemory();
+	EMM::InstallExceptionHandler();
+	WriteWatch::Init();
+
+	TestWrites();
+	TestOtherThread();
+	TestHostWrite();
+	TestHotPages();
+	TimeLookup();
+
+	WriteWatch::Shutdown();
+	Check(!WriteWatch::IsEnabled() && WriteWatch::IsWritten(WATCH_BASE, 4), "still watching after Shutdown");
+	memset(Memory::GetPointer(WATCH_BASE + 0x100000), 0, TEXTURE_SIZE);
+}